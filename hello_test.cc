@@ -4,6 +4,38 @@
 #include "unittest_SimpleMath/isolatedBoxCmake.cpp"
 #include "unittest_SimpleMath/isolatedBox_PID.cpp"
 #include "unittest_SimpleMath/isolatedBox_actuator.cpp"
+#include "unittest_SimpleMath/isolatedBox_scheduler.cpp"
+#include "unittest_SimpleMath/isolatedBox_bank.cpp"
+#include "unittest_SimpleMath/isolatedBox_plant.cpp"
+#include "unittest_SimpleMath/isolatedBox_pwm.cpp"
+#include "unittest_SimpleMath/isolatedBox_probe.cpp"
+#include "unittest_SimpleMath/isolatedBox_probefile.cpp"
+#include "unittest_SimpleMath/isolatedBox_dataentryqueue.cpp"
+#include "unittest_SimpleMath/isolatedBox_mappedfile.cpp"
+#include "unittest_SimpleMath/isolatedBox_telemetry.cpp"
+#include "unittest_SimpleMath/isolatedBox_history.cpp"
+#include "unittest_SimpleMath/isolatedBox_idregistry.cpp"
+#include "unittest_SimpleMath/isolatedBox_metrics.cpp"
+#include "unittest_SimpleMath/isolatedBox_exporter.cpp"
+#include "unittest_SimpleMath/isolatedBox_trace.cpp"
+#include "unittest_SimpleMath/isolatedBox_printdebug.cpp"
+#include "unittest_SimpleMath/isolatedBox_profile.cpp"
+#include "unittest_SimpleMath/isolatedBox_config.cpp"
+#include "unittest_SimpleMath/isolatedBox_tscale.cpp"
+#include "unittest_SimpleMath/isolatedBox_filter.cpp"
+#include "unittest_SimpleMath/RingQueue.h"
+#include "unittest_SimpleMath/SharedQueue.h"
+#include "unittest_SimpleMath/MonitoringTemp.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string>
+
+#include <thread>
+#include <vector>
 
 using namespace isoBoxApi;
 
@@ -175,4 +207,1891 @@ TEST(testIsolated, runCompensation)
     l_tempToMonitor = 50.0001;
     EXPECT_EQ(l_maxSetPoint, l_IsoBox.applyCompensation(l_tempToMonitor));
 
-}
\ No newline at end of file
+}
+
+TEST(testRingQueue, overflowPolicy)
+{
+    /// <summary>
+    /// Drop oldest: the ring keeps the last 4 elements pushed
+    /// </summary>
+    SpscRingQueue<int, 4, RING_DROP_OLDEST> l_oldest;
+    for (int i = 0; i < 6; i++)
+        EXPECT_TRUE(l_oldest.push(i));
+    EXPECT_EQ(4, l_oldest.size());
+    EXPECT_EQ(2u, l_oldest.dropped());
+    EXPECT_EQ(2, l_oldest.pop());
+    EXPECT_EQ(3, l_oldest.pop());
+
+    /// <summary>
+    /// Drop newest: the ring keeps the first 4 elements pushed
+    /// </summary>
+    SpscRingQueue<int, 4, RING_DROP_NEWEST> l_newest;
+    for (int i = 0; i < 6; i++)
+        EXPECT_EQ(i < 4, l_newest.push(i));
+    EXPECT_EQ(2u, l_newest.dropped());
+    EXPECT_EQ(0, l_newest.pop());
+
+    /// <summary>
+    /// Empty queue after clear
+    /// </summary>
+    int l_elem = -1;
+    l_newest.clear();
+    EXPECT_EQ(0, l_newest.size());
+    EXPECT_FALSE(l_newest.try_pop(l_elem));
+}
+
+/// <summary>
+/// Element whose move assignment takes a while when slow is set:
+/// keeps a consumer inside its slot
+/// </summary>
+struct SlowMoveElem
+{
+    int value = 0;
+    bool slow = false;
+
+    SlowMoveElem() = default;
+    SlowMoveElem(int _value, bool _slow) : value(_value), slow(_slow) {}
+    SlowMoveElem(const SlowMoveElem &) = default;
+    SlowMoveElem &operator=(SlowMoveElem &&_other)
+    {
+        if (_other.slow)
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        value = _other.value;
+        slow = _other.slow;
+        return *this;
+    }
+};
+
+TEST(testRingQueue, pushWhileSlotReleased)
+{
+    /// <summary>
+    /// Full ring, a consumer has claimed the head slot and is still
+    /// moving its element out: the ring is no longer full, so a push
+    /// waits for the slot instead of dropping the element
+    /// </summary>
+    MpscRingQueue<SlowMoveElem, 2, RING_DROP_NEWEST> l_queue;
+    EXPECT_TRUE(l_queue.push(SlowMoveElem(1, true)));
+    EXPECT_TRUE(l_queue.push(SlowMoveElem(2, false)));
+
+    SlowMoveElem l_popped;
+    std::thread l_consumer([&l_queue, &l_popped]() { l_queue.try_pop(l_popped); });
+    while (l_queue.size() == 2)
+        std::this_thread::yield();
+
+    EXPECT_TRUE(l_queue.push(SlowMoveElem(3, false)));
+    l_consumer.join();
+
+    EXPECT_EQ(1, l_popped.value);
+    EXPECT_EQ(0u, l_queue.dropped());
+    EXPECT_EQ(2, l_queue.size());
+    EXPECT_TRUE(l_queue.try_pop(l_popped));
+    EXPECT_EQ(2, l_popped.value);
+    EXPECT_TRUE(l_queue.try_pop(l_popped));
+    EXPECT_EQ(3, l_popped.value);
+}
+
+TEST(testRingQueue, multiProducer)
+{
+    /// <summary>
+    /// Blocking ring: no element is lost and each producer
+    /// sequence is received in order
+    /// </summary>
+    const int l_producers = 4;
+    const int l_perProducer = 20000;
+    MpscRingQueue<int, 64, RING_BLOCK> l_queue;
+
+    std::vector<std::thread> l_threads;
+    for (int p = 0; p < l_producers; p++) {
+        l_threads.emplace_back([&l_queue, p]() {
+            for (int i = 0; i < l_perProducer; i++)
+                l_queue.push(p * l_perProducer + i);
+        });
+    }
+
+    std::vector<int> l_last(l_producers, -1);
+    bool l_ordered = true;
+    for (int i = 0; i < l_producers * l_perProducer; i++) {
+        int l_elem = l_queue.pop();
+        int l_p = l_elem / l_perProducer;
+        if (l_elem <= l_last[l_p])
+            l_ordered = false;
+        l_last[l_p] = l_elem;
+    }
+    for (auto &t : l_threads)
+        t.join();
+
+    EXPECT_TRUE(l_ordered);
+    EXPECT_EQ(0, l_queue.size());
+    EXPECT_EQ(0u, l_queue.dropped());
+}
+
+TEST(testSharedQueue, batchPushDrain)
+{
+    SharedQueue<std::string> l_queue;
+    std::vector<std::string> l_batch = { "a", "b", "c", "d", "e" };
+
+    /// <summary>
+    /// The whole batch is moved in under one lock
+    /// </summary>
+    EXPECT_EQ(5u, l_queue.push_range(std::make_move_iterator(l_batch.begin()),
+                                     std::make_move_iterator(l_batch.end())));
+    l_queue.emplace(3, 'f');
+    EXPECT_EQ(6, l_queue.size());
+
+    /// <summary>
+    /// Drain is bounded by max and keeps the FIFO order
+    /// </summary>
+    std::vector<std::string> l_out;
+    EXPECT_EQ(4u, l_queue.drain_into(l_out, 4));
+    EXPECT_EQ("a", l_out.front());
+    EXPECT_EQ("d", l_out.back());
+    EXPECT_EQ(2u, l_queue.drain_into(l_out, 10));
+    EXPECT_EQ("fff", l_out.back());
+    EXPECT_EQ(0u, l_queue.drain_into(l_out, 10));
+}
+
+TEST(testSharedQueue, timedPop)
+{
+    SharedQueue<int> l_queue;
+    int l_elem = 0;
+
+    /// <summary>
+    /// Empty queue: both calls give up
+    /// </summary>
+    EXPECT_FALSE(l_queue.try_pop(l_elem));
+    EXPECT_FALSE(l_queue.pop_for(l_elem, std::chrono::milliseconds(2)));
+
+    /// <summary>
+    /// A late producer wakes up the waiting consumer
+    /// </summary>
+    std::thread l_producer([&l_queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        l_queue.push(42);
+    });
+    EXPECT_TRUE(l_queue.pop_for(l_elem, std::chrono::seconds(5)));
+    EXPECT_EQ(42, l_elem);
+    l_producer.join();
+
+    /// <summary>
+    /// Same surface on the lock-free ring
+    /// </summary>
+    SpscRingQueue<int, 8> l_ring;
+    EXPECT_FALSE(l_ring.pop_for(l_elem, std::chrono::milliseconds(1)));
+    int l_values[] = { 1, 2, 3 };
+    EXPECT_EQ(3u, l_ring.push_range(l_values, l_values + 3));
+    std::vector<int> l_out;
+    EXPECT_EQ(3u, l_ring.drain_into(l_out, 8));
+    EXPECT_EQ(3, l_out.back());
+}
+
+TEST(testMonitoringTemp, recordAndFormat)
+{
+    MonitoringDataQueue l_queue;
+
+    /// <summary>
+    /// The record goes through the queue as is
+    /// </summary>
+    MonitoringTemp l_sample = makeMonitoringTemp(1684000000123456789LL, 7, 36.5f, CELSIUS);
+    insert(l_sample, 37.25f, FARENHEIT);
+    l_queue.push(l_sample);
+    MonitoringTemp l_out = l_queue.pop();
+    EXPECT_EQ(1684000000123456789LL, l_out.ts);
+    EXPECT_EQ(7u, l_out.id);
+    EXPECT_EQ(ISO_MONITORING_NO_BOX, l_out.box);
+    EXPECT_EQ(37.25f, l_out.value);
+    EXPECT_EQ(FARENHEIT, l_out.unit);
+
+    /// <summary>
+    /// Text is produced only at the sink, time stamp in milliseconds
+    /// </summary>
+    char l_text[64];
+    format(l_out, l_text, sizeof(l_text));
+    EXPECT_STREQ("1684000000123 7 37.25 F", l_text);
+}
+
+TEST(testPidController, processStep)
+{
+    PidController l_pid;
+    l_pid.setPoints(25.0, 50.0);
+
+    /// <summary>
+    /// Below the target: the controller heats and asks to be
+    /// called again after one scan period
+    /// </summary>
+    EXPECT_EQ(timeProcess_t(ISO_SCAN_RATE), l_pid.Process(24.0));
+    EXPECT_GT(l_pid.getOutput(), 0.0f);
+    EXPECT_LE(l_pid.getOutput(), (temp_t)ISO_PWM_DUTY_CYCLE_MAX);
+    EXPECT_EQ((uint8_t)(l_pid.getOutput() + 0.5f), l_pid.getActuator().getDutyCycle());
+
+    /// <summary>
+    /// Above the target: output is clamped to the minimum duty cycle
+    /// </summary>
+    l_pid.Process(40.0);
+    EXPECT_EQ((temp_t)ISO_PWM_DUTY_CYCLE_MIN, l_pid.getOutput());
+
+    /// <summary>
+    /// Gains out of range fall back to the minimum
+    /// </summary>
+    l_pid.setKp(ISO_PID_GAIN_MAX + 1);
+    EXPECT_EQ(ISO_PID_GAIN_MIN, l_pid.getKp());
+    l_pid.setKp(ISO_PID_KP_DEF);
+    EXPECT_EQ(ISO_PID_KP_DEF, l_pid.getKp());
+}
+
+TEST(testPidController, antiWindup)
+{
+    PidController l_pid;
+    l_pid.setPoints(25.0, 50.0);
+
+    /// <summary>
+    /// Long saturation far below the target
+    /// </summary>
+    for (int i = 0; i < 10000; i++)
+        l_pid.Process(0.0);
+    EXPECT_EQ((temp_t)ISO_PWM_DUTY_CYCLE_MAX, l_pid.getOutput());
+
+    /// <summary>
+    /// Once over the target the output must leave saturation
+    /// right away: the integral did not wind up
+    /// </summary>
+    int l_steps = 0;
+    while (l_pid.getOutput() >= ISO_PWM_DUTY_CYCLE_MAX && l_steps < 100) {
+        l_pid.Process(26.0);
+        l_steps++;
+    }
+    EXPECT_LT(l_steps, 5);
+
+    /// <summary>
+    /// Changing target resets the controller state
+    /// </summary>
+    l_pid.setTargetPoint(PID_MAX_SET_POINT);
+    l_pid.Process(50.0);
+    EXPECT_EQ(0.0f, l_pid.getOutput());
+}
+
+TEST(testScheduler, pollDeadlines)
+{
+    isoBoxScheduler l_scheduler(100, 2);
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++) {
+        EXPECT_TRUE(l_scheduler.initBox(i, 25.0, 50.0));
+        l_scheduler.postTemp(i, 51.0);
+    }
+
+    /// <summary>
+    /// The first poll arms the deadlines, spread over one period:
+    /// only the first box of each shard is due
+    /// </summary>
+    isoBoxScheduler::isoClock_t::time_point l_start = isoBoxScheduler::isoClock_t::now();
+    timeProcess_t l_period(ISO_SCAN_RATE);
+    EXPECT_EQ(2u, l_scheduler.poll(l_start));
+
+    /// <summary>
+    /// Within one period every box runs once, nothing is late
+    /// </summary>
+    EXPECT_EQ(98u, l_scheduler.poll(l_start + l_period - std::chrono::microseconds(1)));
+    EXPECT_EQ(0u, l_scheduler.getStats().missedDeadlines);
+    EXPECT_EQ(50.0f, l_scheduler.getBox(99).getTargetPoint());
+
+    /// <summary>
+    /// Nothing else is due before the next period
+    /// </summary>
+    EXPECT_EQ(0u, l_scheduler.poll(l_start + l_period - std::chrono::microseconds(1)));
+
+    /// <summary>
+    /// Host stalled for 10 periods: each box runs once and the
+    /// skipped periods are reported
+    /// </summary>
+    EXPECT_EQ(100u, l_scheduler.poll(l_start + l_period * 10));
+    isoBoxSchedulerStats l_stats = l_scheduler.getStats();
+    EXPECT_EQ(200u, l_stats.ticks);
+    EXPECT_GE(l_stats.missedDeadlines, 800u);
+    EXPECT_GT(l_stats.maxLatenessUs, 0);
+}
+
+TEST(testScheduler, workers)
+{
+    isoBoxScheduler l_scheduler(1000, 2);
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++) {
+        l_scheduler.initBox(i, 25.0, 50.0);
+        l_scheduler.postTemp(i, 20.0);
+    }
+
+    EXPECT_TRUE(l_scheduler.start());
+    EXPECT_FALSE(l_scheduler.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(ISO_SCAN_RATE * 6));
+    l_scheduler.stop();
+
+    /// <summary>
+    /// Every box was stepped at least once
+    /// </summary>
+    EXPECT_FALSE(l_scheduler.isRunning());
+    EXPECT_GE(l_scheduler.getStats().ticks, 1000u);
+    EXPECT_EQ(25.0f, l_scheduler.getBox(0).getTargetPoint());
+}
+
+TEST(testBoxBank, matchesScalarPath)
+{
+    const size_t l_numBoxes = 64;
+    BoxBank l_bank(l_numBoxes);
+    std::vector<isoBox> l_boxes(l_numBoxes);
+
+    /// <summary>
+    /// Mix of valid, rejected and never initialized boxes
+    /// </summary>
+    for (size_t i = 0; i < l_numBoxes; i++) {
+        temp_t l_min = 20.0f + (temp_t)(i % 7) * 3.5f;
+        temp_t l_max = l_min + 5.0f + (temp_t)(i % 5) * 9.25f;
+        if (i % 11 == 3)
+            l_max = 320.0f;
+        if (i % 13 == 5)
+            continue;
+        EXPECT_EQ(l_boxes[i].init(l_min, l_max), l_bank.init(i, l_min, l_max));
+    }
+
+    /// <summary>
+    /// Same targets on a sweep of temperatures across and
+    /// outside every range
+    /// </summary>
+    std::vector<temp_t> l_temps(l_numBoxes);
+    std::vector<temp_t> l_targets(l_numBoxes);
+    for (int step = 0; step < 400; step++) {
+        for (size_t i = 0; i < l_numBoxes; i++)
+            l_temps[i] = 5.0f + (temp_t)((step * 7 + i * 13) % 1200) * 0.1f;
+        /// <summary>
+        /// Non-finite and far out samples: no compensation, target kept
+        /// </summary>
+        if (step % 50 == 7) {
+            l_temps[step % l_numBoxes] = std::numeric_limits<temp_t>::quiet_NaN();
+            l_temps[(step + 1) % l_numBoxes] = std::numeric_limits<temp_t>::infinity();
+            l_temps[(step + 2) % l_numBoxes] = 1.0e30f;
+        }
+
+        l_bank.applyCompensation(l_temps.data(), l_targets.data(), l_numBoxes);
+
+        for (size_t i = 0; i < l_numBoxes; i++) {
+            ASSERT_EQ(l_boxes[i].applyCompensation(l_temps[i]), l_targets[i]);
+            ASSERT_EQ(l_boxes[i].getTargetPoint(), l_bank.getTargetPoint(i));
+        }
+    }
+}
+
+TEST(testPlant, closedLoop)
+{
+    /// <summary>
+    /// Cold boxes (15 C) heated into [25, 30]
+    /// </summary>
+    ThermalPlantParams l_params = { 15.0f, 15.0f, 600.0f, 0.2f, 0.05f, 1 };
+    PlantSimulation l_sim(20, l_params, 25.0f, 30.0f);
+    PlantSimulationResult l_result = l_sim.run(std::chrono::minutes(30));
+
+    EXPECT_EQ(20u * 360000u, l_result.steps);
+    EXPECT_EQ(20u, l_result.settledBoxes);
+    EXPECT_GT(l_result.meanSettlingSeconds, 0.0);
+    EXPECT_LT(l_result.maxSettlingSeconds, 600.0);
+
+    /// <summary>
+    /// Faster than real time
+    /// </summary>
+    EXPECT_LT(l_result.wallSeconds, l_result.simulatedSeconds);
+
+    /// <summary>
+    /// Deterministic: a second simulation gives the same temperatures
+    /// </summary>
+    PlantSimulation l_again(20, l_params, 25.0f, 30.0f);
+    l_again.run(std::chrono::minutes(30));
+    for (size_t i = 0; i < 20; i++)
+        EXPECT_EQ(l_sim.getPlant(i).getTemperature(), l_again.getPlant(i).getTemperature());
+}
+
+TEST(testPwm, coalescedWrites)
+{
+    MemoryMappedPwm l_device(8);
+    PwmWriteCoalescer l_coalescer(&l_device, 4, 4);
+    IsoActuator l_actuators[4];
+
+    EXPECT_FALSE(l_coalescer.attach(3, &l_actuators[0]));
+    for (uint32_t i = 0; i < 4; i++)
+        EXPECT_TRUE(l_coalescer.attach(4 + i, &l_actuators[i]));
+
+    /// <summary>
+    /// Attach marks every channel so the device starts in sync
+    /// </summary>
+    EXPECT_EQ(4u, l_coalescer.flush());
+    EXPECT_EQ(1u, l_device.getBatchCount());
+
+    /// <summary>
+    /// Many changes during a tick: nothing reaches the device
+    /// before the flush, then one write per changed channel
+    /// </summary>
+    for (int k = 0; k < 10; k++)
+        ++l_actuators[1];
+    l_actuators[3].setDutyCycle(75);
+    l_actuators[3].setDutyCycle(75);
+    EXPECT_EQ(2u, l_coalescer.getPending());
+    EXPECT_EQ(0, l_device.getRegister(7).dutyCycle);
+
+    EXPECT_EQ(2u, l_coalescer.flush());
+    EXPECT_EQ(2u, l_device.getBatchCount());
+    EXPECT_EQ(6u, l_device.getWriteCount());
+    EXPECT_EQ(l_actuators[1].getDutyCycle(), l_device.getRegister(5).dutyCycle);
+    EXPECT_EQ(75, l_device.getRegister(7).dutyCycle);
+
+    /// <summary>
+    /// No change, no batch
+    /// </summary>
+    EXPECT_EQ(0u, l_coalescer.flush());
+    EXPECT_EQ(2u, l_device.getBatchCount());
+}
+
+/// <summary>
+/// Backend that rejects the next batch on request
+/// </summary>
+class RejectingPwm : public MemoryMappedPwm
+{
+public:
+    explicit RejectingPwm(size_t _numChannels) : MemoryMappedPwm(_numChannels), m_reject(false) {}
+
+    bool writeBatch(const PwmWrite *_writes, size_t _count) override
+    {
+        if (m_reject) {
+            m_reject = false;
+            return false;
+        }
+        return MemoryMappedPwm::writeBatch(_writes, _count);
+    }
+
+    void rejectNext() { m_reject = true; }
+
+private:
+    bool m_reject;
+};
+
+TEST(testPwm, rejectedFlush)
+{
+    RejectingPwm l_device(2);
+    PwmWriteCoalescer l_coalescer(&l_device, 0, 2);
+    IsoActuator l_actuators[2];
+    for (uint32_t i = 0; i < 2; i++)
+        EXPECT_TRUE(l_coalescer.attach(i, &l_actuators[i]));
+    EXPECT_EQ(2u, l_coalescer.flush());
+
+    /// <summary>
+    /// A rejected batch is not lost: the channel is written by the
+    /// next flush, with the output set meanwhile
+    /// </summary>
+    l_actuators[1].setDutyCycle(40);
+    l_device.rejectNext();
+    EXPECT_EQ(0u, l_coalescer.flush());
+    EXPECT_EQ(1u, l_coalescer.getPending());
+    EXPECT_EQ(0, l_device.getRegister(1).dutyCycle);
+
+    l_actuators[1].setDutyCycle(60);
+    l_actuators[0].setDutyCycle(10);
+    EXPECT_EQ(2u, l_coalescer.flush());
+    EXPECT_EQ(0u, l_coalescer.getPending());
+    EXPECT_EQ(60, l_device.getRegister(1).dutyCycle);
+    EXPECT_EQ(10, l_device.getRegister(0).dutyCycle);
+    EXPECT_EQ(2u, l_device.getBatchCount());
+}
+
+TEST(testPwm, schedulerFlush)
+{
+    MemoryMappedPwm l_device(100);
+    isoBoxScheduler l_scheduler(100, 2);
+    l_scheduler.setPwmBackend(&l_device);
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++) {
+        l_scheduler.initBox(i, 25.0, 50.0);
+        l_scheduler.postTemp(i, 20.0);
+    }
+
+    /// <summary>
+    /// One batch per shard and per poll, the registers follow the PID output
+    /// </summary>
+    isoBoxScheduler::isoClock_t::time_point l_start = isoBoxScheduler::isoClock_t::now();
+    l_scheduler.poll(l_start);
+    l_scheduler.poll(l_start + timeProcess_t(ISO_SCAN_RATE));
+    EXPECT_LE(l_device.getBatchCount(), 4u);
+    for (uint32_t i = 0; i < 100; i++)
+        EXPECT_EQ(l_scheduler.getBox(i).getActuator().getDutyCycle(), l_device.getRegister(i).dutyCycle);
+}
+
+TEST(testActuator, staticAndRuntimeLimits)
+{
+    /// <summary>
+    /// Default board: compile time limits, same checks as before
+    /// </summary>
+    IsoActuator l_actuator;
+    EXPECT_TRUE(l_actuator.init());
+    EXPECT_TRUE(l_actuator.setDutyCycle(ISO_PWM_DUTY_CYCLE_MAX));
+    EXPECT_FALSE(l_actuator.setDutyCycle(ISO_PWM_DUTY_CYCLE_MAX + 1));
+    EXPECT_FALSE(l_actuator.setFrequency(ISO_PWM_FREQUENCY_MAX));
+    EXPECT_TRUE(l_actuator.setFrequency(ISO_PWM_FREQUENCY_MAX - 1));
+    EXPECT_EQ(sizeof(IsoActuatorState), sizeof(IsoActuator));
+
+    /// <summary>
+    /// Board known at run time: duty cycle limited to 80%
+    /// </summary>
+    RuntimeActuatorLimits l_limits;
+    EXPECT_FALSE(l_limits.setLimits(0, 1000, 1000, 0, 80, 0, 50));
+    EXPECT_TRUE(l_limits.setLimits(0, 1000, 100, 0, 80, 0, 50));
+    IsoRuntimeActuator l_runtime(l_limits);
+    EXPECT_TRUE(l_runtime.init());
+    EXPECT_TRUE(l_runtime.setDutyCycle(80));
+    EXPECT_FALSE(l_runtime.setDutyCycle(81));
+    EXPECT_FALSE(l_runtime.setFrequency(2000));
+    EXPECT_FALSE(l_runtime.setIntensity(51));
+    EXPECT_EQ(80, l_runtime.getDutyCycle());
+
+    /// <summary>
+    /// Compile time temperature limits match the run time ones
+    /// </summary>
+    ParameterLimits l_temps = IsoPhysicalTempLimits::runtime();
+    for (temp_t l_temp = 0.0f; l_temp < 120.0f; l_temp += 0.5f)
+        EXPECT_EQ(l_temps.validate(l_temp), IsoPhysicalTempLimits::validate(l_temp));
+}
+
+TEST(testDataEntryQueue, producersConsumers)
+{
+    const size_t l_numBoxes = 100;
+    MonitoringDataQueue l_queue;
+    SimulatedProbeSource l_probes(l_numBoxes, 15.0, 60.0);
+
+    DataEntryParams l_params = dataEntryDefaults(l_numBoxes);
+    l_params.numProducers = 2;
+    l_params.numConsumers = 3;
+    l_params.pinCores = true;
+    ISO_DataEntryQueue l_pipeline(&l_queue, &l_probes, l_params);
+    IsoMetrics l_metrics(l_numBoxes);
+    l_pipeline.setMetrics(&l_metrics);
+    for (size_t i = 0; i < l_numBoxes; i++) {
+        EXPECT_TRUE(l_pipeline.initBox(i, 25.0, 50.0));
+        EXPECT_TRUE(l_pipeline.setBoxHandle(i, IsoIdRegistry::instance().intern("pipeline_box_" + std::to_string(i))));
+    }
+    EXPECT_FALSE(l_pipeline.setBoxHandle(l_numBoxes, 0));
+
+    EXPECT_TRUE(l_pipeline.start());
+    EXPECT_FALSE(l_pipeline.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(ISO_SCAN_RATE * 10));
+    l_pipeline.stop();
+    EXPECT_FALSE(l_pipeline.isRunning());
+
+    /// <summary>
+    /// Stop drains the queue: every sample read was processed once,
+    /// the probes sweep outside the range so some need compensation
+    /// </summary>
+    DataEntryStats l_stats = l_pipeline.getStats();
+    EXPECT_GE(l_stats.producer.items, l_numBoxes);
+    EXPECT_EQ(0u, l_stats.producer.items % (l_numBoxes / l_params.numProducers));
+    EXPECT_EQ(l_stats.producer.items, l_stats.consumer.items);
+    EXPECT_EQ(0u, l_stats.droppedSamples);
+    EXPECT_GT(l_stats.compensations, 0u);
+    EXPECT_LT(l_stats.compensations, l_stats.consumer.items);
+    EXPECT_EQ(0, l_queue.size());
+    EXPECT_GT(l_stats.wallSeconds, 0.0);
+    EXPECT_LE(l_stats.consumer.busySeconds, l_stats.wallSeconds * l_params.numConsumers);
+
+    /// <summary>
+    /// Every sample has its dwell, measured below the millisecond
+    /// </summary>
+    IsoMetricsSnapshot l_snapshot;
+    l_metrics.snapshot(l_snapshot);
+    const IsoHistogramSnapshot &l_dwell = l_snapshot.latencies[METRIC_QUEUE_DWELL_NS];
+    EXPECT_EQ(l_stats.consumer.items, l_dwell.count);
+    EXPECT_GT(l_dwell.max, 0u);
+    EXPECT_NE(0u, l_dwell.sum % 1000000u);
+
+    /// <summary>
+    /// A restart after stop runs again with the same instance
+    /// </summary>
+    EXPECT_TRUE(l_pipeline.start());
+    l_pipeline.stop();
+    EXPECT_EQ(l_pipeline.getStats().producer.items, l_pipeline.getStats().consumer.items);
+}
+
+/// <summary>
+/// Every probe reads the number of reads done so far: the samples
+/// of a box grow with their age
+/// </summary>
+class CountingProbeSource : public IsoProbeSource
+{
+public:
+    explicit CountingProbeSource(size_t _numProbes) : m_numProbes(_numProbes), m_reads(0) {}
+
+    size_t getNumProbes() const override { return m_numProbes; }
+
+    size_t read(uint32_t, size_t _count, temp_t *_temps) override
+    {
+        m_reads++;
+        for (size_t i = 0; i < _count; i++)
+            _temps[i] = (temp_t)m_reads;
+        return _count;
+    }
+
+    uint32_t getReads() const { return m_reads; }
+
+private:
+    size_t m_numProbes;
+    uint32_t m_reads;
+};
+
+TEST(testDataEntryQueue, perBoxOrder)
+{
+    /// <summary>
+    /// One producer flat out, 4 consumers taking one sample at a time:
+    /// the samples of a box are spread over the consumers, yet the
+    /// last one applied to each box is the newest one read
+    /// </summary>
+    const size_t l_numBoxes = 8;
+    MonitoringDataQueue l_queue;
+    CountingProbeSource l_probes(l_numBoxes);
+
+    DataEntryParams l_params = dataEntryDefaults(l_numBoxes);
+    l_params.numConsumers = 4;
+    l_params.period = timeProcess_t(0);
+    l_params.consumerBatch = 1;
+    ISO_DataEntryQueue l_pipeline(&l_queue, &l_probes, l_params);
+    EXPECT_TRUE(l_pipeline.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(ISO_SCAN_RATE * 4));
+    l_pipeline.stop();
+
+    DataEntryStats l_stats = l_pipeline.getStats();
+    EXPECT_EQ(l_stats.producer.items, l_stats.consumer.items);
+    EXPECT_EQ(l_numBoxes * l_probes.getReads(), l_stats.producer.items + l_stats.droppedSamples);
+
+    /// <summary>
+    /// A full ring (ISO_MONITORING_RING_QUEUE) may refuse the last read
+    /// </summary>
+    for (size_t i = 0; i < l_numBoxes; i++) {
+        if (l_stats.droppedSamples == 0)
+            EXPECT_EQ((temp_t)l_probes.getReads(), l_pipeline.getBox(i).getBoxTemp()) << i;
+        else
+            EXPECT_GE((temp_t)l_probes.getReads(), l_pipeline.getBox(i).getBoxTemp()) << i;
+    }
+}
+
+TEST(testDataEntryQueue, restartResetsOrder)
+{
+    /// <summary>
+    /// A sample stamped far ahead makes the next samples of its box
+    /// stale, as a wall clock stepped back between two runs would;
+    /// a restart forgets it
+    /// </summary>
+    const size_t l_numBoxes = 4;
+    MonitoringDataQueue l_queue;
+    CountingProbeSource l_probes(l_numBoxes);
+
+    DataEntryParams l_params = dataEntryDefaults(l_numBoxes);
+    l_params.period = timeProcess_t(0);
+    ISO_DataEntryQueue l_pipeline(&l_queue, &l_probes, l_params);
+    EXPECT_TRUE(l_pipeline.start());
+    l_queue.push(makeMonitoringTemp(monitoringNow() + 3600000000000LL, 0, -1.0f, CELSIUS, 0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(ISO_SCAN_RATE * 2));
+    l_pipeline.stop();
+    EXPECT_EQ(-1.0f, l_pipeline.getBox(0).getBoxTemp());
+    uint64_t l_stale = l_pipeline.getStats().staleSamples;
+    EXPECT_GT(l_stale, 0u);
+
+    EXPECT_TRUE(l_pipeline.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(ISO_SCAN_RATE * 2));
+    l_pipeline.stop();
+    EXPECT_EQ(l_stale, l_pipeline.getStats().staleSamples);
+    for (size_t i = 0; i < l_numBoxes; i++)
+        EXPECT_EQ((temp_t)l_probes.getReads(), l_pipeline.getBox(i).getBoxTemp()) << i;
+}
+
+TEST(testTelemetry, writeRotateRead)
+{
+    std::string l_dir = ::testing::TempDir() + "isobox_telemetry_test";
+    for (const std::string &l_name : IsoMappedFile::listFiles(l_dir, "telemetry", ""))
+        IsoMappedFile::remove(l_dir + "/" + l_name);
+
+    /// <summary>
+    /// 10 records per segment, 3 segments kept: 45 records leave
+    /// segments 2, 3, 4 with 10, 10, 5 records
+    /// </summary>
+    {
+        TelemetryWriter l_writer;
+        ASSERT_TRUE(l_writer.open(l_dir, 10, 3));
+        IsoActuator l_actuator;
+        l_actuator.init();
+        l_actuator.setDutyCycle(42);
+        isoId_t l_probes[2] = { IsoIdRegistry::instance().intern("probe_a"),
+                                IsoIdRegistry::instance().intern("probe_b") };
+        for (int i = 0; i < 45; i++) {
+            TempStruct l_sample = { (time_t)(1000 + i), l_probes[i & 1], 20.0f + i };
+            if (i % 9 == 8)
+                EXPECT_TRUE(l_writer.appendActuator(i * 1000, l_writer.intern("heater"), l_actuator));
+            else
+                EXPECT_TRUE(l_writer.append(l_sample));
+        }
+        EXPECT_EQ(45u, l_writer.getRecordCount());
+        EXPECT_EQ(3u, l_writer.getNumSegments());
+
+        /// <summary>
+        /// Handle out of the registry: refused, never taken for the
+        /// probe named by its number, nothing sized after it
+        /// </summary>
+        uint32_t l_numbered = l_writer.intern(std::to_string(ISO_ID_INVALID));
+        EXPECT_EQ(ISO_ID_INVALID, l_writer.intern(ISO_ID_INVALID));
+        EXPECT_NE(ISO_ID_INVALID, l_numbered);
+        TempStruct l_stray = { (time_t)2000, ISO_ID_INVALID, 20.0f };
+        EXPECT_FALSE(l_writer.append(l_stray));
+        EXPECT_EQ(45u, l_writer.getRecordCount());
+    }
+
+    TelemetryReader l_reader;
+    ASSERT_TRUE(l_reader.open(l_dir));
+    EXPECT_EQ(3u, l_reader.getNumSegments());
+    EXPECT_EQ(25u, l_reader.getRecordCount());
+    EXPECT_EQ(5u, l_reader.getSegment(2).count);
+
+    uint32_t l_heater = 0;
+    ASSERT_TRUE(l_reader.findId("heater", l_heater));
+    EXPECT_EQ("probe_a", l_reader.getIdName(0));
+
+    /// <summary>
+    /// Records read in place, in order: sample 20 is the first kept
+    /// </summary>
+    int l_index = 20;
+    for (size_t s = 0; s < l_reader.getNumSegments(); s++) {
+        for (const TelemetryRecord &l_record : l_reader.getSegment(s)) {
+            if (l_index % 9 == 8) {
+                EXPECT_EQ(TELEMETRY_ACTUATOR, l_record.kind);
+                EXPECT_EQ(l_heater, l_record.id);
+                EXPECT_EQ(42, l_record.dutyCycle);
+            }
+            else {
+                EXPECT_EQ(TELEMETRY_TEMP, l_record.kind);
+                EXPECT_EQ((1000 + l_index) * 1000LL, l_record.ts);
+                EXPECT_EQ(20.0f + l_index, l_record.value);
+                EXPECT_EQ((l_index & 1) ? "probe_b" : "probe_a", l_reader.getIdName(l_record.id));
+            }
+            l_index++;
+        }
+    }
+    EXPECT_EQ(45, l_index);
+
+    /// <summary>
+    /// Reopening appends after the kept segments with the same ids
+    /// </summary>
+    TelemetryWriter l_again;
+    ASSERT_TRUE(l_again.open(l_dir, 10, 3));
+    EXPECT_EQ(l_heater, l_again.intern("heater"));
+}
+
+TEST(testHistory, losslessRoundTrip)
+{
+    /// <summary>
+    /// Irregular time stamps (jitter, gaps, going back) and
+    /// arbitrary float values: every bucket of both columns
+    /// </summary>
+    const size_t l_count = 3000;
+    std::vector<int64_t> l_ts(l_count);
+    std::vector<temp_t> l_values(l_count);
+    uint32_t l_seed = 12345;
+    int64_t l_time = 1684000000000LL;
+    for (size_t i = 0; i < l_count; i++) {
+        l_seed = l_seed * 1103515245u + 12345u;
+        int64_t l_jitter[6] = { 0, 1, -40, 200, 1500, 5000000000LL };
+        l_time += 5 + l_jitter[(l_seed >> 16) % 6];
+        l_ts[i] = l_time;
+        l_values[i] = (l_seed & 0x100) ? l_values[i ? i - 1 : 0] : (temp_t)(l_seed >> 8) / 1000.0f - 5000.0f;
+    }
+
+    HistoryEncoder l_encoder(7, l_count);
+    for (size_t i = 0; i < l_count; i++)
+        ASSERT_TRUE(l_encoder.append(l_ts[i], l_values[i]));
+    EXPECT_FALSE(l_encoder.append(0, 0.0f));
+
+    std::vector<uint8_t> l_chunk;
+    size_t l_bytes = l_encoder.finish(l_chunk);
+    EXPECT_EQ(l_chunk.size(), l_bytes);
+    EXPECT_EQ(0u, l_encoder.getCount());
+
+    HistoryChunkHeader l_header;
+    ASSERT_TRUE(HistoryDecoder::parse(l_chunk.data(), l_chunk.size(), l_header));
+    EXPECT_EQ(7u, l_header.id);
+    EXPECT_FALSE(HistoryDecoder::parse(l_chunk.data(), l_chunk.size() - 1, l_header));
+
+    std::vector<int64_t> l_tsOut(l_count);
+    std::vector<temp_t> l_valuesOut(l_count);
+    ASSERT_EQ(l_count, HistoryDecoder::decode(l_chunk.data(), l_chunk.size(), l_tsOut.data(), l_valuesOut.data()));
+    for (size_t i = 0; i < l_count; i++) {
+        ASSERT_EQ(l_ts[i], l_tsOut[i]);
+        ASSERT_EQ(0, std::memcmp(&l_values[i], &l_valuesOut[i], sizeof(temp_t)));
+    }
+}
+
+TEST(testHistory, corruptChunk)
+{
+    /// <summary>
+    /// Hand made chunks of 2 samples, regular time stamps
+    /// </summary>
+    auto l_makeChunk = [](const HistoryBitWriter &_values, uint32_t _count) {
+        HistoryChunkHeader l_header;
+        l_header.magic = ISO_HISTORY_MAGIC;
+        l_header.id = 0;
+        l_header.count = _count;
+        l_header.tsBytes = 1;
+        l_header.firstTs = 1000;
+        l_header.valueBytes = (uint32_t)_values.bytes().size();
+        l_header.reserved = 0;
+        std::vector<uint8_t> l_chunk(HistoryDecoder::chunkBytes(l_header), 0);
+        std::memcpy(l_chunk.data(), &l_header, sizeof(l_header));
+        std::memcpy(&l_chunk[sizeof(l_header) + 1], _values.bytes().data(), l_header.valueBytes);
+        return l_chunk;
+    };
+    int64_t l_ts[8];
+    temp_t l_values[8];
+
+    /// <summary>
+    /// Valid: new window of 8 bits, 8 leading zeros
+    /// </summary>
+    HistoryBitWriter l_valid;
+    l_valid.write(0x41200000u, 32);
+    l_valid.write(0x3, 2);
+    l_valid.write(8, 5);
+    l_valid.write(8 - 1, 5);
+    l_valid.write(0x01, 8);
+    l_valid.align();
+    std::vector<uint8_t> l_chunk = l_makeChunk(l_valid, 2);
+    EXPECT_EQ(2u, HistoryDecoder::decode(l_chunk.data(), l_chunk.size(), l_ts, l_values));
+    EXPECT_EQ(1000, l_ts[1]);
+    EXPECT_EQ(10.0f, l_values[0]);
+    EXPECT_NE(l_values[0], l_values[1]);
+
+    /// <summary>
+    /// Window wider than 32 bits
+    /// </summary>
+    HistoryBitWriter l_wide;
+    l_wide.write(0x41200000u, 32);
+    l_wide.write(0x3, 2);
+    l_wide.write(31, 5);
+    l_wide.write(31, 5);
+    l_wide.write(0, 32);
+    l_wide.align();
+    l_chunk = l_makeChunk(l_wide, 2);
+    EXPECT_EQ(0u, HistoryDecoder::decode(l_chunk.data(), l_chunk.size(), l_ts, l_values));
+
+    /// <summary>
+    /// Previous window used before any was written
+    /// </summary>
+    HistoryBitWriter l_noWindow;
+    l_noWindow.write(0x41200000u, 32);
+    l_noWindow.write(0x2, 2);
+    l_noWindow.write(0, 30);
+    l_noWindow.align();
+    l_chunk = l_makeChunk(l_noWindow, 2);
+    EXPECT_EQ(0u, HistoryDecoder::decode(l_chunk.data(), l_chunk.size(), l_ts, l_values));
+
+    /// <summary>
+    /// Count larger than the value column holds: the padding of
+    /// the last byte is 4 unchanged samples, no more
+    /// </summary>
+    l_chunk = l_makeChunk(l_valid, 6);
+    EXPECT_EQ(6u, HistoryDecoder::decode(l_chunk.data(), l_chunk.size(), l_ts, l_values));
+    l_chunk = l_makeChunk(l_valid, 8);
+    EXPECT_EQ(0u, HistoryDecoder::decode(l_chunk.data(), l_chunk.size(), l_ts, l_values));
+
+    /// <summary>
+    /// Count past one bit per sample: refused by parse, before any
+    /// output is written
+    /// </summary>
+    HistoryChunkHeader l_header;
+    l_chunk = l_makeChunk(l_valid, 0x7FFFFFFFu);
+    EXPECT_FALSE(HistoryDecoder::parse(l_chunk.data(), l_chunk.size(), l_header));
+    EXPECT_EQ(0u, HistoryDecoder::decode(l_chunk.data(), l_chunk.size(), nullptr, nullptr));
+    l_chunk = l_makeChunk(l_valid, 10);
+    EXPECT_FALSE(HistoryDecoder::parse(l_chunk.data(), l_chunk.size(), l_header));
+}
+
+TEST(testHistory, recorderCompression)
+{
+    /// <summary>
+    /// 5 ms scan, 0.01 degree probe resolution, slow drift:
+    /// at least 10 times smaller than raw samples. Series are
+    /// selected by box index, whatever the name handle.
+    /// </summary>
+    const size_t l_numBoxes = 4;
+    HistoryRecorder l_recorder(l_numBoxes, 1000);
+    for (int64_t s = 0; s < 10000; s++) {
+        for (uint32_t b = 0; b < l_numBoxes; b++) {
+            temp_t l_temp = std::round((30.0f + b + (temp_t)s * 0.0002f) * 100.0f) / 100.0f;
+            l_recorder.push(makeMonitoringTemp((1684000000000LL + s * ISO_SCAN_RATE) * 1000000, 3 - b, l_temp, CELSIUS, b));
+        }
+    }
+    l_recorder.push(makeMonitoringTemp(0, 0, 0.0f, CELSIUS, 99));
+    l_recorder.push(makeMonitoringTemp(0, 1, 0.0f, CELSIUS));
+    l_recorder.sealAll();
+
+    std::vector<HistoryChunk> l_chunks;
+    EXPECT_EQ(40u, l_recorder.takeChunks(l_chunks));
+    EXPECT_EQ(0u, l_recorder.takeChunks(l_chunks));
+    EXPECT_GT(l_recorder.getRawBytes(), 10 * l_recorder.getEncodedBytes());
+
+    /// <summary>
+    /// Chunks of a box decode back to its series, in order
+    /// </summary>
+    std::vector<int64_t> l_ts(1000);
+    std::vector<temp_t> l_values(1000);
+    int64_t l_next = 0;
+    for (const HistoryChunk &l_chunk : l_chunks) {
+        if (l_chunk.id != 2)
+            continue;
+        size_t l_count = HistoryDecoder::decode(l_chunk.bytes.data(), l_chunk.bytes.size(),
+                                                l_ts.data(), l_values.data());
+        ASSERT_EQ(1000u, l_count);
+        for (size_t i = 0; i < l_count; i++, l_next++) {
+            ASSERT_EQ(1684000000000LL + l_next * ISO_SCAN_RATE, l_ts[i]);
+            ASSERT_EQ(std::round((32.0f + (temp_t)l_next * 0.0002f) * 100.0f) / 100.0f, l_values[i]);
+        }
+    }
+    EXPECT_EQ(10000, l_next);
+}
+
+TEST(testIdRegistry, internAndResolve)
+{
+    IsoIdRegistry l_registry;
+    EXPECT_EQ(ISO_ID_INVALID, l_registry.find("box_0"));
+    EXPECT_EQ(0u, l_registry.intern("box_0"));
+    EXPECT_EQ(1u, l_registry.intern("box_1"));
+    EXPECT_EQ(0u, l_registry.intern("box_0"));
+    EXPECT_EQ(1u, l_registry.find("box_1"));
+    EXPECT_EQ(2u, l_registry.size());
+
+    /// <summary>
+    /// Names keep their address while the registry grows
+    /// </summary>
+    const std::string &l_name = l_registry.getName(1);
+    for (int i = 2; i < 1000; i++)
+        l_registry.intern("box_" + std::to_string(i));
+    EXPECT_EQ("box_1", l_name);
+    EXPECT_EQ(&l_name, &l_registry.getName(1));
+    EXPECT_TRUE(l_registry.getName(5000).empty());
+
+    /// <summary>
+    /// Samples carry the handle, the name comes back at the sink
+    /// </summary>
+    isoId_t l_probe = IsoIdRegistry::instance().intern("oven_probe");
+    char l_text[64];
+    formatNamed(makeMonitoringTemp(1684000000123456789LL, l_probe, 36.5f, CELSIUS), l_text, sizeof(l_text));
+    EXPECT_STREQ("1684000000123 oven_probe 36.50 C", l_text);
+    formatNamed(makeMonitoringTemp(1684000000123456789LL, 123456, 36.5f, CELSIUS), l_text, sizeof(l_text));
+    EXPECT_STREQ("1684000000123 123456 36.50 C", l_text);
+}
+
+TEST(testMetrics, histogramBuckets)
+{
+    /// <summary>
+    /// Small values are exact, larger ones within 1/16
+    /// </summary>
+    for (uint64_t l_value = 0; l_value < ISO_METRICS_SUB_BUCKETS; l_value++)
+        EXPECT_EQ(l_value, isoMetricsBucketValue(isoMetricsBucket(l_value)));
+    for (uint64_t l_value = 16; l_value < (1ull << 36); l_value = l_value * 3 + 1) {
+        uint64_t l_low = isoMetricsBucketValue(isoMetricsBucket(l_value));
+        EXPECT_LE(l_low, l_value);
+        EXPECT_LT(l_value - l_low, l_value / ISO_METRICS_SUB_BUCKETS + 1);
+    }
+    EXPECT_EQ(ISO_METRICS_HIST_BUCKETS - 1, isoMetricsBucket(~0ull));
+
+    /// <summary>
+    /// Shards of two threads merged by the snapshot
+    /// </summary>
+    IsoMetrics l_metrics(4);
+    IsoMetricsShard *l_first = l_metrics.registerThread();
+    IsoMetricsShard *l_second = l_metrics.registerThread();
+    for (uint64_t i = 1; i <= 1000; i++)
+        l_first->record(METRIC_COMPENSATION_NS, i * 100);
+    l_second->record(METRIC_COMPENSATION_NS, 1000000);
+    l_first->count(METRIC_COMPENSATIONS, 1000);
+    l_second->count(METRIC_COMPENSATIONS);
+    l_metrics.boxOutOfRange(2);
+    l_metrics.boxOutOfRange(7);
+
+    IsoMetricsSnapshot l_snapshot;
+    l_metrics.snapshot(l_snapshot);
+    const IsoHistogramSnapshot &l_hist = l_snapshot.latencies[METRIC_COMPENSATION_NS];
+    EXPECT_EQ(1001u, l_snapshot.counters[METRIC_COMPENSATIONS]);
+    EXPECT_EQ(1001u, l_hist.count);
+    EXPECT_EQ(1000000u, l_hist.max);
+    EXPECT_NEAR(50000.0, (double)l_hist.percentile(0.5), 50000.0 / ISO_METRICS_SUB_BUCKETS);
+    EXPECT_NEAR(99000.0, (double)l_hist.percentile(0.99), 99000.0 / ISO_METRICS_SUB_BUCKETS);
+    EXPECT_EQ(1000000u, l_hist.percentile(1.0));
+    EXPECT_EQ(0u, l_snapshot.latencies[METRIC_QUEUE_DWELL_NS].count);
+    EXPECT_EQ(1u, l_snapshot.boxOutOfRange[2]);
+    EXPECT_EQ(4u, l_snapshot.boxOutOfRange.size());
+}
+
+TEST(testMetrics, schedulerCompensations)
+{
+    isoBoxScheduler l_scheduler(10, 2);
+    IsoMetrics l_metrics(l_scheduler.getNumBoxes());
+    l_scheduler.setMetrics(&l_metrics);
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++) {
+        l_scheduler.initBox(i, 25.0, 50.0);
+        l_scheduler.postTemp(i, (i < 5) ? 37.0f : 51.0f);
+    }
+
+    /// <summary>
+    /// One period: every box compensated once, the out of range
+    /// half switches its target to the upper limit
+    /// </summary>
+    isoBoxScheduler::isoClock_t::time_point l_start = isoBoxScheduler::isoClock_t::now();
+    l_scheduler.poll(l_start);
+    l_scheduler.poll(l_start + timeProcess_t(ISO_SCAN_RATE) - std::chrono::microseconds(1));
+
+    IsoMetricsSnapshot l_snapshot;
+    l_metrics.snapshot(l_snapshot);
+    EXPECT_EQ(10u, l_snapshot.counters[METRIC_COMPENSATIONS]);
+    EXPECT_EQ(5u, l_snapshot.counters[METRIC_OUT_OF_RANGE]);
+    EXPECT_EQ(10u, l_snapshot.latencies[METRIC_COMPENSATION_NS].count);
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++) {
+        EXPECT_EQ((i < 5) ? 0u : 1u, l_snapshot.boxOutOfRange[i]);
+        EXPECT_EQ((i < 5) ? 0u : 1u, l_snapshot.boxTargetSwitches[i]);
+    }
+}
+
+TEST(testExporter, openMetricsText)
+{
+    IsoMetrics l_metrics(2);
+    IsoMetricsShard *l_shard = l_metrics.registerThread();
+    l_shard->count(METRIC_COMPENSATIONS, 3);
+    l_shard->record(METRIC_COMPENSATION_NS, 100);
+    l_shard->record(METRIC_COMPENSATION_NS, 100);
+    l_shard->record(METRIC_COMPENSATION_NS, 5000);
+    l_metrics.boxTargetSwitch(1);
+
+    IsoMetricsSnapshot l_snapshot;
+    l_metrics.snapshot(l_snapshot);
+    std::string l_text;
+    formatOpenMetrics(l_snapshot, l_text);
+
+    EXPECT_NE(std::string::npos, l_text.find("# TYPE iso_compensations counter\n"));
+    EXPECT_NE(std::string::npos, l_text.find("\niso_compensations_total 3\n"));
+    EXPECT_NE(std::string::npos, l_text.find("\niso_compensation_seconds_bucket{le=\"1.04e-07\"} 2\n"));
+    EXPECT_NE(std::string::npos, l_text.find("\niso_compensation_seconds_bucket{le=\"+Inf\"} 3\n"));
+    EXPECT_NE(std::string::npos, l_text.find("\niso_compensation_seconds_count 3\n"));
+    EXPECT_NE(std::string::npos, l_text.find("\niso_compensation_seconds_sum 0.000005200\n"));
+    EXPECT_NE(std::string::npos, l_text.find("\niso_box_target_switches_total{box=\"1\"} 1\n"));
+    EXPECT_EQ(l_text.size() - 6, l_text.rfind("# EOF\n"));
+
+    /// <summary>
+    /// The buffer is reused: no reallocation for the same content
+    /// </summary>
+    const char *l_data = l_text.data();
+    formatOpenMetrics(l_snapshot, l_text);
+    EXPECT_EQ(l_data, l_text.data());
+}
+
+#ifndef _WIN32
+/// <summary>
+/// Minimal HTTP client: the whole answer, until the server closes
+/// </summary>
+static std::string scrape(int _family, const sockaddr *_address, socklen_t _length)
+{
+    int l_socket = socket(_family, SOCK_STREAM, 0);
+    if (l_socket < 0 || connect(l_socket, _address, _length) != 0) {
+        if (l_socket >= 0)
+            close(l_socket);
+        return std::string();
+    }
+    const char l_request[] = "GET /metrics HTTP/1.0\r\nHost: localhost\r\n\r\n";
+    send(l_socket, l_request, sizeof(l_request) - 1, 0);
+
+    std::string l_answer;
+    char l_buffer[4096];
+    ssize_t l_read;
+    while ((l_read = recv(l_socket, l_buffer, sizeof(l_buffer), 0)) > 0)
+        l_answer.append(l_buffer, (size_t)l_read);
+    close(l_socket);
+    return l_answer;
+}
+
+TEST(testExporter, scrapeSockets)
+{
+    IsoMetrics l_metrics(1000);
+    IsoMetricsShard *l_shard = l_metrics.registerThread();
+    l_shard->count(METRIC_OUT_OF_RANGE, 7);
+    l_metrics.boxOutOfRange(999);
+
+    IsoMetricsExporter l_exporter(&l_metrics);
+    ASSERT_TRUE(l_exporter.startTcp(0));
+    EXPECT_FALSE(l_exporter.startTcp(0));
+    ASSERT_NE(0, l_exporter.getPort());
+
+    sockaddr_in l_tcp;
+    memset(&l_tcp, 0, sizeof(l_tcp));
+    l_tcp.sin_family = AF_INET;
+    l_tcp.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    l_tcp.sin_port = htons(l_exporter.getPort());
+    std::string l_answer = scrape(AF_INET, (sockaddr *)&l_tcp, sizeof(l_tcp));
+    EXPECT_EQ(0u, l_answer.find("HTTP/1.0 200 OK\r\n"));
+    EXPECT_NE(std::string::npos, l_answer.find("Content-Type: application/openmetrics-text"));
+    EXPECT_NE(std::string::npos, l_answer.find("\niso_out_of_range_total 7\n"));
+    EXPECT_NE(std::string::npos, l_answer.find("\niso_box_out_of_range_total{box=\"999\"} 1\n"));
+
+    /// <summary>
+    /// Each scrape is a new snapshot
+    /// </summary>
+    l_shard->count(METRIC_OUT_OF_RANGE);
+    l_answer = scrape(AF_INET, (sockaddr *)&l_tcp, sizeof(l_tcp));
+    EXPECT_NE(std::string::npos, l_answer.find("\niso_out_of_range_total 8\n"));
+    EXPECT_EQ(2u, l_exporter.getScrapes());
+    l_exporter.stop();
+    EXPECT_FALSE(l_exporter.isRunning());
+
+    std::string l_path = ::testing::TempDir() + "isobox_exporter_test.sock";
+    sockaddr_un l_unix;
+    ASSERT_LT(l_path.size(), sizeof(l_unix.sun_path));
+    ASSERT_TRUE(l_exporter.startUnix(l_path));
+    memset(&l_unix, 0, sizeof(l_unix));
+    l_unix.sun_family = AF_UNIX;
+    strcpy(l_unix.sun_path, l_path.c_str());
+    l_answer = scrape(AF_UNIX, (sockaddr *)&l_unix, sizeof(l_unix));
+    EXPECT_EQ(0u, l_answer.find("HTTP/1.0 200 OK\r\n"));
+    EXPECT_EQ(l_answer.size() - 6, l_answer.rfind("# EOF\n"));
+    l_exporter.stop();
+    EXPECT_NE(0, access(l_path.c_str(), F_OK));
+}
+#endif
+
+/// <summary>
+/// Spans of a given name in a Chrome trace
+/// </summary>
+static size_t countSpans(const std::string &_json, const std::string &_name)
+{
+    std::string l_key = "{\"name\":\"" + _name + "\",\"ph\":\"X\"";
+    size_t l_count = 0;
+    for (size_t l_pos = _json.find(l_key); l_pos != std::string::npos; l_pos = _json.find(l_key, l_pos + 1))
+        l_count++;
+    return l_count;
+}
+
+TEST(testTrace, ringsAndChromeExport)
+{
+    IsoTracer &l_tracer = IsoTracer::instance();
+    uint64_t l_recorded = l_tracer.getRecorded();
+
+    /// <summary>
+    /// Nested spans on two threads, each in its own ring
+    /// </summary>
+    std::vector<std::thread> l_threads;
+    for (int t = 0; t < 2; t++) {
+        l_threads.emplace_back([]() {
+            for (int i = 0; i < 100; i++) {
+                IsoTraceScope l_outer("testTrace.outer");
+                IsoTraceScope l_inner("testTrace.inner");
+            }
+        });
+    }
+    for (auto &l_thread : l_threads)
+        l_thread.join();
+    EXPECT_EQ(l_recorded + 400, l_tracer.getRecorded());
+
+    std::string l_json;
+    l_tracer.exportChromeJson(l_json);
+    EXPECT_EQ(0u, l_json.find("{\"traceEvents\":["));
+    EXPECT_EQ(200u, countSpans(l_json, "testTrace.outer"));
+    EXPECT_EQ(200u, countSpans(l_json, "testTrace.inner"));
+
+    /// <summary>
+    /// A full ring keeps the latest spans only
+    /// </summary>
+    std::thread l_busy([]() {
+        for (unsigned i = 0; i < ISO_TRACE_RING_EVENTS; i++)
+            IsoTraceScope l_old("testTrace.old");
+        for (unsigned i = 0; i < 10; i++)
+            IsoTraceScope l_new("testTrace.new");
+    });
+    l_busy.join();
+    l_tracer.exportChromeJson(l_json);
+    EXPECT_EQ(ISO_TRACE_RING_EVENTS - 10, countSpans(l_json, "testTrace.old"));
+    EXPECT_EQ(10u, countSpans(l_json, "testTrace.new"));
+
+    /// <summary>
+    /// Paused: nothing recorded
+    /// </summary>
+    l_tracer.setEnabled(false);
+    {
+        IsoTraceScope l_skipped("testTrace.skipped");
+    }
+    l_tracer.setEnabled(true);
+    l_tracer.exportChromeJson(l_json);
+    EXPECT_EQ(0u, countSpans(l_json, "testTrace.skipped"));
+}
+
+TEST(testPrintDebug, deferredFormat)
+{
+    /// <summary>
+    /// Placeholders filled from the binary arguments
+    /// </summary>
+    IsoLogRecord l_record;
+    l_record.format = "box {} at {} C, probe {} ({}) {}";
+    l_record.ts = 1684000000123;
+    l_record.thread = 3;
+    l_record.level = ISO_LOG_WARNING;
+    l_record.numArgs = 4;
+    isoLogEncodeArgs(l_record.args, 12u, -3.5f, std::string("oven_probe_with_a_very_long_name"), -7);
+    std::string l_line;
+    ISO_printDebug::formatRecord(l_record, l_line);
+    EXPECT_EQ("1684000000123 WARNING [3] box 12 at -3.5 C, probe oven_probe_with_a_very_ (-7) {}\n", l_line);
+
+    /// <summary>
+    /// Lines come out of the background thread in order
+    /// </summary>
+    std::mutex l_mutex;
+    std::vector<std::string> l_lines;
+    ISO_printDebug &l_logger = ISO_printDebug::instance();
+    EXPECT_TRUE(l_logger.flush());
+    uint64_t l_dropped = l_logger.getDropped();
+    l_logger.setSink([&](const char *_line, size_t _length) {
+        std::lock_guard<std::mutex> l_lock(l_mutex);
+        l_lines.push_back(std::string(_line, _length));
+    });
+    for (int i = 0; i < 100; i++)
+        ISO_printDebug::printDebug("step {} of {}", i, "testPrintDebug");
+    l_logger.setLevel(ISO_LOG_INFO);
+    ISO_printDebug::printDebug("filtered");
+    l_logger.log(ISO_LOG_ERROR, "error {}", 1.25);
+    l_logger.setLevel(ISO_LOG_DEBUG);
+    EXPECT_TRUE(l_logger.flush());
+    l_logger.setSink(IsoLogSink_t());
+
+    ASSERT_EQ(101u, l_lines.size());
+    EXPECT_NE(std::string::npos, l_lines[0].find(" DEBUG ["));
+    EXPECT_NE(std::string::npos, l_lines[0].find("] step 0 of testPrintDebug\n"));
+    EXPECT_NE(std::string::npos, l_lines[99].find("] step 99 of testPrintDebug\n"));
+    EXPECT_NE(std::string::npos, l_lines[100].find(" ERROR ["));
+    EXPECT_NE(std::string::npos, l_lines[100].find("] error 1.25\n"));
+    EXPECT_EQ(l_dropped, l_logger.getDropped());
+}
+
+TEST(testProfile, importWriteLoad)
+{
+    const std::string l_text = ::testing::TempDir() + "isobox_test_profiles.csv";
+    const std::string l_binary = ::testing::TempDir() + "isobox_test_profiles.bin";
+    IsoMappedFile::remove(l_text);
+    IsoMappedFile::remove(l_binary);
+
+    FILE *l_file = fopen(l_text.c_str(), "w");
+    ASSERT_NE(nullptr, l_file);
+    fputs("# box,name,description,kP,kI,kD,volume\n"
+          "0, oven_a, left oven, 4.5, 0.25, 0.125, 12\n"
+          "\n"
+          "2,oven_c,,8,1,0.5,20\n"
+          "7,outside,not in the pool,1,1,1,1\n", l_file);
+    fclose(l_file);
+
+    std::vector<IsoProfileEntry> l_entries;
+    ASSERT_TRUE(IsoProfileStore::importText(l_text, l_entries));
+    ASSERT_EQ(3u, l_entries.size());
+    EXPECT_EQ("oven_a", l_entries[0].name);
+    EXPECT_EQ("left oven", l_entries[0].description);
+    ASSERT_TRUE(IsoProfileStore::write(l_binary, l_entries));
+
+    /// <summary>
+    /// Mapped records applied to the pool, out of pool boxes skipped
+    /// </summary>
+    IsoProfileStore l_store;
+    ASSERT_TRUE(l_store.open(l_binary));
+    ASSERT_EQ(3u, l_store.getCount());
+    EXPECT_STREQ("oven_c", l_store.getName(1));
+    EXPECT_STREQ("", l_store.getDescription(1));
+
+    std::vector<isoBox> l_boxes(4);
+    EXPECT_EQ(2u, l_store.applyTo(l_boxes.size(), [&](size_t _box) -> isoBox & { return l_boxes[_box]; }));
+    EXPECT_EQ(4.5f, l_boxes[0].getController().getKp());
+    EXPECT_EQ(0.25f, l_boxes[0].getController().getKi());
+    EXPECT_EQ(0.125f, l_boxes[0].getController().getKd());
+    EXPECT_EQ(8.0f, l_boxes[2].getController().getKp());
+    EXPECT_EQ(l_boxes[3].getController().getKp(), l_boxes[1].getController().getKp());
+
+    IsoIdRegistry l_registry;
+    PidDataStruct l_data = l_store.getPidData(0, l_registry);
+    EXPECT_EQ("oven_a", l_registry.getName(l_data.name));
+    EXPECT_EQ("left oven", l_registry.getName(l_data.description));
+    EXPECT_EQ(12.0f, l_data.volume);
+    l_store.close();
+
+    /// <summary>
+    /// Invalid text line reported, damaged binary refused
+    /// </summary>
+    l_file = fopen(l_text.c_str(), "w");
+    fputs("1,a,b,1,2,3,4\n-1,a,b,1,2,3,4\n", l_file);
+    fclose(l_file);
+    size_t l_errorLine = 0;
+    l_entries.clear();
+    EXPECT_FALSE(IsoProfileStore::importText(l_text, l_entries, &l_errorLine));
+    EXPECT_EQ(2u, l_errorLine);
+
+    IsoMappedFile l_mapped;
+    ASSERT_TRUE(l_mapped.open(l_binary, true));
+    l_mapped.data()[8] = 2;
+    l_mapped.close();
+    EXPECT_FALSE(l_store.open(l_binary));
+    EXPECT_FALSE(l_store.isOpen());
+
+    IsoMappedFile::remove(l_text);
+    IsoMappedFile::remove(l_binary);
+}
+
+TEST(testConfig, doubleBufferSnapshots)
+{
+    /// <summary>
+    /// Every field of a publication derives from the same n: a
+    /// reader must never see two publications mixed
+    /// </summary>
+    IsoDoubleBuffer<IsoBoxConfig> l_buffer;
+    IsoBoxConfig l_config;
+    EXPECT_EQ(0u, l_buffer.read(l_config));
+
+    std::atomic<bool> l_done(false);
+    std::thread l_writer([&]() {
+        for (int n = 1; n <= 200000; n++) {
+            IsoBoxConfig l_next = { ISO_CONFIG_GAINS, (temp_t)n, (temp_t)n + 1, (temp_t)n + 2,
+                                    (temp_t)n + 3, (temp_t)n + 4 };
+            l_buffer.publish(l_next);
+        }
+        l_done.store(true);
+    });
+
+    uint64_t l_lastVersion = 0;
+    size_t l_reads = 0;
+    while (!l_done.load() || l_reads == 0) {
+        uint64_t l_version = l_buffer.read(l_config);
+        EXPECT_GE(l_version, l_lastVersion);
+        l_lastVersion = l_version;
+        if (l_version > 0) {
+            ASSERT_EQ(l_config.min + 1, l_config.max);
+            ASSERT_EQ(l_config.min + 2, l_config.kP);
+            ASSERT_EQ(l_config.min + 4, l_config.kD);
+        }
+        l_reads++;
+    }
+    l_writer.join();
+    EXPECT_EQ(200000u, l_buffer.read(l_config));
+    EXPECT_EQ(200000.0f, l_config.min);
+}
+
+TEST(testConfig, schedulerHotSwap)
+{
+    isoBoxScheduler l_scheduler(4, 1);
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++) {
+        l_scheduler.initBox(i, 25.0, 50.0);
+        l_scheduler.postTemp(i, 40.0);
+    }
+    isoBoxScheduler::isoClock_t::time_point l_now = isoBoxScheduler::isoClock_t::now();
+    l_scheduler.poll(l_now);
+
+    /// <summary>
+    /// Published while the pool runs, applied at the next step
+    /// </summary>
+    IsoBoxConfig l_config = { ISO_CONFIG_SET_POINTS | ISO_CONFIG_GAINS, 30.0f, 45.0f, 7.0f, 0.5f, 0.25f };
+    EXPECT_TRUE(l_scheduler.publishConfig(1, l_config));
+    EXPECT_FALSE(l_scheduler.publishConfig(4, l_config));
+    EXPECT_EQ(0u, l_scheduler.getAppliedConfig(1));
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    l_scheduler.poll(l_now);
+    EXPECT_EQ(1u, l_scheduler.getAppliedConfig(1));
+    EXPECT_EQ(0u, l_scheduler.getAppliedConfig(0));
+    EXPECT_EQ(30.0f, l_scheduler.getBox(1).getSetPoint(PID_MIN_SET_POINT));
+    EXPECT_EQ(45.0f, l_scheduler.getBox(1).getSetPoint(PID_MAX_SET_POINT));
+    EXPECT_EQ(7.0f, l_scheduler.getBox(1).getController().getKp());
+    EXPECT_EQ(25.0f, l_scheduler.getBox(0).getSetPoint(PID_MIN_SET_POINT));
+
+    /// <summary>
+    /// Gains only to the whole pool; refused set points keep the old ones
+    /// </summary>
+    l_config.fields = ISO_CONFIG_GAINS;
+    l_config.kP = 3.0f;
+    l_scheduler.publishConfigAll(l_config);
+    l_config = { ISO_CONFIG_SET_POINTS, 50.0f, 20.0f, 0.0f, 0.0f, 0.0f };
+    l_scheduler.publishConfig(2, l_config);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    l_scheduler.poll(l_now);
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++)
+        EXPECT_EQ(3.0f, l_scheduler.getBox(i).getController().getKp()) << i;
+    EXPECT_EQ(30.0f, l_scheduler.getBox(1).getSetPoint(PID_MIN_SET_POINT));
+    EXPECT_EQ(25.0f, l_scheduler.getBox(2).getSetPoint(PID_MIN_SET_POINT));
+    EXPECT_EQ(2u, l_scheduler.getAppliedConfig(2));
+}
+
+TEST(testConfig, refusedSetPointsKeepCompensating)
+{
+    isoBox l_box;
+    ASSERT_TRUE(l_box.init(25.0, 50.0));
+
+    /// <summary>
+    /// min < max but max outside the physical limits: refused, the
+    /// running box keeps its set points and its compensation
+    /// </summary>
+    IsoBoxConfig l_config = { ISO_CONFIG_SET_POINTS, 20.0f, 5000.0f, 0.0f, 0.0f, 0.0f };
+    EXPECT_FALSE(l_box.applyConfig(l_config));
+    EXPECT_TRUE(l_box.getInitDone());
+    EXPECT_EQ(25.0f, l_box.getSetPoint(PID_MIN_SET_POINT));
+    EXPECT_EQ(50.0f, l_box.getSetPoint(PID_MAX_SET_POINT));
+    EXPECT_EQ(50.0f, l_box.applyCompensation(80.0));
+
+    isoBoxScheduler l_scheduler(2, 1);
+    l_scheduler.initBox(0, 25.0, 50.0);
+    l_scheduler.initBox(1, 25.0, 50.0);
+    l_scheduler.publishConfigAll(l_config);
+    isoBoxScheduler::isoClock_t::time_point l_now = isoBoxScheduler::isoClock_t::now();
+    l_scheduler.poll(l_now);
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++) {
+        EXPECT_TRUE(l_scheduler.getBox(i).getInitDone()) << i;
+        EXPECT_EQ(50.0f, l_scheduler.getBox(i).getSetPoint(PID_MAX_SET_POINT)) << i;
+    }
+}
+
+TEST(testScale, batchAndBoxScale)
+{
+    EXPECT_FLOAT_EQ(212.0f, isoConvertTemp(100.0f, CELSIUS, FARENHEIT));
+    EXPECT_FLOAT_EQ(0.0f, isoConvertTemp(273.15f, KELVIN, CELSIUS));
+    EXPECT_NEAR(255.372f, isoConvertTemp(0.0f, FARENHEIT, KELVIN), 1e-3);
+    EXPECT_FLOAT_EQ(9.0f, isoConvertDelta(5.0f, CELSIUS, FARENHEIT));
+
+    /// <summary>
+    /// Batch in place and out of place, odd length for the loop tail
+    /// </summary>
+    std::vector<temp_t> l_temps = { -40.0f, 0.0f, 20.0f, 37.0f, 100.0f, 25.0f, 50.0f };
+    std::vector<temp_t> l_kelvin(l_temps.size());
+    isoConvertTemps(l_temps.data(), l_kelvin.data(), l_temps.size(), CELSIUS, KELVIN);
+    isoConvertTemps(l_temps.data(), l_temps.size(), CELSIUS, FARENHEIT);
+    EXPECT_FLOAT_EQ(-40.0f, l_temps[0]);
+    EXPECT_FLOAT_EQ(98.6f, l_temps[3]);
+    EXPECT_FLOAT_EQ(373.15f, l_kelvin[4]);
+    isoConvertTemps(l_temps.data(), l_temps.size(), FARENHEIT, CELSIUS);
+    EXPECT_NEAR(20.0f, l_temps[2], 1e-4);
+
+    /// <summary>
+    /// A box switched to farenheit: set points converted once, then
+    /// checked and compensated in farenheit
+    /// </summary>
+    isoBoxApi::isoBox l_box;
+    EXPECT_EQ(CELSIUS, l_box.getScale());
+    ASSERT_TRUE(l_box.init(25.0, 50.0));
+    temp_t l_kp = l_box.getController().getKp();
+    l_box.setHysteresis(1.0f, 2.0f);
+    EXPECT_TRUE(l_box.setScale(FARENHEIT));
+    EXPECT_EQ(FARENHEIT, l_box.getScale());
+    EXPECT_FLOAT_EQ(77.0f, l_box.getSetPoint(PID_MIN_SET_POINT));
+    EXPECT_FLOAT_EQ(122.0f, l_box.getSetPoint(PID_MAX_SET_POINT));
+    EXPECT_FLOAT_EQ(l_kp / 1.8f, l_box.getController().getKp());
+    EXPECT_FLOAT_EQ(1.8f, l_box.getHysteresis());
+    EXPECT_FLOAT_EQ(3.6f, l_box.getDeadband());
+    EXPECT_EQ(ISO_DEF_UNDEF_TEMP, l_box.applyCompensation(100.0f));
+    EXPECT_FLOAT_EQ(122.0f, l_box.applyCompensation(130.0f));
+
+    /// <summary>
+    /// Physical limits follow the scale: 20..100 C is 68..212 F
+    /// </summary>
+    EXPECT_TRUE(l_box.init(68.0f, 212.0f));
+    EXPECT_FALSE(l_box.init(60.0f, 150.0f));
+    EXPECT_TRUE(l_box.init(77.0f, 122.0f));
+    EXPECT_TRUE(l_box.setScale(CELSIUS));
+    EXPECT_NEAR(25.0f, l_box.getSetPoint(PID_MIN_SET_POINT), 1e-4);
+    EXPECT_NEAR(l_kp, l_box.getController().getKp(), 1e-4);
+    EXPECT_NEAR(1.0f, l_box.getHysteresis(), 1e-5);
+
+    /// <summary>
+    /// Gains that would leave their limits in the new scale: the
+    /// scale change is refused, gains and scale kept
+    /// </summary>
+    EXPECT_TRUE(l_box.setScale(FARENHEIT));
+    l_box.setGains(900.0f, 1.0f, 0.0f);
+    EXPECT_FALSE(l_box.setScale(CELSIUS));
+    EXPECT_EQ(FARENHEIT, l_box.getScale());
+    EXPECT_FLOAT_EQ(900.0f, l_box.getController().getKp());
+    EXPECT_FALSE(l_box.setScale(MAX_VALUE_TSCALE));
+}
+
+TEST(testScheduler, eventDrivenDirtySet)
+{
+    /// <summary>
+    /// 130 boxes on 2 workers: shards 0..64 and 65..129 share the
+    /// second word of the dirty bitmap
+    /// </summary>
+    isoBoxScheduler l_scheduler(130, 2);
+    l_scheduler.setEventDriven(true);
+    EXPECT_TRUE(l_scheduler.isEventDriven());
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++) {
+        l_scheduler.initBox(i, 25.0, 50.0);
+        l_scheduler.postTemp(i, 40.0);
+    }
+    isoBoxScheduler::isoClock_t::time_point l_now = isoBoxScheduler::isoClock_t::now();
+    EXPECT_EQ(130u, l_scheduler.poll(l_now));
+
+    /// <summary>
+    /// In range samples cost no step
+    /// </summary>
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++)
+        l_scheduler.postTemp(i, 30.0);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(0u, l_scheduler.poll(l_now));
+
+    /// <summary>
+    /// Out of range boxes step every period until they are back
+    /// </summary>
+    l_scheduler.postTemp(64, 60.0);
+    l_scheduler.postTemp(65, 10.0);
+    EXPECT_EQ(0u, l_scheduler.poll(l_now));
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(2u, l_scheduler.poll(l_now));
+    EXPECT_EQ(50.0f, l_scheduler.getBox(64).getTargetPoint());
+    EXPECT_EQ(25.0f, l_scheduler.getBox(65).getTargetPoint());
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(2u, l_scheduler.poll(l_now));
+    l_scheduler.postTemp(64, 45.0);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(2u, l_scheduler.poll(l_now));
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(1u, l_scheduler.poll(l_now));
+
+    /// <summary>
+    /// A new configuration marks its box, and moves its band
+    /// </summary>
+    l_scheduler.postTemp(65, 30.0);
+    IsoBoxConfig l_config = { ISO_CONFIG_SET_POINTS, 35.0f, 45.0f, 0.0f, 0.0f, 0.0f };
+    l_scheduler.publishConfig(3, l_config);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(2u, l_scheduler.poll(l_now));
+    EXPECT_EQ(35.0f, l_scheduler.getBox(3).getSetPoint(PID_MIN_SET_POINT));
+    l_scheduler.postTemp(3, 30.0);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(1u, l_scheduler.poll(l_now));
+    EXPECT_EQ(140u, l_scheduler.getStats().ticks);
+}
+
+TEST(testScheduler, eventDrivenDwell)
+{
+    /// <summary>
+    /// Dwell of 10 periods. The box switches to the max target, goes
+    /// back in range and idle: it is not stepped for 20 periods
+    /// </summary>
+    isoBoxScheduler l_scheduler(1, 1);
+    l_scheduler.setEventDriven(true);
+    l_scheduler.initBox(0, 25.0, 50.0);
+    l_scheduler.getBox(0).setHysteresis(0.0f, 0.0f, timeProcess_t(10 * ISO_SCAN_RATE));
+    isoBoxScheduler::isoClock_t::time_point l_now = isoBoxScheduler::isoClock_t::now();
+    l_scheduler.postTemp(0, 60.0);
+    EXPECT_EQ(1u, l_scheduler.poll(l_now));
+    EXPECT_EQ(50.0f, l_scheduler.getBox(0).getTargetPoint());
+    l_scheduler.postTemp(0, 40.0);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(1u, l_scheduler.poll(l_now));
+    l_now += timeProcess_t(20 * ISO_SCAN_RATE);
+    EXPECT_EQ(0u, l_scheduler.poll(l_now));
+
+    /// <summary>
+    /// The dwell elapsed while the box was idle: the next excursion
+    /// switches at once, the one after is held by the dwell
+    /// </summary>
+    l_scheduler.postTemp(0, 10.0);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(1u, l_scheduler.poll(l_now));
+    EXPECT_EQ(25.0f, l_scheduler.getBox(0).getTargetPoint());
+    EXPECT_EQ(0u, l_scheduler.getBox(0).getSwitchesAvoided());
+    l_scheduler.postTemp(0, 60.0);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(1u, l_scheduler.poll(l_now));
+    EXPECT_EQ(25.0f, l_scheduler.getBox(0).getTargetPoint());
+    EXPECT_EQ(1u, l_scheduler.getBox(0).getSwitchesAvoided());
+}
+
+TEST(testIsoBoxCmake, hysteresisDeadbandDwell)
+{
+    isoBoxApi::isoBox l_box;
+    ASSERT_TRUE(l_box.init(25.0, 50.0));
+
+    /// <summary>
+    /// Off by default: the first sample past a set point compensates
+    /// </summary>
+    EXPECT_EQ(25.0f, l_box.applyCompensation(24.9f));
+    EXPECT_EQ(ISO_DEF_UNDEF_TEMP, l_box.applyCompensation(30.0f));
+    EXPECT_EQ(0u, l_box.getRestartsAvoided());
+
+    /// <summary>
+    /// Deadband 0.5: an idle box ignores small excursions, a
+    /// compensating one goes on until back in range
+    /// </summary>
+    l_box.setHysteresis(1.0f, 0.5f, timeProcess_t(4 * ISO_SCAN_RATE));
+    EXPECT_EQ(ISO_DEF_UNDEF_TEMP, l_box.applyCompensation(24.7f));
+    EXPECT_EQ(1u, l_box.getRestartsAvoided());
+    EXPECT_EQ(25.0f, l_box.applyCompensation(24.0f));
+    EXPECT_EQ(25.0f, l_box.applyCompensation(24.8f));
+    EXPECT_EQ(ISO_DEF_UNDEF_TEMP, l_box.applyCompensation(30.0f));
+    EXPECT_EQ(ISO_DEF_UNDEF_TEMP, l_box.applyCompensation(50.3f));
+    EXPECT_EQ(2u, l_box.getRestartsAvoided());
+
+    /// <summary>
+    /// Hysteresis 1: 50.8 keeps the min target, 51.2 switches
+    /// </summary>
+    isoBoxApi::isoBox::isoClock_t::time_point l_now = isoBoxApi::isoBox::isoClock_t::now();
+    EXPECT_EQ(25.0f, l_box.applyCompensation(50.8f, l_now));
+    EXPECT_EQ(1u, l_box.getSwitchesAvoided());
+    EXPECT_EQ(50.0f, l_box.applyCompensation(51.2f, l_now));
+
+    /// <summary>
+    /// Dwell of 4 scan periods before switching back, whatever the
+    /// number of samples in between
+    /// </summary>
+    EXPECT_EQ(50.0f, l_box.applyCompensation(23.0f, l_now + timeProcess_t(1)));
+    EXPECT_EQ(50.0f, l_box.applyCompensation(23.0f, l_now + timeProcess_t(2 * ISO_SCAN_RATE)));
+    EXPECT_EQ(50.0f, l_box.applyCompensation(23.0f, l_now + timeProcess_t(4 * ISO_SCAN_RATE - 1)));
+    EXPECT_EQ(4u, l_box.getSwitchesAvoided());
+    EXPECT_EQ(25.0f, l_box.applyCompensation(23.0f, l_now + timeProcess_t(4 * ISO_SCAN_RATE)));
+    EXPECT_EQ(4u, l_box.getSwitchesAvoided());
+
+    /// <summary>
+    /// Defaults: ISO_DEF_TRSH__CMP_TEMP band, no dwell
+    /// </summary>
+    l_box.setHysteresis();
+    EXPECT_EQ(ISO_DEF_UNDEF_TEMP, l_box.applyCompensation(30.0f));
+    EXPECT_EQ(ISO_DEF_UNDEF_TEMP, l_box.applyCompensation(50.05f));
+    EXPECT_EQ(50.0f, l_box.applyCompensation(50.15f));
+    EXPECT_EQ(50.0f, l_box.applyCompensation(24.95f));
+    EXPECT_EQ(5u, l_box.getSwitchesAvoided());
+    EXPECT_EQ(25.0f, l_box.applyCompensation(24.85f));
+}
+
+TEST(testProbeFile, directoryStandIn)
+{
+    /// <summary>
+    /// 600 probes: more than two io_uring batches
+    /// </summary>
+    std::string l_dir = ::testing::TempDir() + "isobox_probe_test";
+    IsoProbeDirectory l_directory;
+    ASSERT_TRUE(l_directory.create(l_dir, 600, 21.5f));
+    l_directory.set(3, -4.25f);
+    l_directory.set(599, 105.0f);
+
+    FileProbeSource l_probes;
+    ASSERT_TRUE(l_probes.openDirectory(l_dir, "probe"));
+    ASSERT_EQ(600u, l_probes.getNumProbes());
+    std::vector<temp_t> l_temps(600);
+    EXPECT_EQ(600u, l_probes.read(0, 600, l_temps.data()));
+    EXPECT_FLOAT_EQ(21.5f, l_temps[0]);
+    EXPECT_FLOAT_EQ(-4.25f, l_temps[3]);
+    EXPECT_FLOAT_EQ(105.0f, l_temps[599]);
+    EXPECT_EQ(0u, l_probes.getErrors());
+
+    /// <summary>
+    /// The descriptors stay open: a new value is seen by the next
+    /// read, and ranges are clamped to the probes
+    /// </summary>
+    l_directory.set(590, 30.0f);
+    EXPECT_EQ(10u, l_probes.read(590, 100, l_temps.data()));
+    EXPECT_FLOAT_EQ(30.0f, l_temps[0]);
+    EXPECT_EQ(0u, l_probes.read(600, 1, l_temps.data()));
+
+    /// <summary>
+    /// A missing or unreadable probe keeps its last value and counts
+    /// an error, the others are still read
+    /// </summary>
+    std::vector<std::string> l_paths = { l_directory.getPaths()[1], l_dir + "/missing_input",
+                                         l_directory.getPaths()[2] };
+    EXPECT_FALSE(l_probes.open(l_paths));
+    EXPECT_EQ(3u, l_probes.read(0, 3, l_temps.data()));
+    EXPECT_FLOAT_EQ(21.5f, l_temps[0]);
+    EXPECT_EQ(ISO_PROBE_UNREAD, l_temps[1]);
+    EXPECT_FLOAT_EQ(21.5f, l_temps[2]);
+    EXPECT_EQ(1u, l_probes.getErrors());
+
+    /// <summary>
+    /// Feeding the data entry pipeline
+    /// </summary>
+    ASSERT_TRUE(l_probes.openDirectory(l_dir, "probe"));
+    MonitoringDataQueue l_queue;
+    DataEntryParams l_params = dataEntryDefaults(600);
+    ISO_DataEntryQueue l_pipeline(&l_queue, &l_probes, l_params);
+    for (size_t i = 0; i < 600; i++)
+        l_pipeline.initBox(i, 25.0, 50.0);
+    l_pipeline.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    l_pipeline.stop();
+    DataEntryStats l_stats = l_pipeline.getStats();
+    EXPECT_GE(l_stats.producer.items, 600u);
+    EXPECT_GT(l_stats.compensations, 0u);
+    EXPECT_EQ(0u, l_probes.getErrors());
+}
+
+TEST(testProbeFile, missingProbeInPipeline)
+{
+    /// <summary>
+    /// 4 probes in range, the third file is missing: its box never
+    /// gets a sample, no box compensates
+    /// </summary>
+    std::string l_dir = ::testing::TempDir() + "isobox_probe_missing_test";
+    IsoProbeDirectory l_directory;
+    ASSERT_TRUE(l_directory.create(l_dir, 4, 30.0f));
+    std::vector<std::string> l_paths = l_directory.getPaths();
+    l_paths[2] = l_dir + "/missing_input";
+    FileProbeSource l_probes;
+    EXPECT_FALSE(l_probes.open(l_paths));
+
+    MonitoringDataQueue l_queue;
+    DataEntryParams l_params = dataEntryDefaults(4);
+    ISO_DataEntryQueue l_pipeline(&l_queue, &l_probes, l_params);
+    for (size_t i = 0; i < 4; i++)
+        l_pipeline.initBox(i, 25.0, 50.0);
+    l_pipeline.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(ISO_SCAN_RATE * 10));
+    l_pipeline.stop();
+
+    DataEntryStats l_stats = l_pipeline.getStats();
+    EXPECT_GE(l_stats.producer.items, 4u);
+    EXPECT_EQ(l_stats.producer.items, l_stats.consumer.items);
+    EXPECT_EQ(0u, l_stats.compensations);
+    EXPECT_GT(l_probes.getErrors(), 0u);
+    EXPECT_EQ(0.0f, l_pipeline.getBox(2).getController().getOutput());
+}
+
+TEST(testFilter, streamsAndBank)
+{
+    /// <summary>
+    /// Median of 5: a single outlier never gets through
+    /// </summary>
+    IsoSampleFilter l_median;
+    EXPECT_FALSE(l_median.isEnabled());
+    EXPECT_EQ(80.0f, l_median.update(80.0f));
+    l_median.setParams(isoFilterDefaults(ISO_FILTER_MEDIAN));
+    EXPECT_TRUE(l_median.isEnabled());
+    const temp_t l_samples[] = { 30.0f, 31.0f, 80.0f, 30.5f, 29.5f, 30.0f, -10.0f, 31.0f };
+    const temp_t l_medians[] = { 30.0f, 30.0f, 31.0f, 30.5f, 30.5f, 30.5f, 30.0f, 30.0f };
+    for (size_t i = 0; i < 8; i++)
+        EXPECT_EQ(l_medians[i], l_median.update(l_samples[i])) << i;
+
+    /// <summary>
+    /// EMA and Kalman start from the first sample and converge
+    /// </summary>
+    IsoSampleFilter l_ema;
+    l_ema.setParams(isoFilterDefaults(ISO_FILTER_EMA));
+    EXPECT_EQ(20.0f, l_ema.update(20.0f));
+    EXPECT_FLOAT_EQ(22.0f, l_ema.update(30.0f));
+    IsoSampleFilter l_kalman;
+    l_kalman.setParams(isoFilterDefaults(ISO_FILTER_KALMAN));
+    EXPECT_EQ(20.0f, l_kalman.update(20.0f));
+    temp_t l_estimate = 0;
+    for (int i = 0; i < 500; i++)
+        l_estimate = l_kalman.update((i & 1) ? 40.5f : 39.5f);
+    EXPECT_NEAR(40.0f, l_estimate, 0.2f);
+
+    /// <summary>
+    /// Out of range parameters are clamped
+    /// </summary>
+    IsoFilterParams l_params = isoFilterDefaults(ISO_FILTER_MEDIAN);
+    l_params.window = 100;
+    l_median.setParams(l_params);
+    EXPECT_EQ(ISO_FILTER_MEDIAN_MAX, l_median.getParams().window);
+
+    /// <summary>
+    /// A bank gives the same values as one stream per box, ranges
+    /// updated separately and in place
+    /// </summary>
+    const IsoFilterType_E l_types[] = { ISO_FILTER_NONE, ISO_FILTER_MEDIAN, ISO_FILTER_EMA, ISO_FILTER_KALMAN };
+    for (IsoFilterType_E l_type : l_types) {
+        const size_t l_numBoxes = 37;
+        IsoFilterBank l_bank(l_numBoxes, isoFilterDefaults(l_type));
+        std::vector<IsoSampleFilter> l_streams(l_numBoxes);
+        for (auto &l_stream : l_streams)
+            l_stream.setParams(isoFilterDefaults(l_type));
+        std::vector<temp_t> l_temps(l_numBoxes);
+        for (int l_step = 0; l_step < 20; l_step++) {
+            for (size_t i = 0; i < l_numBoxes; i++)
+                l_temps[i] = 30.0f + (temp_t)((i * 7 + l_step * 13) % 11);
+            std::vector<temp_t> l_expected(l_numBoxes);
+            for (size_t i = 0; i < l_numBoxes; i++)
+                l_expected[i] = l_streams[i].update(l_temps[i]);
+            l_bank.update(l_temps.data(), l_temps.data(), 0, 20);
+            l_bank.update(l_temps.data() + 20, l_temps.data() + 20, 20, 100);
+            for (size_t i = 0; i < l_numBoxes; i++)
+                ASSERT_FLOAT_EQ(l_expected[i], l_temps[i]) << l_type << " " << i;
+        }
+    }
+
+    /// <summary>
+    /// In front of the compensation: the outlier does not switch
+    /// the target
+    /// </summary>
+    isoBoxApi::isoBox l_box;
+    ASSERT_TRUE(l_box.init(25.0, 50.0));
+    l_box.setFilter(isoFilterDefaults(ISO_FILTER_MEDIAN));
+    EXPECT_EQ(25.0f, l_box.applyCompensation(24.0f));
+    EXPECT_EQ(25.0f, l_box.applyCompensation(24.0f));
+    EXPECT_EQ(25.0f, l_box.applyCompensation(24.0f));
+    EXPECT_EQ(25.0f, l_box.applyCompensation(90.0f));
+    EXPECT_EQ(25.0f, l_box.getTargetPoint());
+}
+
+TEST(testFilter, undefinedSamples)
+{
+    /// <summary>
+    /// No measure (unread probe, NaN, infinite) passes as it is and
+    /// neither seeds nor moves the state
+    /// </summary>
+    const temp_t l_nan = std::numeric_limits<temp_t>::quiet_NaN();
+    const temp_t l_inf = std::numeric_limits<temp_t>::infinity();
+    const IsoFilterType_E l_types[] = { ISO_FILTER_MEDIAN, ISO_FILTER_EMA, ISO_FILTER_KALMAN };
+    for (IsoFilterType_E l_type : l_types) {
+        IsoSampleFilter l_filter;
+        l_filter.setParams(isoFilterDefaults(l_type));
+        EXPECT_EQ(ISO_FILTER_UNDEF, l_filter.update(ISO_FILTER_UNDEF)) << l_type;
+        EXPECT_EQ(30.0f, l_filter.update(30.0f)) << l_type;
+        EXPECT_TRUE(std::isnan(l_filter.update(l_nan))) << l_type;
+        EXPECT_EQ(l_inf, l_filter.update(l_inf)) << l_type;
+        EXPECT_EQ(ISO_FILTER_UNDEF, l_filter.update(ISO_FILTER_UNDEF)) << l_type;
+        temp_t l_next = l_filter.update(31.0f);
+        EXPECT_GE(l_next, 30.0f) << l_type;
+        EXPECT_LE(l_next, 31.0f) << l_type;
+
+        /// <summary>
+        /// Same in a bank, box by box
+        /// </summary>
+        IsoFilterBank l_bank(3, isoFilterDefaults(l_type));
+        temp_t l_first[3] = { ISO_FILTER_UNDEF, l_nan, 30.0f };
+        l_bank.update(l_first, l_first, 0, 3);
+        EXPECT_EQ(ISO_FILTER_UNDEF, l_first[0]) << l_type;
+        EXPECT_TRUE(std::isnan(l_first[1])) << l_type;
+        temp_t l_second[3] = { 30.0f, 30.0f, ISO_FILTER_UNDEF };
+        l_bank.update(l_second, l_second, 0, 3);
+        EXPECT_EQ(30.0f, l_second[0]) << l_type;
+        EXPECT_EQ(30.0f, l_second[1]) << l_type;
+        EXPECT_EQ(ISO_FILTER_UNDEF, l_second[2]) << l_type;
+        temp_t l_third[3] = { 30.0f, 30.0f, 30.0f };
+        l_bank.update(l_third, l_third, 0, 3);
+        for (temp_t l_value : l_third)
+            EXPECT_EQ(30.0f, l_value) << l_type;
+    }
+}
+
+TEST(testFilter, eventDrivenScheduler)
+{
+    /// <summary>
+    /// Filtered in postTemp: a single outlier of an idle box is
+    /// absorbed by the median and does not even wake the box up
+    /// </summary>
+    isoBoxScheduler l_scheduler(1, 1);
+    l_scheduler.setEventDriven(true);
+    l_scheduler.setFilter(isoFilterDefaults(ISO_FILTER_MEDIAN));
+    l_scheduler.initBox(0, 25.0, 50.0);
+    isoBoxScheduler::isoClock_t::time_point l_now = isoBoxScheduler::isoClock_t::now();
+    l_scheduler.postTemp(0, 30.0);
+    l_scheduler.postTemp(0, 30.0);
+    EXPECT_EQ(1u, l_scheduler.poll(l_now));
+    temp_t l_target = l_scheduler.getBox(0).getTargetPoint();
+
+    l_scheduler.postTemp(0, 60.0);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(0u, l_scheduler.poll(l_now));
+    EXPECT_EQ(l_target, l_scheduler.getBox(0).getTargetPoint());
+
+    /// <summary>
+    /// A lasting excursion gets through once it is the median
+    /// </summary>
+    l_scheduler.postTemp(0, 60.0);
+    l_scheduler.postTemp(0, 60.0);
+    l_now += timeProcess_t(ISO_SCAN_RATE);
+    EXPECT_EQ(1u, l_scheduler.poll(l_now));
+    EXPECT_EQ(50.0f, l_scheduler.getBox(0).getTargetPoint());
+}
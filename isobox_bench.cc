@@ -0,0 +1,454 @@
+#include <benchmark/benchmark.h>
+#include "unittest_SimpleMath/isolatedBoxCmake.h"
+#include "unittest_SimpleMath/isolatedBox_bank.h"
+#include "unittest_SimpleMath/isolatedBox_plant.h"
+#include "unittest_SimpleMath/MonitoringTemp.h"
+#include "unittest_SimpleMath/isolatedBox_telemetry.h"
+#include "unittest_SimpleMath/isolatedBox_history.h"
+#include "unittest_SimpleMath/isolatedBox_metrics.h"
+#include "unittest_SimpleMath/isolatedBox_printdebug.h"
+#include "unittest_SimpleMath/isolatedBox_profile.h"
+#include "unittest_SimpleMath/isolatedBox_tscale.h"
+#include "unittest_SimpleMath/isolatedBox_scheduler.h"
+#include "unittest_SimpleMath/isolatedBox_probefile.h"
+#include "unittest_SimpleMath/isolatedBox_filter.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace isoBoxApi;
+
+/// <summary>
+/// Micro benchmarks of the isoBox hot path.
+/// JSON output: isobox_bench --benchmark_format=json
+/// or build the isobox_bench_json target.
+/// </summary>
+
+
+static void BM_ApplyCompensation_InRange(benchmark::State &state)
+{
+    isoBox l_IsoBox;
+    l_IsoBox.init(25.0, 50.0);
+    temp_t l_temp = 37.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(l_IsoBox.applyCompensation(l_temp));
+    }
+}
+BENCHMARK(BM_ApplyCompensation_InRange);
+
+static void BM_ApplyCompensation_OutOfRange(benchmark::State &state)
+{
+    /// <summary>
+    /// Alternates both sides of the range: target switch and PID step
+    /// </summary>
+    isoBox l_IsoBox;
+    l_IsoBox.init(25.0, 50.0);
+    temp_t l_temps[2] = { 23.0, 52.0 };
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(l_IsoBox.applyCompensation(l_temps[i & 1]));
+        i++;
+    }
+}
+BENCHMARK(BM_ApplyCompensation_OutOfRange);
+
+static void BM_ApplyCompensation_Measured(benchmark::State &state)
+{
+    /// <summary>
+    /// Same sweep as BM_ApplyCompensation_OutOfRange: the difference
+    /// is the cost of the metrics
+    /// </summary>
+    IsoMetrics l_metrics(1);
+    IsoMetricsShard *l_shard = l_metrics.registerThread();
+    isoBox l_IsoBox;
+    l_IsoBox.init(25.0, 50.0);
+    temp_t l_temps[2] = { 23.0, 52.0 };
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(applyCompensationMeasured(l_IsoBox, l_temps[i & 1], 0,
+                                                           l_metrics, *l_shard));
+        i++;
+    }
+}
+BENCHMARK(BM_ApplyCompensation_Measured);
+
+static void BM_PrintDebug(benchmark::State &state)
+{
+    /// <summary>
+    /// Cost seen by the control thread: formatting and output happen
+    /// on the logger thread. Lines are discarded.
+    /// </summary>
+    ISO_printDebug &l_logger = ISO_printDebug::instance();
+    l_logger.setSink([](const char *, size_t) {});
+    int i = 0;
+    for (auto _ : state) {
+        ISO_printDebug::printDebug("box {} target {} C", i, 37.5);
+        i++;
+        if ((i & 255) == 0) {
+            state.PauseTiming();
+            l_logger.flush();
+            state.ResumeTiming();
+        }
+    }
+    l_logger.flush();
+    l_logger.setSink(IsoLogSink_t());
+}
+BENCHMARK(BM_PrintDebug);
+
+static void BM_ConfigFetch(benchmark::State &state)
+{
+    /// <summary>
+    /// Control path check of a live configuration: Arg(0) nothing
+    /// new, Arg(1) a new snapshot every step
+    /// </summary>
+    IsoBoxConfigTable l_table(1);
+    IsoBoxConfig l_config = { ISO_CONFIG_GAINS, 25.0f, 50.0f, 4.0f, 0.5f, 0.1f };
+    l_table.publish(0, l_config);
+    uint64_t l_seen = 0;
+    for (auto _ : state) {
+        if (state.range(0) != 0)
+            l_table.publish(0, l_config);
+        benchmark::DoNotOptimize(l_table.fetch(0, l_seen, l_config));
+    }
+}
+BENCHMARK(BM_ConfigFetch)->Arg(0)->Arg(1);
+
+static void BM_ConvertTemps(benchmark::State &state)
+{
+    /// <summary>
+    /// Batch conversion of a block of samples, in place
+    /// </summary>
+    std::vector<temp_t> l_temps((size_t)state.range(0), 25.0f);
+    for (auto _ : state) {
+        isoConvertTemps(l_temps.data(), l_temps.size(), CELSIUS, FARENHEIT);
+        isoConvertTemps(l_temps.data(), l_temps.size(), FARENHEIT, CELSIUS);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_ConvertTemps)->Arg(64)->Arg(4096);
+
+static void BM_ConvertTempOneByOne(benchmark::State &state)
+{
+    /// <summary>
+    /// Reference: the same samples converted one call each
+    /// </summary>
+    std::vector<temp_t> l_temps((size_t)state.range(0), 25.0f);
+    for (auto _ : state) {
+        for (temp_t &l_temp : l_temps)
+            l_temp = isoConvertTemp(isoConvertTemp(l_temp, CELSIUS, FARENHEIT), FARENHEIT, CELSIUS);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_ConvertTempOneByOne)->Arg(4096);
+
+static void BM_SchedulerTick(benchmark::State &state)
+{
+    /// <summary>
+    /// One period of 4096 boxes, 1% out of range: Arg(0) every box
+    /// on its deadline, Arg(1) the dirty set only
+    /// </summary>
+    isoBoxApi::isoBoxScheduler l_scheduler(4096, 1);
+    l_scheduler.setEventDriven(state.range(0) != 0);
+    for (size_t i = 0; i < l_scheduler.getNumBoxes(); i++) {
+        l_scheduler.initBox(i, 25.0, 50.0);
+        l_scheduler.postTemp(i, (i % 100 == 0) ? 60.0f : 40.0f);
+    }
+    isoBoxApi::isoBoxScheduler::isoClock_t::time_point l_now = isoBoxApi::isoBoxScheduler::isoClock_t::now();
+    l_scheduler.poll(l_now);
+    for (auto _ : state) {
+        l_now += timeProcess_t(ISO_SCAN_RATE);
+        benchmark::DoNotOptimize(l_scheduler.poll(l_now));
+    }
+}
+BENCHMARK(BM_SchedulerTick)->Arg(0)->Arg(1);
+
+static void BM_FileProbeRead(benchmark::State &state)
+{
+    /// <summary>
+    /// One scan of a directory of probe files, read in one range
+    /// </summary>
+    size_t l_numProbes = (size_t)state.range(0);
+    const std::string l_dir = "isobox_bench_probes";
+    IsoProbeDirectory l_directory;
+    if (!l_directory.create(l_dir, l_numProbes, 36.6f)) {
+        state.SkipWithError("cannot create the probe files");
+        l_directory.remove();
+        IsoMappedFile::removeDirectory(l_dir);
+        return;
+    }
+    FileProbeSource l_probes;
+    l_probes.open(l_directory.getPaths());
+    std::vector<temp_t> l_temps(l_numProbes);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(l_probes.read(0, l_numProbes, l_temps.data()));
+    state.SetItemsProcessed(state.iterations() * (int64_t)l_numProbes);
+    state.SetLabel(FileProbeSource::usesIoUring() ? "io_uring" : "pread");
+    l_probes.close();
+    l_directory.remove();
+    IsoMappedFile::removeDirectory(l_dir);
+}
+BENCHMARK(BM_FileProbeRead)->Arg(1024);
+
+static void BM_SampleFilter(benchmark::State &state)
+{
+    /// <summary>
+    /// One stream, one sample per call. Arg: IsoFilterType_E
+    /// </summary>
+    IsoSampleFilter l_filter;
+    l_filter.setParams(isoFilterDefaults((IsoFilterType_E)state.range(0)));
+    temp_t l_temp = 20.0f;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(l_filter.update(l_temp));
+        l_temp = (l_temp < 30.0f) ? l_temp + 0.37f : 20.0f;
+    }
+}
+BENCHMARK(BM_SampleFilter)->DenseRange(ISO_FILTER_NONE, ISO_FILTER_KALMAN);
+
+static void BM_FilterBank(benchmark::State &state)
+{
+    /// <summary>
+    /// 4096 boxes filtered in place in one batch. Arg: IsoFilterType_E
+    /// </summary>
+    const size_t l_numBoxes = 4096;
+    IsoFilterBank l_bank(l_numBoxes, isoFilterDefaults((IsoFilterType_E)state.range(0)));
+    std::vector<temp_t> l_temps(l_numBoxes);
+    for (size_t i = 0; i < l_numBoxes; i++)
+        l_temps[i] = 20.0f + (temp_t)(i % 17);
+    for (auto _ : state) {
+        l_bank.update(l_temps.data(), l_temps.data(), 0, l_numBoxes);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)l_numBoxes);
+}
+BENCHMARK(BM_FilterBank)->DenseRange(ISO_FILTER_NONE, ISO_FILTER_KALMAN);
+
+static void BM_PidProcess(benchmark::State &state)
+{
+    PidController l_pid;
+    l_pid.setPoints(25.0, 50.0);
+    temp_t l_temp = 20.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(l_pid.Process(l_temp));
+        l_temp = (l_temp < 30.0f) ? l_temp + 0.01f : 20.0f;
+    }
+}
+BENCHMARK(BM_PidProcess);
+
+static void BM_ParameterLimitsValidate(benchmark::State &state)
+{
+    ParameterLimits l_limits(ISO_TEMP_MIN_SP, ISO_TEMP_MAX_SP, ISO_TEMP_SP_DEFAULT);
+    temp_t l_temp = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(l_limits.validate(l_temp));
+        l_temp = (l_temp < 120.0f) ? l_temp + 0.5f : 0.0f;
+    }
+}
+BENCHMARK(BM_ParameterLimitsValidate);
+
+static void BM_StaticParameterLimitsValidate(benchmark::State &state)
+{
+    temp_t l_temp = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(IsoPhysicalTempLimits::validate(l_temp));
+        l_temp = (l_temp < 120.0f) ? l_temp + 0.5f : 0.0f;
+    }
+}
+BENCHMARK(BM_StaticParameterLimitsValidate);
+
+static void BM_BoxBank(benchmark::State &state)
+{
+    size_t l_numBoxes = (size_t)state.range(0);
+    BoxBank l_bank(l_numBoxes);
+    std::vector<temp_t> l_temps(l_numBoxes);
+    std::vector<temp_t> l_targets(l_numBoxes);
+    for (size_t i = 0; i < l_numBoxes; i++) {
+        l_bank.init(i, 25.0, 50.0);
+        l_temps[i] = 15.0f + (temp_t)(i % 50);
+    }
+    for (auto _ : state) {
+        l_bank.applyCompensation(l_temps.data(), l_targets.data(), l_numBoxes);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)l_numBoxes);
+}
+BENCHMARK(BM_BoxBank)->Arg(1024)->Arg(65536);
+
+/// <summary>
+/// Every thread pushes then pops on the same queue
+/// </summary>
+template<class Q>
+static void BM_QueuePushPop(benchmark::State &state)
+{
+    /// <summary>
+    /// Static storage: RingQueue has over-aligned members that plain
+    /// new does not honour before C++17. Each run leaves it empty.
+    /// </summary>
+    static Q s_queue;
+
+    MonitoringTemp l_sample = makeMonitoringTemp(0, (uint32_t)state.thread_index(), 37.0f, CELSIUS);
+    for (auto _ : state) {
+        s_queue.push(l_sample);
+        benchmark::DoNotOptimize(s_queue.pop());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_QueuePushPop, SharedQueue<MonitoringTemp>)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_QueuePushPop, MpscRingQueue<MonitoringTemp, 1024>)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_SharedQueueDrain(benchmark::State &state)
+{
+    size_t l_batch = (size_t)state.range(0);
+    SharedQueue<MonitoringTemp> l_queue;
+    std::vector<MonitoringTemp> l_in(l_batch, makeMonitoringTemp(0, 1, 37.0f, CELSIUS));
+    std::vector<MonitoringTemp> l_out;
+    l_out.reserve(l_batch);
+    for (auto _ : state) {
+        l_queue.push_range(l_in.begin(), l_in.end());
+        l_out.clear();
+        benchmark::DoNotOptimize(l_queue.drain_into(l_out, l_batch));
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)l_batch);
+}
+BENCHMARK(BM_SharedQueueDrain)->Arg(1)->Arg(64);
+
+static void BM_MonitoringTempFormat(benchmark::State &state)
+{
+    MonitoringTemp l_sample = makeMonitoringTemp(1684000000123456789LL, 7, 36.5f, CELSIUS);
+    char l_text[64];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(format(l_sample, l_text, sizeof(l_text)));
+    }
+}
+BENCHMARK(BM_MonitoringTempFormat);
+
+/// <summary>
+/// Closed loop on the simulated plant: CPU cost per box step,
+/// settling time reported as counters
+/// </summary>
+static void BM_PlantSimulation(benchmark::State &state)
+{
+    size_t l_numBoxes = (size_t)state.range(0);
+    ThermalPlantParams l_params = { 15.0f, 15.0f, 600.0f, 0.2f, 0.05f, 1 };
+    PlantSimulationResult l_result = {};
+    for (auto _ : state) {
+        PlantSimulation l_sim(l_numBoxes, l_params, 25.0f, 30.0f);
+        l_result = l_sim.run(std::chrono::minutes(10));
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)l_result.steps);
+    state.counters["settled_boxes"] = (double)l_result.settledBoxes;
+    state.counters["mean_settling_s"] = l_result.meanSettlingSeconds;
+    state.counters["max_settling_s"] = l_result.maxSettlingSeconds;
+    state.counters["speedup"] = l_result.simulatedSeconds / l_result.wallSeconds;
+}
+BENCHMARK(BM_PlantSimulation)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+/// <summary>
+/// Telemetry log append: memory copy only, a segment
+/// rotation (file creation) every 64k records
+/// </summary>
+static void BM_TelemetryAppend(benchmark::State &state)
+{
+    const std::string l_dir = "isobox_bench_telemetry";
+    TelemetryWriter l_writer;
+    if (!l_writer.open(l_dir, 1 << 16, 4)) {
+        state.SkipWithError("can not open the telemetry directory");
+        return;
+    }
+    uint32_t l_id = l_writer.intern("bench_probe");
+    int64_t l_ts = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(l_writer.appendTemp(l_ts++, l_id, 37.0f));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * (int64_t)sizeof(TelemetryRecord));
+
+    l_writer.close();
+    for (const std::string &l_name : IsoMappedFile::listFiles(l_dir, "telemetry", ""))
+        IsoMappedFile::remove(l_dir + "/" + l_name);
+    IsoMappedFile::removeDirectory(l_dir);
+}
+BENCHMARK(BM_TelemetryAppend);
+
+/// <summary>
+/// History codec on a slow drifting, 0.01 degree resolution series
+/// </summary>
+static void historySeries(std::vector<int64_t> &_ts, std::vector<temp_t> &_values)
+{
+    for (size_t i = 0; i < _ts.size(); i++) {
+        _ts[i] = 1684000000000LL + (int64_t)i * ISO_SCAN_RATE;
+        _values[i] = std::round((30.0f + (temp_t)i * 0.0002f) * 100.0f) / 100.0f;
+    }
+}
+
+static void BM_HistoryEncode(benchmark::State &state)
+{
+    std::vector<int64_t> l_ts(ISO_HISTORY_CHUNK_SAMPLES);
+    std::vector<temp_t> l_values(ISO_HISTORY_CHUNK_SAMPLES);
+    historySeries(l_ts, l_values);
+    HistoryEncoder l_encoder;
+    std::vector<uint8_t> l_chunk;
+    for (auto _ : state) {
+        for (size_t i = 0; i < l_ts.size(); i++)
+            l_encoder.append(l_ts[i], l_values[i]);
+        l_chunk.clear();
+        benchmark::DoNotOptimize(l_encoder.finish(l_chunk));
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)l_ts.size());
+    state.counters["ratio"] = (double)(l_ts.size() * 12) / (double)l_chunk.size();
+}
+BENCHMARK(BM_HistoryEncode);
+
+static void BM_HistoryDecode(benchmark::State &state)
+{
+    std::vector<int64_t> l_ts(ISO_HISTORY_CHUNK_SAMPLES);
+    std::vector<temp_t> l_values(ISO_HISTORY_CHUNK_SAMPLES);
+    historySeries(l_ts, l_values);
+    HistoryEncoder l_encoder;
+    for (size_t i = 0; i < l_ts.size(); i++)
+        l_encoder.append(l_ts[i], l_values[i]);
+    std::vector<uint8_t> l_chunk;
+    l_encoder.finish(l_chunk);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(HistoryDecoder::decode(l_chunk.data(), l_chunk.size(),
+                                                        l_ts.data(), l_values.data()));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)l_ts.size());
+}
+BENCHMARK(BM_HistoryDecode);
+
+/// <summary>
+/// Restart of a pool: map the profile file and tune every box
+/// </summary>
+static void BM_ProfileLoad(benchmark::State &state)
+{
+    const size_t l_numBoxes = (size_t)state.range(0);
+    std::vector<IsoProfileEntry> l_entries(l_numBoxes);
+    for (size_t i = 0; i < l_numBoxes; i++) {
+        l_entries[i].box = (uint32_t)i;
+        l_entries[i].name = "box_" + std::to_string(i);
+        l_entries[i].description = "bench profile";
+        l_entries[i].kP = 2.0f + (float)(i % 10);
+        l_entries[i].kI = 0.5f;
+        l_entries[i].kD = 0.1f;
+        l_entries[i].volume = 1.0f;
+    }
+    const std::string l_path = "isobox_bench_profiles.bin";
+    IsoProfileStore::write(l_path, l_entries);
+
+    std::vector<isoBox> l_boxes(l_numBoxes);
+    for (auto _ : state) {
+        IsoProfileStore l_store;
+        l_store.open(l_path);
+        benchmark::DoNotOptimize(l_store.applyTo(l_boxes.size(),
+                                                 [&](size_t _box) -> isoBox & { return l_boxes[_box]; }));
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)l_numBoxes);
+    IsoMappedFile::remove(l_path);
+}
+BENCHMARK(BM_ProfileLoad)->Arg(65536)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -2,31 +2,134 @@
 #define MONITORINGTEMP_H
 
 #include "SharedQueue.h"
+#include "RingQueue.h"
+#include "isolatedBox_common.h"
+#include "isolatedBox_idregistry.h"
 
-#include <sstream>
-#include <vector>
-#include <list>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
 
-typedef std::pair<std::string, std::string> MonitoringTemp;
+/// <summary>
+/// Box index of a sample not routed to a box
+/// </summary>
+constexpr uint32_t ISO_MONITORING_NO_BOX = 0xFFFFFFFFu;
 
-template<typename T>
-inline void insert(MonitoringTemp &o, const T &value, const std::string &unitOfMeasure)
+/// <summary>
+/// One monitoring sample as it travels on the queue.
+/// Plain binary record: no heap, no formatting until the sink.
+/// </summary>
+struct MonitoringTemp
 {
-    std::ostringstream oss;
+    int64_t ts;         // Time stamp, nanoseconds since epoch, 0 if not stamped
+    isoId_t id;         // Probe / box name, IsoIdRegistry handle
+    temp_t value;       // Measured value expressed in unit
+    TScale_E unit;
+    uint32_t box;       // Index of the box in its pipeline / recorder
+};
 
-    oss << value;
-    o.push_front(std::pair<std::string, std::string>(oss.str(), unitOfMeasure));
+static_assert(std::is_trivially_copyable<MonitoringTemp>::value,
+              "MonitoringTemp must stay trivially copyable");
+static_assert(sizeof(MonitoringTemp) == 24, "MonitoringTemp must stay 24 bytes");
+
+/**
+ * @brief Current time stamp for a MonitoringTemp record: the steady
+ * clock, moved once per process onto the wall clock epoch. The sinks
+ * read it as wall time, the queue dwell and the per-box ordering
+ * are not moved by a wall clock step (NTP) made after the start.
+ * @return nanoseconds since epoch
+ */
+inline int64_t monitoringNow()
+{
+    static const int64_t s_epochOffset =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() -
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count() + s_epochOffset;
+}
+
+/**
+ * @brief Time stamp of a sample in milliseconds, as the sinks write it
+ */
+inline int64_t monitoringMs(const MonitoringTemp &o)
+{
+    return o.ts / 1000000;
+}
+
+inline MonitoringTemp makeMonitoringTemp(int64_t ts, isoId_t id, const temp_t value,
+                                         const TScale_E unitOfMeasure,
+                                         uint32_t box = ISO_MONITORING_NO_BOX)
+{
+    MonitoringTemp l_sample = { ts, id, value, unitOfMeasure, box };
+    return l_sample;
+}
+
+inline void insert(MonitoringTemp &o, const temp_t value, const TScale_E unitOfMeasure)
+{
+    o.value = value;
+    o.unit = unitOfMeasure;
+}
+
+/**
+ * @brief Symbol of a temperature scale
+ */
+inline const char *unitSymbol(const TScale_E unitOfMeasure)
+{
+    switch (unitOfMeasure) {
+    case CELSIUS:
+        return "C";
+    case FARENHEIT:
+        return "F";
+    case KELVIN:
+        return "K";
+    default:
+        return "?";
+    }
+}
+
+/**
+ * @brief Text form of a sample. To be used only at the sink.
+ * @param o - the sample
+ * @param buffer - destination, always null terminated
+ * @param length - size of buffer
+ * @return number of characters written (snprintf semantics)
+ */
+inline int format(const MonitoringTemp &o, char *buffer, size_t length)
+{
+    return snprintf(buffer, length, "%lld %u %.2f %s",
+                    (long long)monitoringMs(o), (unsigned)o.id, (double)o.value, unitSymbol(o.unit));
 }
 
-template<>
-inline void insert(MonitoringTemp &o, const std::string &value, const std::string &unitOfMeasure)
+/**
+ * @brief Same as format with the registered name of the probe
+ * instead of its handle, if any
+ */
+inline int formatNamed(const MonitoringTemp &o, char *buffer, size_t length)
 {
-    o.first = value;
-    o.second = unitOfMeasure;
-//     o.push(std::pair<std::string, std::string>(value, unitOfMeasure));
+    const std::string &l_name = IsoIdRegistry::instance().getName(o.id);
+    if (l_name.empty())
+        return format(o, buffer, length);
+    return snprintf(buffer, length, "%lld %s %.2f %s",
+                    (long long)monitoringMs(o), l_name.c_str(), (double)o.value, unitSymbol(o.unit));
 }
 
 
+/// <summary>
+/// Define ISO_MONITORING_RING_QUEUE to move the monitoring path on the
+/// lock-free ring. Producers and consumers use the same push/pop calls.
+/// A full ring refuses the new samples: push_range tells the producer
+/// how many were queued, the next scan brings newer ones.
+/// </summary>
+#ifdef ISO_MONITORING_RING_QUEUE
+#ifndef ISO_MONITORING_QUEUE_DEPTH
+#define ISO_MONITORING_QUEUE_DEPTH 4096
+#endif
+typedef MpscRingQueue<MonitoringTemp, ISO_MONITORING_QUEUE_DEPTH, RING_DROP_NEWEST> MonitoringDataQueue;
+#else
 typedef SharedQueue<MonitoringTemp> MonitoringDataQueue;
+#endif
 
 #endif // MONITORINGTEMP_H
@@ -0,0 +1,324 @@
+#ifndef RINGQUEUE_H
+#define RINGQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Policy applied by RingQueue::push when the ring is full
+/// </summary>
+enum RingOverflow_E
+{
+    RING_DROP_OLDEST,   // Discard the oldest queued element to make room
+    RING_DROP_NEWEST,   // Discard the element being pushed
+    RING_BLOCK          // Wait until a consumer frees a slot
+};
+
+/// <summary>
+/// Number of threads allowed to push concurrently
+/// </summary>
+enum RingProducer_E
+{
+    RING_SINGLE_PRODUCER,
+    RING_MULTI_PRODUCER
+};
+
+/// <summary>
+/// Spin, then yield, then sleep. Used by the blocking calls of RingQueue
+/// so an idle consumer does not burn a whole core.
+/// </summary>
+class RingBackoff
+{
+public:
+    RingBackoff() : m_count(0) {}
+
+    void pause()
+    {
+        if (m_count < 64) {
+            ++m_count;
+        }
+        else if (m_count < 128) {
+            ++m_count;
+            std::this_thread::yield();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+private:
+    uint32_t m_count;
+};
+
+/// <summary>
+/// Bounded lock-free Queue Class
+/// Fixed capacity ring with a sequence number per slot, same push/pop
+/// surface as SharedQueue. Consumers always claim slots with a CAS
+/// so RING_DROP_OLDEST can discard from the producer side.
+/// </summary>
+/// <typeparam name="T">Default constructible, move assignable</typeparam>
+/// <typeparam name="Capacity">Number of slots, power of two</typeparam>
+
+template<class T, size_t Capacity,
+         RingProducer_E Producers = RING_MULTI_PRODUCER,
+         RingOverflow_E Overflow = RING_DROP_OLDEST>
+class RingQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "RingQueue capacity must be a power of two");
+
+public:
+
+    RingQueue() : m_head(0), m_tail(0), m_dropped(0), m_slots(new Slot[Capacity])
+    {
+        for (size_t i = 0; i < Capacity; ++i) {
+            m_slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    /**
+     * @brief Push one element applying the Overflow policy
+     * @return false if the element was dropped (RING_DROP_NEWEST)
+     */
+    bool push(const T &elem)
+    {
+        return pushElem(elem);
+    }
+
+    bool push(T &&elem)
+    {
+        return pushElem(std::move(elem));
+    }
+
+    template<class... Args>
+    bool emplace(Args&&... args)
+    {
+        return pushElem(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Push a batch, each element applying the Overflow policy
+     * @return number of elements queued
+     */
+    template<class InputIt>
+    size_t push_range(InputIt first, InputIt last)
+    {
+        size_t l_count = 0;
+        for (; first != last; ++first)
+            if (pushElem(*first))
+                ++l_count;
+        return l_count;
+    }
+
+    /**
+     * @brief Wait until an element is available and return it
+     */
+    T pop()
+    {
+        T elem;
+        RingBackoff l_backoff;
+        while (!try_pop(elem)) {
+            l_backoff.pause();
+        }
+        return elem;
+    }
+
+    /**
+     * @brief Pop one element if any
+     * @return false if the queue is empty
+     */
+    bool try_pop(T &elem)
+    {
+        size_t l_pos = m_head.load(std::memory_order_relaxed);
+        Slot *l_slot;
+        for (;;) {
+            l_slot = &m_slots[l_pos & (Capacity - 1)];
+            size_t l_seq = l_slot->seq.load(std::memory_order_acquire);
+            intptr_t l_diff = (intptr_t)l_seq - (intptr_t)(l_pos + 1);
+            if (l_diff == 0) {
+                if (m_head.compare_exchange_weak(l_pos, l_pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (l_diff < 0) {
+                return false;
+            }
+            else {
+                l_pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+        elem = std::move(l_slot->value);
+        l_slot->seq.store(l_pos + Capacity, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Wait at most timeout for an element
+     * @return false on timeout
+     */
+    template<class Rep, class Period>
+    bool pop_for(T &elem, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        if (try_pop(elem))
+            return true;
+
+        auto l_deadline = std::chrono::steady_clock::now() + timeout;
+        RingBackoff l_backoff;
+        do {
+            l_backoff.pause();
+            if (try_pop(elem))
+                return true;
+        } while (std::chrono::steady_clock::now() < l_deadline);
+
+        return false;
+    }
+
+    /**
+     * @brief Move up to max elements at the end of out. Does not wait.
+     * @return number of elements moved
+     */
+    size_t drain_into(std::vector<T> &out, size_t max)
+    {
+        size_t l_count = 0;
+        T l_elem;
+        while (l_count < max && try_pop(l_elem)) {
+            out.push_back(std::move(l_elem));
+            ++l_count;
+        }
+        return l_count;
+    }
+
+    /**
+     * @brief Approximate number of queued elements
+     */
+    int size() const
+    {
+        size_t l_tail = m_tail.load(std::memory_order_acquire);
+        size_t l_head = m_head.load(std::memory_order_acquire);
+        intptr_t l_size = (intptr_t)(l_tail - l_head);
+        if (l_size < 0)
+            return 0;
+        if (l_size > (intptr_t)Capacity)
+            return (int)Capacity;
+        return (int)l_size;
+    }
+
+    void clear()
+    {
+        T l_elem;
+        while (try_pop(l_elem)) {
+        }
+    }
+
+    /**
+     * @brief Number of elements discarded by the Overflow policy
+     */
+    uint64_t dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    template<class U>
+    bool pushElem(U &&elem)
+    {
+        RingBackoff l_backoff;
+        while (!tryEnqueue(std::forward<U>(elem))) {
+            /// <summary>
+            /// The tail slot can still be held by a consumer moving its
+            /// element out: the ring is not full, wait for the release
+            /// instead of applying the policy.
+            /// </summary>
+            if (size() < (int)Capacity) {
+                l_backoff.pause();
+                continue;
+            }
+            switch (Overflow) {
+            case RING_DROP_NEWEST:
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            case RING_DROP_OLDEST: {
+                T l_oldest;
+                if (try_pop(l_oldest))
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            case RING_BLOCK:
+            default:
+                l_backoff.pause();
+                break;
+            }
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// The element is only moved from once a slot has been claimed
+    /// </summary>
+    template<class U>
+    bool tryEnqueue(U &&elem)
+    {
+        size_t l_pos = m_tail.load(std::memory_order_relaxed);
+        Slot *l_slot;
+        for (;;) {
+            l_slot = &m_slots[l_pos & (Capacity - 1)];
+            size_t l_seq = l_slot->seq.load(std::memory_order_acquire);
+            intptr_t l_diff = (intptr_t)l_seq - (intptr_t)l_pos;
+            if (l_diff == 0) {
+                if (Producers == RING_SINGLE_PRODUCER) {
+                    m_tail.store(l_pos + 1, std::memory_order_relaxed);
+                    break;
+                }
+                if (m_tail.compare_exchange_weak(l_pos, l_pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (l_diff < 0) {
+                return false;
+            }
+            else {
+                l_pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        l_slot->value = std::forward<U>(elem);
+        l_slot->seq.store(l_pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// <summary>
+    /// Producer and consumer indexes live on separate cache lines
+    /// </summary>
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+    alignas(64) std::atomic<uint64_t> m_dropped;
+    std::unique_ptr<Slot[]> m_slots;
+};
+
+/// <summary>
+/// Single producer variant
+/// </summary>
+template<class T, size_t Capacity, RingOverflow_E Overflow = RING_DROP_OLDEST>
+using SpscRingQueue = RingQueue<T, Capacity, RING_SINGLE_PRODUCER, Overflow>;
+
+/// <summary>
+/// Multi producer variant
+/// </summary>
+template<class T, size_t Capacity, RingOverflow_E Overflow = RING_DROP_OLDEST>
+using MpscRingQueue = RingQueue<T, Capacity, RING_MULTI_PRODUCER, Overflow>;
+
+#endif // RINGQUEUE_H
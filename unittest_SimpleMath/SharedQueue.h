@@ -1,9 +1,14 @@
 #ifndef SHAREDQUEUE_H
 #define SHAREDQUEUE_H
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
+#include <utility>
+#include <vector>
+
+#include "isolatedBox_trace.h"
 
 /// <summary>
 /// Basic Queue Class
@@ -18,6 +23,8 @@ public:
 
     void push(const T &elem)
     {
+        ISO_TRACE_SCOPE("SharedQueue::push");
+
         std::unique_lock<std::mutex> locker(m_mutex);
 
         m_queue.push(elem);
@@ -25,8 +32,60 @@ public:
         m_cond.notify_one();
     }
 
+    void push(T &&elem)
+    {
+        ISO_TRACE_SCOPE("SharedQueue::push");
+
+        std::unique_lock<std::mutex> locker(m_mutex);
+
+        m_queue.push(std::move(elem));
+
+        m_cond.notify_one();
+    }
+
+    template<class... Args>
+    void emplace(Args&&... args)
+    {
+        ISO_TRACE_SCOPE("SharedQueue::emplace");
+
+        std::unique_lock<std::mutex> locker(m_mutex);
+
+        m_queue.emplace(std::forward<Args>(args)...);
+
+        m_cond.notify_one();
+    }
+
+    /// <summary>
+    /// Push a whole batch under one lock acquisition.
+    /// Elements are moved when the iterators allow it.
+    /// Returns the number of elements queued, always the whole
+    /// batch: same contract as RingQueue::push_range.
+    /// </summary>
+    template<class InputIt>
+    size_t push_range(InputIt first, InputIt last)
+    {
+        ISO_TRACE_SCOPE("SharedQueue::push_range");
+
+        size_t l_count = 0;
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+
+            for (; first != last; ++first, ++l_count)
+                m_queue.push(*first);
+        }
+
+        if (l_count == 1)
+            m_cond.notify_one();
+        else if (l_count > 1)
+            m_cond.notify_all();
+
+        return l_count;
+    }
+
     T pop()
     {
+        ISO_TRACE_SCOPE("SharedQueue::pop");
+
         std::unique_lock<std::mutex> locker(m_mutex);
 
         m_cond.wait(locker, [&]()
@@ -34,12 +93,73 @@ public:
             return !m_queue.empty();
         });
 
-        auto elem = m_queue.front();
+        auto elem = std::move(m_queue.front());
         m_queue.pop();
 
         return elem;
     }
 
+    /// <summary>
+    /// Non blocking pop. Returns false if the queue is empty.
+    /// </summary>
+    bool try_pop(T &elem)
+    {
+        ISO_TRACE_SCOPE("SharedQueue::try_pop");
+
+        std::unique_lock<std::mutex> locker(m_mutex);
+
+        if (m_queue.empty())
+            return false;
+
+        elem = std::move(m_queue.front());
+        m_queue.pop();
+
+        return true;
+    }
+
+    /// <summary>
+    /// Blocking pop with a deadline. Returns false on timeout so
+    /// consumer threads can check their stop condition.
+    /// </summary>
+    template<class Rep, class Period>
+    bool pop_for(T &elem, const std::chrono::duration<Rep, Period> &timeout)
+    {
+        ISO_TRACE_SCOPE("SharedQueue::pop_for");
+
+        std::unique_lock<std::mutex> locker(m_mutex);
+
+        if (!m_cond.wait_for(locker, timeout, [&]()
+        {
+            return !m_queue.empty();
+        }))
+            return false;
+
+        elem = std::move(m_queue.front());
+        m_queue.pop();
+
+        return true;
+    }
+
+    /// <summary>
+    /// Move up to max elements at the end of out under one lock
+    /// acquisition. Does not wait. Returns the number of elements moved.
+    /// </summary>
+    size_t drain_into(std::vector<T> &out, size_t max)
+    {
+        ISO_TRACE_SCOPE("SharedQueue::drain_into");
+
+        std::unique_lock<std::mutex> locker(m_mutex);
+
+        size_t l_count = 0;
+        while (l_count < max && !m_queue.empty()) {
+            out.push_back(std::move(m_queue.front()));
+            m_queue.pop();
+            ++l_count;
+        }
+
+        return l_count;
+    }
+
     
     int size() const
     {
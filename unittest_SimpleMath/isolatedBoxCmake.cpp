@@ -8,6 +8,9 @@
 ***********************************************************************/
 
 #include "isolatedBoxCmake.h"
+#include "isolatedBox_tscale.h"
+
+#include <cmath>
 
 using namespace isoBoxApi;
 
@@ -19,6 +22,33 @@ isoBox::isoBox()
     /// </summary>
     m_Box_temp = ISO_DEF_UNDEF_TEMP;
     m_initDone = false;
+    m_filterOn = false;
+    m_compensating = false;
+    m_hysteresis = 0;
+    m_deadband = 0;
+    m_minDwell = timeProcess_t(0);
+    m_switched = false;
+    m_switchesAvoided = 0;
+    m_restartsAvoided = 0;
+}
+
+void isoBox::setHysteresis(temp_t _hysteresis, temp_t _deadband, timeProcess_t _minDwell)
+{
+    m_hysteresis = (_hysteresis > 0) ? _hysteresis : 0;
+    m_deadband = (_deadband > 0) ? _deadband : 0;
+    m_minDwell = (_minDwell.count() > 0) ? _minDwell : timeProcess_t(0);
+    m_switched = false;
+    m_filterOn = (m_hysteresis > 0) || (m_deadband > 0) || (m_minDwell.count() > 0);
+}
+
+bool isoBox::setScale(TScale_E _scale)
+{
+    TScale_E lFrom = m_pidActuator.getScale();
+    if (!m_pidActuator.setScale(_scale))
+        return false;
+    m_hysteresis = isoConvertDelta(m_hysteresis, lFrom, _scale);
+    m_deadband = isoConvertDelta(m_deadband, lFrom, _scale);
+    return true;
 }
 
 bool isoBox::init(temp_t _min, temp_t _max)
@@ -35,19 +65,43 @@ bool isoBox::init(temp_t _min, temp_t _max)
         /// <returns></returns>
         l_retVal = m_pidActuator.setPoints(_min, _max);   // init();
         m_initDone = l_retVal;
+        m_compensating = false;
+        m_switched = false;
         return l_retVal;
     }
     else
         return l_retVal;
 }
 
+bool isoBox::applyConfig(const IsoBoxConfig &_config)
+{
+    bool lRetVal = true;
+    const PidController &lPid = m_pidActuator;
+    if ((_config.fields & ISO_CONFIG_GAINS) &&
+        (_config.kP != lPid.getKp() || _config.kI != lPid.getKi() || _config.kD != lPid.getKd()))
+        setGains(_config.kP, _config.kI, _config.kD);
+    if ((_config.fields & ISO_CONFIG_SET_POINTS) &&
+        (!m_initDone || _config.min != getSetPoint(PID_MIN_SET_POINT) ||
+         _config.max != getSetPoint(PID_MAX_SET_POINT))) {
+        /// <summary>
+        /// Validated before init: a refused init would leave the box
+        /// with unavailable set points, no longer compensating
+        /// </summary>
+        if (_config.max > _config.min &&
+            m_pidActuator.testSetPoint(_config.min) == _config.min &&
+            m_pidActuator.testSetPoint(_config.max) == _config.max)
+            lRetVal = init(_config.min, _config.max);
+        else
+            lRetVal = false;
+    }
+    return lRetVal;
+}
+
 PID_SET_POINTS_t isoBoxApi::isoBox::getDistancePoint(temp_t _temp)
 {
     PID_SET_POINTS_t lretVal = PID_MAX_NUM_POINTS;
-    int lFirst = _temp - getSetPoint(PID_MIN_SET_POINT);
-    int lSecond = _temp - getSetPoint(PID_MAX_SET_POINT);
-    uint32_t labsFirst = abs(lFirst);
-    uint32_t labsSecond = abs(lSecond);
+    uint32_t labsFirst = abs(isoSetPointDistance(_temp, getSetPoint(PID_MIN_SET_POINT)));
+    uint32_t labsSecond = abs(isoSetPointDistance(_temp, getSetPoint(PID_MAX_SET_POINT)));
     
     if (labsFirst < labsSecond) {
         // We choose the first
@@ -66,21 +120,76 @@ PID_SET_POINTS_t isoBoxApi::isoBox::getDistancePoint(temp_t _temp)
     return lretVal;
 }
 
+PID_SET_POINTS_t isoBoxApi::isoBox::getFilteredPoint(temp_t _temp, isoClock_t::time_point _now)
+{
+    temp_t lToMin = std::fabs(_temp - getSetPoint(PID_MIN_SET_POINT));
+    temp_t lToMax = std::fabs(_temp - getSetPoint(PID_MAX_SET_POINT));
+    PID_SET_POINTS_t lNearest = PID_MAX_NUM_POINTS;
+    if (lToMin < lToMax)
+        lNearest = PID_MIN_SET_POINT;
+    else if (lToMin > lToMax)
+        lNearest = PID_MAX_SET_POINT;
+    if (lNearest == PID_MAX_NUM_POINTS || getSetPoint(lNearest) == getTargetPoint())
+        return lNearest;
+
+    /// <summary>
+    /// A switch: the sample must be past the new target by more than
+    /// the hysteresis, and the current one must have been kept long enough
+    /// </summary>
+    temp_t lBeyond = (lNearest == PID_MIN_SET_POINT) ? getSetPoint(PID_MIN_SET_POINT) - _temp :
+                                                       _temp - getSetPoint(PID_MAX_SET_POINT);
+    if (lBeyond <= m_hysteresis || (m_switched && _now - m_lastSwitch < m_minDwell)) {
+        m_switchesAvoided++;
+        return PID_MAX_NUM_POINTS;
+    }
+    return lNearest;
+}
+
 temp_t isoBoxApi::isoBox::applyCompensation(temp_t _temp)
+{
+    /// <summary>
+    /// The clock is read only when a dwell time is set
+    /// </summary>
+    return applyCompensation(_temp, (m_minDwell.count() > 0) ? isoClock_t::now() : isoClock_t::time_point());
+}
+
+temp_t isoBoxApi::isoBox::applyCompensation(temp_t _temp, isoClock_t::time_point _now)
 {   
+    ISO_TRACE_SCOPE("isoBox::applyCompensation");
     /// If it is out of range we should apply compensentaion
     
     temp_t lRetVal = ISO_DEF_UNDEF_TEMP;
     /// <summary>
     /// Here cames the measured temperature
-    /// First we set the m_Box_temp to store the measured value
+    /// First we set the m_Box_temp to store the measured value,
+    /// filtered if a filter is set
     /// </summary>
     /// <param name="_temp"></param>
     /// <returns></returns>
+    if (m_filter.isEnabled())
+        _temp = m_filter.update(_temp);
     m_Box_temp = _temp;
 
+    /// <summary>
+    /// A non-finite sample is not a measurement: nothing to compensate,
+    /// the target and the PID state are kept
+    /// </summary>
+    if (!std::isfinite(_temp))
+        return ISO_DEF_UNDEF_TEMP;
+
     if (m_initDone == true) {
-        if (_temp == m_pidActuator.testCurrentTemp(_temp)) {
+        bool lInRange = (_temp == m_pidActuator.testCurrentTemp(_temp));
+        if (!lInRange && m_filterOn && !m_compensating &&
+            _temp >= getSetPoint(PID_MIN_SET_POINT) - m_deadband &&
+            _temp <= getSetPoint(PID_MAX_SET_POINT) + m_deadband) {
+            /// <summary>
+            /// Idle box just outside its set points: held by the deadband
+            /// </summary>
+            m_restartsAvoided++;
+            lInRange = true;
+        }
+
+        if (lInRange) {
             /// <summary>
             /// We do not apply compensation because the temperature 
             /// is in the range
@@ -88,6 +197,7 @@ temp_t isoBoxApi::isoBox::applyCompensation(temp_t _temp)
             /// <param name="_temp"></param>
             /// <returns></returns>
             lRetVal = ISO_DEF_UNDEF_TEMP;
+            m_compensating = false;
         }
         else {
             /// <summary>
@@ -97,15 +207,20 @@ temp_t isoBoxApi::isoBox::applyCompensation(temp_t _temp)
             /// </summary>
             /// <param name="_temp"></param>
             /// <returns></returns>
-            PID_SET_POINTS_t lpointToSet = getDistancePoint(_temp);
+            PID_SET_POINTS_t lpointToSet = m_filterOn ? getFilteredPoint(_temp, _now) : getDistancePoint(_temp);
             if (lpointToSet != PID_MAX_NUM_POINTS) {
                 /// <summary>
                 /// Set a new target point
                 /// </summary>
                 /// <param name="_temp"></param>
                 /// <returns></returns>
+                if (getSetPoint(lpointToSet) != m_pidActuator.m_targetSetPoint) {
+                    m_lastSwitch = _now;
+                    m_switched = true;
+                }
                 m_pidActuator.setTargetPoint(lpointToSet);                
             }
+            m_compensating = true;
             lRetVal = m_pidActuator.m_targetSetPoint;
             m_pidActuator.Process(m_Box_temp);
             
@@ -9,18 +9,17 @@
 #ifndef  _ISO_BOX_CMAKE_H
 #define  _ISO_BOX_CMAKE_H
 
-#include <iostream>
 #include "isolatedBox_PID.h"  // include class to manage actuation
+#include "isolatedBox_config.h"
+#include "isolatedBox_filter.h"
 
-constexpr auto ISO_DEF_UNDEF_TEMP = 65535;
 constexpr auto ISO_DEF_TRSH__CMP_TEMP = 0.1;
 
-using namespace std;
-
 namespace isoBoxApi {
 
 class isoBox {
 public:
+    typedef std::chrono::steady_clock isoClock_t;
 
     /**
     * @brief Constructor: Member initialization
@@ -68,6 +67,103 @@ public:
     */
     temp_t getTargetPoint() { return m_pidActuator.m_targetSetPoint; }
 
+    /**
+    * @brief Last sample given to applyCompensation, filtered
+    * @return temp_t, ISO_DEF_UNDEF_TEMP before the first one
+    */
+    temp_t getBoxTemp() const { return m_Box_temp; }
+
+    /**
+    * @brief The PWM actuator driven by the box PID controller
+    * @return const reference to the actuator
+    */
+    const IsoActuator &getActuator() const { return m_pidActuator.getActuator(); }
+
+    /**
+    * @brief The PID controller of the box
+    * @return const reference to the controller
+    */
+    const PidController &getController() const { return m_pidActuator; }
+
+    /**
+    * @brief Tuning of the box PID controller (LOAD_PROFILE)
+    */
+    void setGains(temp_t _kp, temp_t _ki, temp_t _kd) { m_pidActuator.setGains(_kp, _ki, _kd); }
+
+    /**
+    * @brief Scale of the box temperatures (SET_SCALE). Set points,
+    * gains, hysteresis and deadband are converted once here:
+    * applyCompensation then takes samples in _scale without any
+    * conversion. CELSIUS by default.
+    * @return false, and the scale is kept, if the gains do not fit
+    * their limits in _scale
+    */
+    bool setScale(TScale_E _scale);
+
+    TScale_E getScale() const { return m_pidActuator.getScale(); }
+
+    /**
+    * @brief Stop a noisy probe from thrashing the target and the
+    * actuator. Off (all zero) by default.
+    * @param: temp_t _hysteresis - the target switches to the other
+    * set point only once a sample is past it by more than this
+    * @param: temp_t _deadband - an idle box starts compensating only
+    * this far outside its set points; once started it compensates
+    * until back inside them
+    * @param: timeProcess_t _minDwell - time a target is kept at least,
+    * measured on the time of the samples, however often the box steps
+    * Distances are in the scale of the box, converted by setScale.
+    * They are computed in float precision while enabled.
+    */
+    void setHysteresis(temp_t _hysteresis = ISO_DEF_TRSH__CMP_TEMP,
+                       temp_t _deadband = ISO_DEF_TRSH__CMP_TEMP,
+                       timeProcess_t _minDwell = timeProcess_t(0));
+
+    temp_t getHysteresis() const { return m_hysteresis; }
+
+    temp_t getDeadband() const { return m_deadband; }
+
+    /**
+    * @brief Target switches refused by the hysteresis or the dwell time
+    */
+    uint64_t getSwitchesAvoided() const { return m_switchesAvoided; }
+
+    /**
+    * @brief Out of range samples of an idle box held by the deadband:
+    * each one would have started a PID step
+    */
+    uint64_t getRestartsAvoided() const { return m_restartsAvoided; }
+
+    /**
+    * @brief Filter the samples before the compensation (see
+    * isolatedBox_filter.h). ISO_FILTER_NONE by default. The filter
+    * sees the samples given to applyCompensation: under a scheduler
+    * it filters the last sample once per step, filter in the
+    * scheduler instead (isoBoxScheduler::setFilter).
+    */
+    void setFilter(const IsoFilterParams &_params) { m_filter.setParams(_params); }
+
+    const IsoSampleFilter &getFilter() const { return m_filter; }
+
+    /**
+    * @brief Apply a configuration snapshot (see IsoBoxConfigTable).
+    * To be called by the thread that runs applyCompensation. Values
+    * equal to the current ones are not applied again.
+    * @return false if the set points were refused, they are then
+    * left unchanged
+    */
+    bool applyConfig(const IsoBoxConfig &_config);
+
+    /**
+    * @brief Route the box actuator to a PWM channel. Output changes
+    * are written by the next flush of the coalescer.
+    * @return false if the channel is not handled by the coalescer
+    */
+    bool attachPwm(PwmWriteCoalescer *_coalescer, uint32_t _channel)
+    {
+        return m_pidActuator.attachPwm(_coalescer, _channel);
+    }
+
     /**
     * @brief Restart the compensation process if the 
     * temperature measured in ouside the range
@@ -76,6 +172,13 @@ public:
     */
     temp_t applyCompensation(temp_t _temp);
 
+    /**
+    * @brief Same, for a sample taken at _now: the minimum dwell is
+    * measured against it. For callers that already hold the step
+    * time, as the scheduler.
+    */
+    temp_t applyCompensation(temp_t _temp, isoClock_t::time_point _now);
+
    
 private:
     temp_t m_Box_temp;
@@ -83,12 +186,34 @@ private:
     
     PidController m_pidActuator;
 
+    /// <summary>
+    /// Anti thrash filter (setHysteresis) and its counters
+    /// </summary>
+    bool m_filterOn;
+    bool m_compensating;
+    temp_t m_hysteresis;
+    temp_t m_deadband;
+    timeProcess_t m_minDwell;
+    isoClock_t::time_point m_lastSwitch;
+    bool m_switched;            // m_lastSwitch is set
+    uint64_t m_switchesAvoided;
+    uint64_t m_restartsAvoided;
+
+    IsoSampleFilter m_filter;
+
     /**
     * @brief Calculate the suitable target point to select
     * from a given temperature as input
     * @return the array index of target set point array
     */
     PID_SET_POINTS_t getDistancePoint(temp_t _temp);
+
+    /**
+    * @brief getDistancePoint with the hysteresis and the dwell time
+    * @return the array index of the target set point, or
+    * PID_MAX_NUM_POINTS to keep the current one
+    */
+    PID_SET_POINTS_t getFilteredPoint(temp_t _temp, isoClock_t::time_point _now);
 };
 
 };
@@ -7,27 +7,40 @@
  * \date   May 2023
 ***********************************************************************/
 #include "isolatedBox_PID.h"
+#include "isolatedBox_pwm.h"
+#include "isolatedBox_tscale.h"
 
 #ifdef ISO_PRINT_DEBUG
 #include "isolatedBox_printdebug.h"
 #endif // ISO_PRINT_DEBUG
 
+/// <summary>
+/// Gains are validated against their own interval,
+/// not the temperature one
+/// </summary>
+typedef StaticParameterLimits<(int)ISO_PID_GAIN_MIN, (int)ISO_PID_GAIN_MAX, (int)ISO_PID_GAIN_MIN> IsoGainLimits;
 
  PidController::PidController()
-     : m_parameterLimits(ISO_TEMP_MIN_SP, ISO_TEMP_MAX_SP, ISO_TEMP_SP_DEFAULT),
-     m_setPointLimits(ISO_TEMP_MIN_SP, ISO_TEMP_MAX_SP, ISO_TEMP_SP_DEFAULT)
+     : m_setPointLimits(IsoPhysicalTempLimits::runtime()),
+       m_physicalLimits(IsoPhysicalTempLimits::runtime()),
+       m_scale(CELSIUS)
 {
 #ifdef ISO_PRINT_DEBUG
-    ISO_printDebug::printDebug("InitializingP ID Controller");
+    ISO_printDebug::printDebug("Initializing PID Controller");
 #endif
     m_setPoint[PID_MIN_SET_POINT] = PID_SET_POINT_UNAVAILABLE;
     m_setPoint[PID_MAX_SET_POINT] = PID_SET_POINT_UNAVAILABLE;
     m_targetSetPoint = PID_SET_POINT_UNAVAILABLE;
-    m_kp = 0.0;
-    m_ki = 0.0;
-    m_kd = 0.0;
+    m_kp = ISO_PID_KP_DEF;
+    m_ki = ISO_PID_KI_DEF;
+    m_kd = ISO_PID_KD_DEF;
     m_currentError = 0.0;
+    m_sampleTime = timeProcess_t(ISO_SCAN_RATE);
+    m_dt = ISO_SCAN_RATE / 1000.0f;
+    m_output = 0.0;
 
+    updateCoefficients();
+    reset();
     init();
 }
 
@@ -53,6 +66,7 @@ bool PidController::setPoints(temp_t _min, temp_t _max)
             setSetPoint(PID_MAX_SET_POINT, _max);
             m_targetSetPoint = getSetPoint(PID_MIN_SET_POINT);
             m_setPointLimits = ParameterLimits(_min, _max, _min);
+            reset();
         }
         else
         {
@@ -66,12 +80,17 @@ bool PidController::setPoints(temp_t _min, temp_t _max)
             setSetPoint(PID_MIN_SET_POINT, PID_SET_POINT_UNAVAILABLE);
             setSetPoint(PID_MAX_SET_POINT, PID_SET_POINT_UNAVAILABLE);
             m_targetSetPoint = getSetPoint(PID_MIN_SET_POINT);
-            m_setPointLimits = m_parameterLimits;
+            m_setPointLimits = m_physicalLimits;
             lRetVal = false;
         }
     return lRetVal;
 }
 
+bool PidController::attachPwm(PwmWriteCoalescer *_coalescer, uint32_t _channel)
+{
+    return _coalescer->attach(_channel, &m_pwmActuator);
+}
+
 bool PidController::init()
 {
     bool l_retVal = false;
@@ -88,20 +107,43 @@ bool PidController::init()
 }
 
 timeProcess_t PidController::Process(const temp_t _current) {
-    // TO DO
-
+    ISO_TRACE_SCOPE("PidController::Process");
     /// <summary>
-    /// This is a dummy function
-    /// Once the target has been changed we restart the
-    /// PID compensation process by uisng this function
+    /// Once the target has been changed the state is reset
+    /// (see setTargetPoint) and the loop restarts from the
+    /// given temperature. Without a valid target the actuator
+    /// is left untouched.
     /// </summary>
     /// <param name="_current"></param>
     /// <returns></returns>
-    timeProcess_t lret{};
-    
-    // TO IMPLEMENT
+    if (m_targetSetPoint == PID_SET_POINT_UNAVAILABLE)
+        return m_sampleTime;
+
+    temp_t lError = getError(_current);
+    temp_t lP = getProportional(lError);
+    temp_t lI = getIntegral(lError);
+    temp_t lD = getDerivative(_current);
 
-    return lret;
+    return getTransferFnctn(lP, lI, lD);
+}
+
+void PidController::reset()
+{
+    m_integral = 0.0;
+    m_integralStep = 0.0;
+    m_derivative = 0.0;
+    m_lastMeasure = 0.0;
+    m_firstStep = true;
+}
+
+void PidController::updateCoefficients()
+{
+    /// <summary>
+    /// Step is fixed: multiply/divide once here instead of each Process
+    /// </summary>
+    m_kiDt = m_ki * m_dt;
+    m_kdDt = m_kd / m_dt;
+    m_dAlpha = ISO_PID_D_FILTER_TAU / (ISO_PID_D_FILTER_TAU + m_dt);
 }
 
 temp_t PidController::testCurrentTemp(temp_t _curTemp)
@@ -121,7 +163,9 @@ temp_t PidController::testSetPoint(const temp_t _input)
     /// </summary>
     /// <param name="_input"></param>
     /// <returns></returns>
-    return  m_parameterLimits.validate(_input);
+    if (m_scale == CELSIUS)
+        return  IsoPhysicalTempLimits::validate(_input);
+    return m_physicalLimits.validate(_input);
 }
 
 temp_t PidController::getSetPoint(uint8_t _point) const
@@ -138,6 +182,8 @@ temp_t PidController::getSetPoint(uint8_t _point) const
 temp_t PidController::setTargetPoint(uint8_t _point)
 {
     if (_point < PID_MAX_NUM_POINTS) {
+        if (m_targetSetPoint != m_setPoint[_point])
+            reset();
         m_targetSetPoint = m_setPoint[_point];
         return m_targetSetPoint;
     }
@@ -158,13 +204,9 @@ temp_t PidController::setSetPoint(int _point, temp_t _setPoint)
 
 }
 
-/* From here down the following methods are only prepared for future
- * use in a possible real implementation
- */
-
 void PidController::setKp(const temp_t _input)
 {
-    m_kp = m_parameterLimits.validate(_input);
+    m_kp = IsoGainLimits::validate(_input);
 }
 
 temp_t PidController::getKp() const 
@@ -174,53 +216,141 @@ temp_t PidController::getKp() const
 
 void PidController::setKi(const temp_t _input)
 {
-    m_ki = m_parameterLimits.validate(_input);
+    m_ki = IsoGainLimits::validate(_input);
+    updateCoefficients();
 }
 
 temp_t PidController::getKi() const { return m_ki; }
 
 void PidController::setKd(const temp_t _input)
 {
-    m_kd = m_parameterLimits.validate(_input);
+    m_kd = IsoGainLimits::validate(_input);
+    updateCoefficients();
 }
 
 temp_t PidController::getKd() const { return m_kd; }
 
-temp_t PidController::getError(const temp_t _current)
+void PidController::setGains(const temp_t _kp, const temp_t _ki, const temp_t _kd)
 {
-    return m_currentError;
+    m_kp = IsoGainLimits::validate(_kp);
+    m_ki = IsoGainLimits::validate(_ki);
+    m_kd = IsoGainLimits::validate(_kd);
+    updateCoefficients();
 }
 
-temp_t PidController::getProportional(const temp_t error)
+bool PidController::setScale(TScale_E _scale)
 {
-    temp_t lret = m_kp;
+    if (_scale >= MAX_VALUE_TSCALE)
+        return false;
+    if (_scale == m_scale)
+        return true;
+
+    /// <summary>
+    /// Gains are per degree: the same error reads lDegree times
+    /// larger in the new scale. A gain pushed out of its limits
+    /// would be reset by setGains: refuse the scale instead.
+    /// Integral and derivative terms are duty cycle values and stay
+    /// as they are.
+    /// </summary>
+    const TScale_E lFrom = m_scale;
+    temp_t lDegree = isoConvertDelta(1.0f, lFrom, _scale);
+    temp_t lKp = m_kp / lDegree;
+    temp_t lKi = m_ki / lDegree;
+    temp_t lKd = m_kd / lDegree;
+    if (lKp > ISO_PID_GAIN_MAX || lKi > ISO_PID_GAIN_MAX || lKd > ISO_PID_GAIN_MAX)
+        return false;
+    m_scale = _scale;
 
-    return lret;
+    /// <summary>
+    /// The physical interval is converted from its celsius bounds,
+    /// not from the previous scale, so no rounding accumulates
+    /// </summary>
+    m_physicalLimits = ParameterLimits(isoConvertTemp(ISO_TEMP_MIN_SP, CELSIUS, _scale),
+                                       isoConvertTemp(ISO_TEMP_MAX_SP, CELSIUS, _scale),
+                                       isoConvertTemp(ISO_TEMP_SP_DEFAULT, CELSIUS, _scale));
+
+    for (int i = 0; i < PID_MAX_NUM_POINTS; i++)
+        if (m_setPoint[i] != PID_SET_POINT_UNAVAILABLE)
+            m_setPoint[i] = isoConvertTemp(m_setPoint[i], lFrom, _scale);
+    if (m_targetSetPoint != PID_SET_POINT_UNAVAILABLE)
+        m_targetSetPoint = isoConvertTemp(m_targetSetPoint, lFrom, _scale);
+    if (m_setPoint[PID_MIN_SET_POINT] != PID_SET_POINT_UNAVAILABLE)
+        m_setPointLimits = ParameterLimits(m_setPoint[PID_MIN_SET_POINT], m_setPoint[PID_MAX_SET_POINT],
+                                           m_setPoint[PID_MIN_SET_POINT]);
+    else
+        m_setPointLimits = m_physicalLimits;
+    m_lastMeasure = isoConvertTemp(m_lastMeasure, lFrom, _scale);
+    setGains(lKp, lKi, lKd);
+    return true;
 }
 
-temp_t PidController::getIntegral(const temp_t _error) {
-    temp_t lret{};
+temp_t PidController::getError(const temp_t _current)
+{
+    m_currentError = m_targetSetPoint - _current;
+    return m_currentError;
+}
 
-    // TO IMPLEMENT
+temp_t PidController::getProportional(const temp_t _error)
+{
+    return m_kp * _error;
+}
 
-    return lret;
+temp_t PidController::getIntegral(const temp_t _error) {
+    /// <summary>
+    /// Candidate value only. getTransferFnctn decides
+    /// if the step can be committed (anti-windup)
+    /// </summary>
+    m_integralStep = m_kiDt * _error;
+    return m_integral + m_integralStep;
 }
 
-temp_t PidController::getDerivative(const temp_t error) {
-    temp_t lret{};
+temp_t PidController::getDerivative(const temp_t _current) {
+    /// <summary>
+    /// Derivative on measurement: -kd * d(measure)/dt
+    /// First step has no history, so no derivative contribution
+    /// </summary>
+    if (m_firstStep) {
+        m_firstStep = false;
+        m_lastMeasure = _current;
+        m_derivative = 0.0;
+        return m_derivative;
+    }
 
-    // TO IMPLEMENT
+    temp_t lRaw = -m_kdDt * (_current - m_lastMeasure);
+    m_lastMeasure = _current;
+    m_derivative = m_dAlpha * m_derivative + (1.0f - m_dAlpha) * lRaw;
 
-    return lret;
+    return m_derivative;
 }
 
 timeProcess_t PidController::getTransferFnctn(const temp_t pTemp, const temp_t iTemp,
     const temp_t dTemp)
 {
-    timeProcess_t lret{};
+    const temp_t lMin = ISO_PWM_DUTY_CYCLE_MIN;
+    const temp_t lMax = ISO_PWM_DUTY_CYCLE_MAX;
+    temp_t lOut = pTemp + iTemp + dTemp;
+
+    /// <summary>
+    /// Conditional integration: drop the integral step if the output
+    /// is saturated and the step would push it further out
+    /// </summary>
+    bool lWindup = (lOut > lMax && m_integralStep > 0) ||
+                   (lOut < lMin && m_integralStep < 0);
+    if (!lWindup) {
+        m_integral = iTemp;
+        if (m_integral > lMax)
+            m_integral = lMax;
+        else if (m_integral < lMin)
+            m_integral = lMin;
+    }
 
-    // TO IMPLEMENT
+    if (lOut > lMax)
+        lOut = lMax;
+    else if (lOut < lMin)
+        lOut = lMin;
+    m_output = lOut;
 
-    return lret;
+    m_pwmActuator.setDutyCycle((uint8_t)(lOut + 0.5f));
 
+    return m_sampleTime;
 }
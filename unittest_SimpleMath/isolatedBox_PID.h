@@ -22,6 +22,27 @@ typedef enum PID_SET_POINTS {
 }PID_SET_POINTS_t;
 
 #define PID_SET_POINT_UNAVAILABLE       65535
+
+/// <summary>
+/// Gains are expressed in duty cycle percent per degree (kP),
+/// per degree and second (kI), per degree per second (kD)
+/// </summary>
+constexpr auto ISO_PID_GAIN_MIN = 0.0f;
+constexpr auto ISO_PID_GAIN_MAX = 1000.0f;
+constexpr auto ISO_PID_KP_DEF = 10.0f;
+constexpr auto ISO_PID_KI_DEF = 1.0f;
+constexpr auto ISO_PID_KD_DEF = 0.5f;
+
+/// <summary>
+/// Time constant (seconds) of the low pass filter on the derivative term
+/// </summary>
+constexpr auto ISO_PID_D_FILTER_TAU = 0.02f;
+
+/// <summary>
+/// Physical temperature interval of the controller, fixed per board
+/// </summary>
+typedef StaticParameterLimits<ISO_TEMP_MIN_SP, ISO_TEMP_MAX_SP, ISO_TEMP_SP_DEFAULT> IsoPhysicalTempLimits;
+
 /**
  * @brief Pid Processor 
  */
@@ -54,14 +75,45 @@ public:
      bool setPoints(temp_t _min, temp_t _max);
 
     /**
-     * @brief restart the compensation process from the given 
-     * temparature in input.
-     * A real PID controller SHOULD BE IMPLEMENTED (TO DO)
+     * @brief One fixed step (ISO_SCAN_RATE) of the discrete PID
+     * towards m_targetSetPoint. The output is clamped to the PWM duty
+     * cycle range and applied to the actuator. Integral uses
+     * conditional integration (anti-windup), derivative is computed on
+     * the measurement and low pass filtered.
+     * Constant time, no allocation.
      * @param current: given temperature
-     * @return timeProcess_t
+     * @return timeProcess_t - time to wait before the next step
      */
      timeProcess_t Process(const temp_t current);
 
+     /**
+     * @brief Clear integral and derivative state. Called when the
+     * target set point changes so the loop restarts from scratch.
+     */
+     void reset();
+
+     /**
+     * @brief Last output of the controller (duty cycle percent)
+     */
+     temp_t getOutput() const { return m_output; }
+
+     /**
+     * @brief Fixed step of the controller
+     */
+     timeProcess_t getSampleTime() const { return m_sampleTime; }
+
+     /**
+     * @brief The PWM actuator driven by the controller
+     */
+     const IsoActuator &getActuator() const { return m_pwmActuator; }
+
+     /**
+     * @brief Route the actuator output to a PWM channel written
+     * in batch by the coalescer (see isolatedBox_pwm.h)
+     * @return false if the channel is not handled by the coalescer
+     */
+     bool attachPwm(PwmWriteCoalescer *_coalescer, uint32_t _channel);
+
      /**
     * @brief Test if a temparature in input is in the
     * proper application range (use m_setPointLimits)
@@ -72,7 +124,7 @@ public:
 
     /**
      * @brief Verify if the temperature is allowed in degrees C
-     * Min/Max. Use m_parameterLimits.
+     * Min/Max. Use IsoPhysicalTempLimits.
      * This is relevant to the Physical limit of the PID controller
      * @param temp_t _setpoint: temperature to test
      * @return the same temperature to test if it is OK (in the range)
@@ -89,6 +141,7 @@ public:
      /**
      * @brief Set the target temperature to start
      * compensation process between the possible target set points
+     * The controller state is reset if the target changes
      * @param int _point - Index of the set point array
      * @return temp_t
      */
@@ -105,46 +158,60 @@ public:
 
     /**
      * @brief Set the proportional gain
-     * Min/Max:
-     * NOT USED
+     * Min/Max: ISO_PID_GAIN_MIN / ISO_PID_GAIN_MAX
      */
      void setKp(const temp_t _k);
 
     /**
      * @brief Get the proportional gain
-     * NOT USED
      * @return temp_t
      */
      temp_t getKp() const;
 
     /**
      * @brief Set the integral gain
-     * Min/Max:
-     * NOT USED
+     * Min/Max: ISO_PID_GAIN_MIN / ISO_PID_GAIN_MAX
      */
      void setKi(const temp_t);
 
     /**
      * @brief Get the integral gain
-     * NOT USED
      * @return temp_t
      */
      temp_t getKi() const;
 
     /**
      * @brief Set the derivative gain
-     * Min/Max:
-     * NOT USED
+     * Min/Max: ISO_PID_GAIN_MIN / ISO_PID_GAIN_MAX
      */
      void setKd(const temp_t);
 
     /**
      * @brief Get the derivative gain
-     * NOT USED
      * @return temp_t
      */
      temp_t getKd() const;
 
+    /**
+     * @brief Set the three gains at once, as loaded from a profile
+     * (see isolatedBox_profile.h): coefficients are updated once
+     * Min/Max: ISO_PID_GAIN_MIN / ISO_PID_GAIN_MAX
+     */
+     void setGains(const temp_t _kp, const temp_t _ki, const temp_t _kd);
+
+    /**
+     * @brief Express the controller in another temperature scale.
+     * Set points, limits and state are converted here, once, and the
+     * gains are rescaled so the loop response does not change: the
+     * temperatures given to Process must then be in _scale.
+     * CELSIUS by default.
+     * @return false, and nothing changed, if a rescaled gain would
+     * be out of ISO_PID_GAIN_MIN / ISO_PID_GAIN_MAX
+     */
+     bool setScale(TScale_E _scale);
+
+     TScale_E getScale() const { return m_scale; }
+
      /**
      * @brief The target set point of the device is one of the
        m_setPoint array
@@ -164,19 +231,19 @@ private:
 
     /**
      * @brief Proportional gain
-     * Min / Max: 20C / 100C
+     * Min / Max: ISO_PID_GAIN_MIN / ISO_PID_GAIN_MAX
      */
     temp_t m_kp;
 
     /**
      * @brief Integral gain
-     * Min / Max: 20C / 100C
+     * Min / Max: ISO_PID_GAIN_MIN / ISO_PID_GAIN_MAX
      */
     temp_t m_ki;
 
     /**
      * @brief Derivative gain
-     * Min / Max: 20C / 100C
+     * Min / Max: ISO_PID_GAIN_MIN / ISO_PID_GAIN_MAX
      */
     temp_t m_kd;
 
@@ -185,16 +252,46 @@ private:
      */
     temp_t m_currentError;
 
+    /**
+     * @brief Fixed step: dt in seconds and as timeProcess_t
+     */
+    temp_t m_dt;
+    timeProcess_t m_sampleTime;
+
+    /**
+     * @brief Gains pre-multiplied by the step (ki * dt, kd / dt)
+     * and smoothing factor of the derivative filter
+     */
+    temp_t m_kiDt;
+    temp_t m_kdDt;
+    temp_t m_dAlpha;
+
+    /**
+     * @brief Controller state
+     */
+    temp_t m_integral;
+    temp_t m_integralStep;
+    temp_t m_derivative;
+    temp_t m_lastMeasure;
+    temp_t m_output;
+    bool m_firstStep;
+
     /// <summary>
-    /// m_parameterLimits store the pyhisical temperature interval
-    /// m_setPointLimits store the application temperature interval
+    /// m_setPointLimits store the application temperature interval.
+    /// The physical one is IsoPhysicalTempLimits, in celsius:
+    /// m_physicalLimits is only used in the other scales
     /// </summary>
-    ParameterLimits m_parameterLimits;
     ParameterLimits m_setPointLimits;
+    ParameterLimits m_physicalLimits;
+    TScale_E m_scale;
+
+    /**
+     * @brief Recompute the step dependent coefficients
+     */
+    void updateCoefficients();
 
     /**
      * @brief Get temperature error
-     * NOT USED
      * @param current - current temperature 
      * @return temp_t - temperature error e(t)
      */
@@ -202,35 +299,35 @@ private:
 
     /**
      * @brief Get the proportional adjustment
-     * NOT USED
      * @param error - temperature error e(t)
      * @return temp_t - Proportional temperature adjustment
      */
     temp_t getProportional(const temp_t _error);
 
     /**
-     * @brief Get the integral adjustment
-     * NOT USED
+     * @brief Get the integral adjustment. The new step is kept
+     * in m_integralStep and committed by getTransferFnctn
      * @param error - temperature error e(t)
      * @return temp_t - Integral temperature adjustment
      */
     temp_t getIntegral(const temp_t _error);
 
     /**
-     * @brief Get the Derivative object
-     * NOT USED
-     * @param error - temperature error e(t)
+     * @brief Get the derivative adjustment, computed on the
+     * measurement to avoid kicks on target changes and low pass filtered
+     * @param current - current temperature
      * @return temp_t - Derivative temperature adjustment
      */
-    temp_t getDerivative(const temp_t _error);
+    temp_t getDerivative(const temp_t _current);
 
     /**
-     * @brief Get the transfer function result
-     * NOT USED
+     * @brief Get the transfer function result: clamp the sum to the
+     * duty cycle range, apply it to the actuator and commit the
+     * integral step unless it would push the output further into saturation
      * @param pTemp - Proportional adjustment
      * @param iTemp - Integral adjustment
      * @param dTemp - Derivative adjustment
-     * @return timeProcess_t
+     * @return timeProcess_t - time to wait before the next step
      */
     timeProcess_t getTransferFnctn(const temp_t _pTemp, const temp_t _iTemp,
        const temp_t _dTemp);
@@ -1,11 +1,41 @@
 #include "isolatedBox_actuator.h"
+#include "isolatedBox_pwm.h"
 #ifdef ISO_PRINT_DEBUG
 #include "isolatedBox_printdebug.h"
 #endif // ISO_PRINT_DEBUG
 #include <cstdio>
 
+RuntimeActuatorLimits::RuntimeActuatorLimits()
+    : m_freqMin(IsoActuatorLimits::frequencyMin()),
+      m_freqMax(IsoActuatorLimits::frequencyMax()),
+      m_freqDef(IsoActuatorLimits::frequencyDef()),
+      m_dutyMin(IsoActuatorLimits::dutyCycleMin()),
+      m_dutyMax(IsoActuatorLimits::dutyCycleMax()),
+      m_dutyDef(IsoActuatorLimits::dutyCycleDef()),
+      m_intensityMax(IsoActuatorLimits::intensityMax())
+{
+}
+
+bool RuntimeActuatorLimits::setLimits(uint32_t _freqMin, uint32_t _freqMax, uint32_t _freqDef,
+                                      uint8_t _dutyMin, uint8_t _dutyMax, uint8_t _dutyDef,
+                                      uint8_t _intensityMax)
+{
+    if (_freqDef <= _freqMin || _freqDef >= _freqMax)
+        return false;
+    if (_dutyDef < _dutyMin || _dutyDef > _dutyMax)
+        return false;
+
+    m_freqMin = _freqMin;
+    m_freqMax = _freqMax;
+    m_freqDef = _freqDef;
+    m_dutyMin = _dutyMin;
+    m_dutyMax = _dutyMax;
+    m_dutyDef = _dutyDef;
+    m_intensityMax = _intensityMax;
+    return true;
+}
 
-IsoActuator::IsoActuator()
+IsoActuatorState::IsoActuatorState()
 {
 #ifdef ISO_PRINT_DEBUG
     ISO_printDebug::printDebug("Initializing PWM Controller");
@@ -14,11 +44,54 @@ IsoActuator::IsoActuator()
     m_dutyCycle = 0;
     m_frequency = 0;
     m_intensity = 0;
+    m_coalescer = nullptr;
+    m_channel = 0;
+}
+
+uint8_t IsoActuatorState::getIntensity() const { return m_intensity; }
+
+uint32_t IsoActuatorState::getFrequency() const { return m_frequency; }
+
+uint8_t IsoActuatorState::getDutyCycle() const { return m_dutyCycle; }
+
+EquipmentState IsoActuatorState::getPwmState() const
+{
+    return m_pwmState;
 }
 
-IsoActuator::~IsoActuator() {}
+void IsoActuatorState::attach(PwmWriteCoalescer *_coalescer, uint32_t _channel)
+{
+    m_coalescer = _coalescer;
+    m_channel = _channel;
+}
 
-bool IsoActuator::init()
+void IsoActuatorState::applyOutput()
+{
+    ISO_TRACE_SCOPE("IsoActuator::applyOutput");
+    /// <summary>
+    /// Instead of an immediate pwmWrite(PWM_IO _io, ...) the channel
+    /// is written with the other changed ones at the end of the tick
+    /// </summary>
+    if (m_coalescer != nullptr)
+        m_coalescer->markDirty(m_channel);
+}
+
+template<class Limits>
+BasicIsoActuator<Limits>::BasicIsoActuator()
+{
+}
+
+template<class Limits>
+BasicIsoActuator<Limits>::BasicIsoActuator(const Limits &_limits)
+    : Limits(_limits)
+{
+}
+
+template<class Limits>
+BasicIsoActuator<Limits>::~BasicIsoActuator() {}
+
+template<class Limits>
+bool BasicIsoActuator<Limits>::init()
 {
     bool success = false;
 
@@ -30,13 +103,13 @@ bool IsoActuator::init()
     /// </summary>
     /// <returns></returns>
     
-    if ((setFrequency(ISO_PWM_FREQUENCY_DEF) == true) &&
-        (setDutyCycle(ISO_PWM_DUTY_CYCLE_DEF) == true)) {
+    if ((setFrequency(this->frequencyDef()) == true) &&
+        (setDutyCycle(this->dutyCycleDef()) == true)) {
             m_pwmState = ENABLED;
             m_dutyCycle = 0;
             m_frequency = 0;
             m_intensity = 0;
-            /// bool pwmWrite(PWM_IO _io, float _intensity); /// m_intensity
+            applyOutput();
             success = true;
     }
     
@@ -44,77 +117,76 @@ bool IsoActuator::init()
 }
 
 
-void IsoActuator::operator!() { m_pwmState = DISABLED; }
+template<class Limits>
+void BasicIsoActuator<Limits>::operator!()
+{
+    m_pwmState = DISABLED;
+    applyOutput();
+}
 
-void IsoActuator::operator++()
+template<class Limits>
+void BasicIsoActuator<Limits>::operator++()
 {
-    if (m_intensity < ISO_PWM_INTENSITY_MAX_VALUE)
+    if (m_intensity < this->intensityMax())
     {
         ++m_intensity;
-        /// <summary>
-        /// Apply intensity
-        /// bool pwmWrite(PWM_IO _io, float _intensity); /// m_intensity
-        /// </summary>
+        applyOutput();
     }
 }
 
-void IsoActuator::operator+=(const uint8_t value)
+template<class Limits>
+void BasicIsoActuator<Limits>::operator+=(const uint8_t value)
 {
-    if (m_intensity + value <= ISO_PWM_INTENSITY_MAX_VALUE)
+    if (m_intensity + value <= this->intensityMax())
     {
         m_intensity += value;
-        /// <summary>
-        /// Apply intensity
-        /// bool pwmWrite(PWM_IO _io, float _intensity); /// m_intensity
-        /// </summary>
+        applyOutput();
     }
 }
 
-void IsoActuator::operator--()
+template<class Limits>
+void BasicIsoActuator<Limits>::operator--()
 {
     if (m_intensity > 0)
     {
         --m_intensity;
-        /// <summary>
-        /// Apply intensity
-        /// bool pwmWrite(PWM_IO _io, float _intensity); /// m_intensity
-        /// </summary>
+        applyOutput();
     }
 }
 
-void IsoActuator::operator-=(const uint8_t value)
+template<class Limits>
+void BasicIsoActuator<Limits>::operator-=(const uint8_t value)
 {
-    if (m_intensity > 0)
+    if (m_intensity >= value)
     {
         m_intensity -= value;
-        /// <summary>
-        /// Apply intensity
-        /// bool pwmWrite(PWM_IO _io, float _intensity); /// m_intensity
-        /// </summary>
+        applyOutput();
     }
 }
 
-bool IsoActuator::setIntensity(const uint8_t value)
+template<class Limits>
+bool BasicIsoActuator<Limits>::setIntensity(const uint8_t value)
 {
-    if (value <= ISO_PWM_INTENSITY_MAX_VALUE && value >= 0)
+    if (value <= this->intensityMax())
     {
-        m_intensity = value;
-        /// <summary>
-         /// Apply intensity
-         /// bool pwmWrite(PWM_IO _io, float _intensity); /// m_intensity
-         /// </summary>
-         /// return true;
+        if (m_intensity != value) {
+            m_intensity = value;
+            applyOutput();
+        }
+        return true;
     }
     else return false;
 }
 
-uint8_t IsoActuator::getIntensity() const { return m_intensity; }
-
-bool IsoActuator::setFrequency(const uint32_t value)
+template<class Limits>
+bool BasicIsoActuator<Limits>::setFrequency(const uint32_t value)
 {
-    if (value <  ISO_PWM_FREQUENCY_MAX && value > ISO_PWM_FREQUENCY_MIN)
+    if (value < this->frequencyMax() && value > this->frequencyMin())
     {
-        m_frequency = value;
+        if (m_frequency != value) {
+            m_frequency = value;
+            applyOutput();
+        }
         return true;
     } 
     else
@@ -123,13 +195,15 @@ bool IsoActuator::setFrequency(const uint32_t value)
     }
 }
 
-uint32_t IsoActuator::getFrequency() const { return m_frequency; }
-
-bool IsoActuator::setDutyCycle(const uint8_t value)
+template<class Limits>
+bool BasicIsoActuator<Limits>::setDutyCycle(const uint8_t value)
 {
-    if (value <  ISO_PWM_DUTY_CYCLE_MAX && value >  ISO_PWM_DUTY_CYCLE_MIN)
+    if (value <= this->dutyCycleMax() && value >= this->dutyCycleMin())
     {
-        m_dutyCycle = value;
+        if (m_dutyCycle != value) {
+            m_dutyCycle = value;
+            applyOutput();
+        }
         return true;
     }
     else {
@@ -137,9 +211,10 @@ bool IsoActuator::setDutyCycle(const uint8_t value)
     }
 }
 
-uint8_t IsoActuator::getDutyCycle() const { return m_dutyCycle; }
+/// <summary>
+/// Compile time limits cost no storage
+/// </summary>
+static_assert(sizeof(IsoActuator) == sizeof(IsoActuatorState), "static limits must not add storage");
 
-EquipmentState IsoActuator::getPwmState()
-{
-    return m_pwmState;
-}
+template class BasicIsoActuator<IsoActuatorLimits>;
+template class BasicIsoActuator<RuntimeActuatorLimits>;
@@ -19,13 +19,130 @@ constexpr auto ISO_PWM_DUTY_CYCLE_DEF = 0;
 
 constexpr auto ISO_PWM_INTENSITY_MAX_VALUE = 100;
 
-class IsoActuator
+class PwmWriteCoalescer;
+
+/**
+* @brief Actuator limits fixed at compile time. Every accessor is a
+* constant so the range checks fold away and the actuator carries no
+* limit storage. Frequency bounds are exclusive, duty cycle and
+* intensity bounds inclusive.
+*/
+template<uint32_t FreqMin, uint32_t FreqMax, uint32_t FreqDef,
+         uint8_t DutyMin, uint8_t DutyMax, uint8_t DutyDef, uint8_t IntensityMax>
+struct StaticActuatorLimits
 {
+	static constexpr uint32_t frequencyMin() { return FreqMin; }
+	static constexpr uint32_t frequencyMax() { return FreqMax; }
+	static constexpr uint32_t frequencyDef() { return FreqDef; }
+	static constexpr uint8_t dutyCycleMin() { return DutyMin; }
+	static constexpr uint8_t dutyCycleMax() { return DutyMax; }
+	static constexpr uint8_t dutyCycleDef() { return DutyDef; }
+	static constexpr uint8_t intensityMax() { return IntensityMax; }
+};
 
+/**
+* @brief Limits of the default board
+*/
+typedef StaticActuatorLimits<ISO_PWM_FREQUENCY_MIN, ISO_PWM_FREQUENCY_MAX, ISO_PWM_FREQUENCY_DEF,
+                             ISO_PWM_DUTY_CYCLE_MIN, ISO_PWM_DUTY_CYCLE_MAX, ISO_PWM_DUTY_CYCLE_DEF,
+                             ISO_PWM_INTENSITY_MAX_VALUE> IsoActuatorLimits;
+
+/**
+* @brief Actuator limits configured at run time, for boards only
+* known once the application is running. Starts with the default
+* board limits.
+*/
+class RuntimeActuatorLimits
+{
 public:
-	IsoActuator();
+	RuntimeActuatorLimits();
+
+	/**
+	* @brief Change the limits
+	* @return false (limits unchanged) if a range is empty
+	* or a default is out of its range
+	*/
+	bool setLimits(uint32_t _freqMin, uint32_t _freqMax, uint32_t _freqDef,
+	               uint8_t _dutyMin, uint8_t _dutyMax, uint8_t _dutyDef, uint8_t _intensityMax);
+
+	uint32_t frequencyMin() const { return m_freqMin; }
+	uint32_t frequencyMax() const { return m_freqMax; }
+	uint32_t frequencyDef() const { return m_freqDef; }
+	uint8_t dutyCycleMin() const { return m_dutyMin; }
+	uint8_t dutyCycleMax() const { return m_dutyMax; }
+	uint8_t dutyCycleDef() const { return m_dutyDef; }
+	uint8_t intensityMax() const { return m_intensityMax; }
+
+private:
+	uint32_t m_freqMin;
+	uint32_t m_freqMax;
+	uint32_t m_freqDef;
+	uint8_t m_dutyMin;
+	uint8_t m_dutyMax;
+	uint8_t m_dutyDef;
+	uint8_t m_intensityMax;
+};
 
-	~IsoActuator();
+/**
+* @brief Output state of an actuator, whatever its limits. This is
+* what a PWM channel is written from (see isolatedBox_pwm.h).
+*/
+class IsoActuatorState
+{
+
+public:
+	IsoActuatorState();
+
+	uint8_t getIntensity() const;
+
+	uint32_t getFrequency() const;
+
+	uint8_t getDutyCycle() const;
+
+	EquipmentState getPwmState() const;
+
+	/**
+	* @brief Route the output to a PWM channel. Changes are not written
+	* right away: the channel is marked dirty and written by the next
+	* PwmWriteCoalescer::flush (see isolatedBox_pwm.h)
+	*/
+	void attach(PwmWriteCoalescer *_coalescer, uint32_t _channel);
+
+protected:
+	/**
+	* @brief Output changed: mark the channel dirty if attached
+	*/
+	void applyOutput();
+
+	PwmWriteCoalescer *m_coalescer;
+
+	uint32_t m_channel;
+
+	uint32_t m_frequency;
+
+	EquipmentState m_pwmState;
+
+	uint8_t m_intensity;
+
+	uint8_t m_dutyCycle;
+};
+
+/**
+* @brief PWM actuator validating its settings against Limits:
+* StaticActuatorLimits (no storage, constant checks) or
+* RuntimeActuatorLimits. Instantiated in isolatedBox_actuator.cpp
+* for IsoActuatorLimits and RuntimeActuatorLimits.
+*/
+template<class Limits>
+class BasicIsoActuator : public IsoActuatorState, private Limits
+{
+
+public:
+	BasicIsoActuator();
+
+	explicit BasicIsoActuator(const Limits &_limits);
+
+	~BasicIsoActuator();
 
 	bool init();
 
@@ -41,26 +158,15 @@ public:
 
 	bool setIntensity(const uint8_t value);
 
-	uint8_t getIntensity() const;
-
 	bool setFrequency(const uint32_t value);
 
-	uint32_t getFrequency() const;
-
 	bool setDutyCycle(const uint8_t value);
 
-	uint8_t getDutyCycle() const;
-
-	EquipmentState getPwmState();
-
-private:
-	EquipmentState m_pwmState;
+	const Limits &getLimits() const { return *this; }
+};
 
-	uint8_t m_intensity;
+typedef BasicIsoActuator<IsoActuatorLimits> IsoActuator;
 
-	uint32_t m_frequency;
-
-	uint8_t m_dutyCycle;
-};
+typedef BasicIsoActuator<RuntimeActuatorLimits> IsoRuntimeActuator;
 
 #endif /* _ISO_ACTUATOR_H_ */
\ No newline at end of file
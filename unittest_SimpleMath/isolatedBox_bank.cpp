@@ -0,0 +1,111 @@
+/*****************************************************************//**
+ * \file   isolatedBox_bank.cpp
+ * \brief: Structure of arrays version of the isoBox range check and
+ * target selection, to evaluate many boxes per scan tick
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+
+#include "isolatedBox_bank.h"
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace isoBoxApi;
+
+
+BoxBank::BoxBank(size_t _numBoxes)
+    : m_min(_numBoxes, PID_SET_POINT_UNAVAILABLE),
+      m_max(_numBoxes, PID_SET_POINT_UNAVAILABLE),
+      m_target(_numBoxes, PID_SET_POINT_UNAVAILABLE),
+      m_lastTemp(_numBoxes, ISO_DEF_UNDEF_TEMP),
+      m_initDone(_numBoxes, 0)
+{
+}
+
+bool BoxBank::init(size_t _box, temp_t _min, temp_t _max)
+{
+    /// <summary>
+    /// Same rules as isoBox::init / PidController::setPoints:
+    /// - max <= min: rejected, nothing changes
+    /// - set points outside the physical interval: rejected, set points
+    ///   become unavailable and the box is not initialized
+    /// </summary>
+    if (!(_max > _min))
+        return false;
+
+    bool lValid = (_min >= ISO_TEMP_MIN_SP && _min <= ISO_TEMP_MAX_SP) &&
+                  (_max >= ISO_TEMP_MIN_SP && _max <= ISO_TEMP_MAX_SP);
+    if (lValid) {
+        m_min[_box] = _min;
+        m_max[_box] = _max;
+    }
+    else {
+        m_min[_box] = PID_SET_POINT_UNAVAILABLE;
+        m_max[_box] = PID_SET_POINT_UNAVAILABLE;
+    }
+    m_target[_box] = m_min[_box];
+    m_initDone[_box] = lValid ? 1 : 0;
+    return lValid;
+}
+
+temp_t BoxBank::getSetPoint(size_t _box, int _point) const
+{
+    if (_point == PID_MIN_SET_POINT)
+        return m_min[_box];
+    if (_point == PID_MAX_SET_POINT)
+        return m_max[_box];
+    return PID_SET_POINT_UNAVAILABLE;
+}
+
+temp_t BoxBank::setTargetPoint(size_t _box, uint8_t _point)
+{
+    if (_point >= PID_MAX_NUM_POINTS)
+        return PID_SET_POINT_UNAVAILABLE;
+    m_target[_box] = getSetPoint(_box, _point);
+    return m_target[_box];
+}
+
+/// <summary>
+/// Kernel on raw arrays: restrict qualified parameters let the
+/// compiler vectorize the loop without runtime alias checks
+/// </summary>
+static void compensateKernel(const temp_t *__restrict _temps, temp_t *__restrict _out,
+                             const temp_t *__restrict _min, const temp_t *__restrict _max,
+                             const int32_t *__restrict _initDone, temp_t *__restrict _target,
+                             temp_t *__restrict _last, size_t _n)
+{
+    const temp_t lUndef = ISO_DEF_UNDEF_TEMP;
+
+    for (size_t i = 0; i < _n; i++) {
+        temp_t lTemp = _temps[i];
+        temp_t lLo = _min[i];
+        temp_t lHi = _max[i];
+        temp_t lCurrent = _target[i];
+
+        /// <summary>
+        /// Distance to the set points truncated toward zero, as in
+        /// isoBox::getDistancePoint. Equal distance keeps the target.
+        /// A non-finite sample is not a measurement: no compensation.
+        /// </summary>
+        int32_t lFirst = std::abs(isoSetPointDistance(lTemp, lLo));
+        int32_t lSecond = std::abs(isoSetPointDistance(lTemp, lHi));
+        temp_t lNearest = (lFirst < lSecond) ? lLo : ((lFirst > lSecond) ? lHi : lCurrent);
+
+        bool lCompensate = (_initDone[i] != 0) & std::isfinite(lTemp) & ((lTemp < lLo) | (lTemp > lHi));
+
+        _target[i] = lCompensate ? lNearest : lCurrent;
+        _out[i] = lCompensate ? lNearest : lUndef;
+        _last[i] = lTemp;
+    }
+}
+
+void BoxBank::applyCompensation(const temp_t *_temps, temp_t *_targets, size_t _n)
+{
+    if (_n > size())
+        _n = size();
+
+    compensateKernel(_temps, _targets, m_min.data(), m_max.data(), m_initDone.data(),
+                     m_target.data(), m_lastTemp.data(), _n);
+}
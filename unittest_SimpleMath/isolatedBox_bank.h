@@ -0,0 +1,78 @@
+/*****************************************************************//**
+ * \file   isolatedBox_bank.h
+ * \brief: Structure of arrays version of the isoBox range check and
+ * target selection, to evaluate many boxes per scan tick
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_BOX_BANK_H
+#define _ISO_BOX_BANK_H
+
+#include <vector>
+
+#include "isolatedBoxCmake.h"
+
+namespace isoBoxApi {
+
+/**
+ * @brief Holds set points, targets and last temperatures of a set of
+ * boxes in contiguous float arrays. applyCompensation gives the same
+ * results as isoBox::applyCompensation called on each box, without the
+ * PID step, which stays per box.
+ */
+class BoxBank {
+public:
+    /**
+    * @brief Constructor: _numBoxes boxes, none initialized
+    */
+    explicit BoxBank(size_t _numBoxes);
+
+    size_t size() const { return m_target.size(); }
+
+    /**
+     * @brief Same checks and side effects as isoBox::init
+     * @param: size_t _box - Index of the box
+     * @param: temp_t _min - Minimum temperarure treshold request
+     * @param: temp_t _max - Maximum temperarure treshold request
+     * @return true if the init is OK
+     */
+    bool init(size_t _box, temp_t _min, temp_t _max);
+
+    bool getInitDone(size_t _box) const { return m_initDone[_box] != 0; }
+
+    /**
+     * @brief Get one of the set points of a box (see PID_SET_POINTS)
+     */
+    temp_t getSetPoint(size_t _box, int _point) const;
+
+    /**
+     * @brief Select the target set point of a box (see PID_SET_POINTS)
+     * @return the target or PID_SET_POINT_UNAVAILABLE
+     */
+    temp_t setTargetPoint(size_t _box, uint8_t _point);
+
+    temp_t getTargetPoint(size_t _box) const { return m_target[_box]; }
+
+    temp_t getLastTemp(size_t _box) const { return m_lastTemp[_box]; }
+
+    /**
+    * @brief Evaluate boxes [0, _n) with one temperature each.
+    * Branch free loop over the arrays, vectorizable by the compiler.
+    * @param: _temps - measured temperatures, one per box
+    * @param: _targets - out: target set point per box or
+    * ISO_DEF_UNDEF_TEMP where no compensation is needed
+    * @param: _n - number of boxes, at most size()
+    */
+    void applyCompensation(const temp_t *_temps, temp_t *_targets, size_t _n);
+
+private:
+    std::vector<temp_t> m_min;
+    std::vector<temp_t> m_max;
+    std::vector<temp_t> m_target;
+    std::vector<temp_t> m_lastTemp;
+    std::vector<int32_t> m_initDone;
+};
+
+};
+#endif // !_ISO_BOX_BANK_H
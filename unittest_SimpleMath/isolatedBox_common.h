@@ -16,6 +16,8 @@
 #include <string>
 #include <utility>
 
+#include "isolatedBox_trace.h"
+
 
 // Add Here any GPIO BASE ADDRESS
 // Add here offsets of GPIO registers
@@ -38,6 +40,38 @@ typedef std::chrono::milliseconds timeProcess_t;
 
 typedef uint32_t freq_t;
 
+/// <summary>
+/// Handle of a probe / box name (see isolatedBox_idregistry.h)
+/// </summary>
+typedef uint32_t isoId_t;
+
+constexpr isoId_t ISO_ID_INVALID = 0xFFFFFFFFu;
+
+/// <summary>
+/// Temperature of a box or probe without any measure
+/// </summary>
+constexpr auto ISO_DEF_UNDEF_TEMP = 65535;
+
+/// <summary>
+/// Bound of the set point distances of the target selection: far
+/// beyond any physical temperature, well inside int32_t
+/// </summary>
+constexpr temp_t ISO_DISTANCE_LIMIT = 1.0e6f;
+
+/**
+ * @brief Distance of a sample to a set point truncated toward zero,
+ * as the target selection compares them. Clamped to
+ * ISO_DISTANCE_LIMIT (NaN to its lower bound) so that the int
+ * conversion is always defined; branch free for the batch kernels.
+ */
+inline int32_t isoSetPointDistance(temp_t _temp, temp_t _setPoint)
+{
+    temp_t lDelta = _temp - _setPoint;
+    lDelta = (lDelta > -ISO_DISTANCE_LIMIT) ? lDelta : -ISO_DISTANCE_LIMIT;
+    lDelta = (lDelta < ISO_DISTANCE_LIMIT) ? lDelta : ISO_DISTANCE_LIMIT;
+    return (int32_t)lDelta;
+}
+
 
 enum EquipmentState
 {
@@ -54,7 +88,7 @@ enum EquipmentState
 struct TempStruct
 {
     time_t ts;
-    std::string id;
+    isoId_t id;
     float temp;
 };
 
@@ -79,8 +113,8 @@ enum InputMode_E
 
 struct PidDataStruct
 {
-    std::string name;
-    std::string description;
+    isoId_t name;
+    isoId_t description;
     float kP;
     float kI;
     float kD;
@@ -99,8 +133,9 @@ public:
     {
     }
 
-    temp_t validate(const temp_t _value)
+    temp_t validate(const temp_t _value) const
     {
+        ISO_TRACE_SCOPE("ParameterLimits::validate");
         temp_t returnValue = this->defaultValue;
         if (_value <= this->max && _value >= this->min)
             returnValue = _value;
@@ -113,4 +148,30 @@ private:
     temp_t defaultValue;
 };
 
+/**
+ * @brief Same as ParameterLimits with the interval fixed at compile
+ * time: no storage and the comparisons are constant folded.
+ * Bounds are integers as the ISO_TEMP_xxx defines.
+ *
+ */
+template<int Min, int Max, int Default>
+class StaticParameterLimits
+{
+public:
+    static_assert(Min <= Default && Default <= Max, "default out of the limits");
+
+    static constexpr temp_t validate(const temp_t _value)
+    {
+        return (_value <= Max && _value >= Min) ? _value : (temp_t)Default;
+    }
+
+    /**
+     * @brief The same interval as a run time object
+     */
+    static ParameterLimits runtime()
+    {
+        return ParameterLimits(Min, Max, Default);
+    }
+};
+
 #endif /* _ISO_COMMON_H_ */
\ No newline at end of file
@@ -0,0 +1,51 @@
+/*****************************************************************//**
+ * \file   isolatedBox_config.cpp
+ * \brief: Live configuration of the boxes. Operators publish new set
+ * points and gains from any thread; the control thread picks them up
+ * between two steps, without lock and without waiting for a writer.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_config.h"
+
+
+IsoBoxConfigTable::IsoBoxConfigTable(size_t _numBoxes)
+    : m_numBoxes(_numBoxes),
+      m_buffers(new IsoDoubleBuffer<IsoBoxConfig>[_numBoxes]),
+      m_published(new IsoBoxConfig[_numBoxes]())
+{
+}
+
+void IsoBoxConfigTable::merge(size_t _box, const IsoBoxConfig &_config)
+{
+    IsoBoxConfig &lSnapshot = m_published[_box];
+    if (_config.fields & ISO_CONFIG_SET_POINTS) {
+        lSnapshot.min = _config.min;
+        lSnapshot.max = _config.max;
+    }
+    if (_config.fields & ISO_CONFIG_GAINS) {
+        lSnapshot.kP = _config.kP;
+        lSnapshot.kI = _config.kI;
+        lSnapshot.kD = _config.kD;
+    }
+    lSnapshot.fields |= _config.fields;
+    m_buffers[_box].publish(lSnapshot);
+}
+
+bool IsoBoxConfigTable::publish(size_t _box, const IsoBoxConfig &_config)
+{
+    if (_box >= m_numBoxes)
+        return false;
+
+    std::lock_guard<std::mutex> lLock(m_writeMutex);
+    merge(_box, _config);
+    return true;
+}
+
+void IsoBoxConfigTable::publishAll(const IsoBoxConfig &_config)
+{
+    std::lock_guard<std::mutex> lLock(m_writeMutex);
+    for (size_t i = 0; i < m_numBoxes; i++)
+        merge(i, _config);
+}
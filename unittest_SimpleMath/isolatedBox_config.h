@@ -0,0 +1,177 @@
+/*****************************************************************//**
+ * \file   isolatedBox_config.h
+ * \brief: Live configuration of the boxes. Operators publish new set
+ * points and gains from any thread; the control thread picks them up
+ * between two steps, without lock and without waiting for a writer.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_CONFIG_H_
+#define _ISO_CONFIG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+#include "isolatedBox_common.h"
+
+/**
+ * @brief Parts of an IsoBoxConfig to apply
+ */
+enum IsoConfigFields_E
+{
+    ISO_CONFIG_SET_POINTS = 0x01,   // min / max, as isoBox::init
+    ISO_CONFIG_GAINS = 0x02         // kP / kI / kD, as isoBox::setGains
+};
+
+/**
+ * @brief Configuration of one box
+ */
+struct IsoBoxConfig
+{
+    uint32_t fields;            // IsoConfigFields_E mask
+    temp_t min;
+    temp_t max;
+    temp_t kP;
+    temp_t kI;
+    temp_t kD;
+};
+
+/**
+ * @brief Seqlock over two copies of T. The writer fills the copy
+ * readers are not using, then publishes it: a reader only retries
+ * if two publications happened during its read, never waits for a
+ * writer. Single writer, any number of readers.
+ * T is copied as 64 bit words: it must be trivially copyable.
+ */
+template<class T>
+class IsoDoubleBuffer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "IsoDoubleBuffer needs a trivially copyable type");
+
+public:
+    IsoDoubleBuffer() : m_seq(0)
+    {
+        for (auto &lCopy : m_words)
+            for (auto &lWord : lCopy)
+                lWord.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Publish a new value. Writers must be serialized.
+     */
+    void publish(const T &_value)
+    {
+        uint64_t lWords[WORDS] = {};
+        memcpy(lWords, &_value, sizeof(T));
+
+        /// <summary>
+        /// Odd sequence: version + 1 is being written in the other copy
+        /// </summary>
+        uint64_t lSeq = m_seq.load(std::memory_order_relaxed);
+        uint64_t lNext = lSeq / 2 + 1;
+        m_seq.store(lNext * 2 - 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++)
+            m_words[lNext & 1][i].store(lWords[i], std::memory_order_relaxed);
+        m_seq.store(lNext * 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Number of publications, 0 before the first one
+     */
+    uint64_t getVersion() const { return m_seq.load(std::memory_order_acquire) / 2; }
+
+    /**
+     * @brief Copy the latest published value
+     * @return its version
+     */
+    uint64_t read(T &_value) const
+    {
+        uint64_t lWords[WORDS];
+        for (;;) {
+            uint64_t lSeq = m_seq.load(std::memory_order_acquire);
+            uint64_t lVersion = lSeq / 2;
+            for (size_t i = 0; i < WORDS; i++)
+                lWords[i] = m_words[lVersion & 1][i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            /// <summary>
+            /// The copy read is only rewritten by version + 2
+            /// </summary>
+            if (m_seq.load(std::memory_order_relaxed) < lVersion * 2 + 3) {
+                memcpy(&_value, lWords, sizeof(T));
+                return lVersion;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> m_seq;
+    std::atomic<uint64_t> m_words[2][WORDS];
+};
+
+/**
+ * @brief One IsoDoubleBuffer per box. A publication only replaces
+ * the fields it carries: the snapshot of a box always holds the
+ * latest value of every field published so far, so a control thread
+ * that skipped versions loses nothing.
+ */
+class IsoBoxConfigTable
+{
+public:
+    explicit IsoBoxConfigTable(size_t _numBoxes);
+
+    IsoBoxConfigTable(const IsoBoxConfigTable&) = delete;
+    IsoBoxConfigTable& operator=(const IsoBoxConfigTable&) = delete;
+
+    size_t getNumBoxes() const { return m_numBoxes; }
+
+    /**
+     * @brief Publish the fields of _config for a box. Any thread.
+     * @return false if the box does not exist
+     */
+    bool publish(size_t _box, const IsoBoxConfig &_config);
+
+    /**
+     * @brief Publish the same configuration to every box
+     */
+    void publishAll(const IsoBoxConfig &_config);
+
+    uint64_t getVersion(size_t _box) const { return m_buffers[_box].getVersion(); }
+
+    /**
+     * @brief Control thread side: copy the configuration of a box if
+     * it is newer than _seen, and update _seen. One atomic load when
+     * nothing changed.
+     * @return true if _config was filled
+     */
+    bool fetch(size_t _box, uint64_t &_seen, IsoBoxConfig &_config) const
+    {
+        if (m_buffers[_box].getVersion() == _seen)
+            return false;
+        _seen = m_buffers[_box].read(_config);
+        return true;
+    }
+
+private:
+    size_t m_numBoxes;
+    std::unique_ptr<IsoDoubleBuffer<IsoBoxConfig>[]> m_buffers;
+
+    /// <summary>
+    /// Publications are rare: one lock serializes the writers, which
+    /// merge into their own copy of the snapshots
+    /// </summary>
+    std::mutex m_writeMutex;
+    std::unique_ptr<IsoBoxConfig[]> m_published;
+
+    void merge(size_t _box, const IsoBoxConfig &_config);
+};
+
+#endif /* _ISO_CONFIG_H_ */
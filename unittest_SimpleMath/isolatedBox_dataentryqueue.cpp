@@ -0,0 +1,337 @@
+/*****************************************************************//**
+ * \file   isolatedBox_dataentryqueue.cpp
+ * \brief: Producer / consumer pipeline over the MonitoringDataQueue.
+ * Producers read the probes, consumers run the box compensation.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_dataentryqueue.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+using namespace isoBoxApi;
+
+typedef std::chrono::steady_clock isoDataEntryClock_t;
+
+
+DataEntryParams dataEntryDefaults(size_t _numBoxes)
+{
+    DataEntryParams lParams;
+    lParams.numBoxes = _numBoxes;
+    lParams.numProducers = 1;
+    lParams.numConsumers = 1;
+    lParams.period = timeProcess_t(ISO_SCAN_RATE);
+    lParams.consumerBatch = 64;
+    lParams.pinCores = false;
+    return lParams;
+}
+
+ISO_DataEntryQueue::ISO_DataEntryQueue(MonitoringDataQueue *_queue, IsoProbeSource *_source,
+                                       const DataEntryParams &_params)
+    : m_queue(_queue),
+      m_source(_source),
+      m_params(_params),
+      m_boxes(_params.numBoxes),
+      m_boxHandles(_params.numBoxes, ISO_ID_INVALID),
+      m_lastQueued(_params.numBoxes, 0),
+      m_boxLocks(new BoxLock[ISO_DATA_ENTRY_LOCK_STRIPES]),
+      m_metrics(nullptr),
+      m_pinnedThreads(0)
+{
+    if (m_params.numProducers == 0)
+        m_params.numProducers = 1;
+    if (m_params.numConsumers == 0)
+        m_params.numConsumers = 1;
+    if (m_params.consumerBatch == 0)
+        m_params.consumerBatch = 1;
+
+    m_producerCounters.reset(new StageCounters[m_params.numProducers]);
+    m_consumerCounters.reset(new StageCounters[m_params.numConsumers]);
+    for (unsigned i = 0; i < m_params.numProducers; i++) {
+        m_producerCounters[i].items.store(0);
+        m_producerCounters[i].batches.store(0);
+        m_producerCounters[i].busyNs.store(0);
+        m_producerCounters[i].compensations.store(0);
+        m_producerCounters[i].stale.store(0);
+        m_producerCounters[i].dropped.store(0);
+        m_producerCounters[i].maxQueueDepth.store(0);
+    }
+    for (unsigned i = 0; i < m_params.numConsumers; i++) {
+        m_consumerCounters[i].items.store(0);
+        m_consumerCounters[i].batches.store(0);
+        m_consumerCounters[i].busyNs.store(0);
+        m_consumerCounters[i].compensations.store(0);
+        m_consumerCounters[i].stale.store(0);
+        m_consumerCounters[i].dropped.store(0);
+        m_consumerCounters[i].maxQueueDepth.store(0);
+    }
+}
+
+ISO_DataEntryQueue::~ISO_DataEntryQueue()
+{
+    stop();
+}
+
+void ISO_DataEntryQueue::setFilter(const IsoFilterParams &_params)
+{
+    if (_params.type == ISO_FILTER_NONE)
+        m_filter.reset();
+    else
+        m_filter.reset(new IsoFilterBank(m_boxes.size(), _params));
+}
+
+bool ISO_DataEntryQueue::initBox(size_t _id, temp_t _min, temp_t _max)
+{
+    if (_id >= m_boxes.size())
+        return false;
+    return m_boxes[_id].init(_min, _max);
+}
+
+bool ISO_DataEntryQueue::setBoxHandle(size_t _id, isoId_t _handle)
+{
+    if (_id >= m_boxes.size())
+        return false;
+    m_boxHandles[_id] = _handle;
+    return true;
+}
+
+bool ISO_DataEntryQueue::pinThread(std::thread &_thread, unsigned _core)
+{
+#ifdef __linux__
+    cpu_set_t lSet;
+    CPU_ZERO(&lSet);
+    CPU_SET(_core, &lSet);
+    return pthread_setaffinity_np(_thread.native_handle(), sizeof(lSet), &lSet) == 0;
+#else
+    (void)_thread;
+    (void)_core;
+    return false;
+#endif
+}
+
+bool ISO_DataEntryQueue::start()
+{
+    if (!m_threads.empty())
+        return false;
+
+    m_stopProducers.clear();
+    m_stopConsumers.clear();
+    m_pinnedThreads = 0;
+    m_startTime = isoDataEntryClock_t::now();
+
+    /// <summary>
+    /// The producers restart their stamps: the samples of the previous
+    /// run must not make the new ones stale
+    /// </summary>
+    std::fill(m_lastQueued.begin(), m_lastQueued.end(), 0);
+
+    /// <summary>
+    /// Consumers first so the queue is served as soon as samples arrive
+    /// </summary>
+    unsigned lCores = std::max(1u, std::thread::hardware_concurrency());
+    unsigned lCore = 0;
+    for (unsigned i = 0; i < m_params.numConsumers; i++) {
+        m_threads.emplace_back(&ISO_DataEntryQueue::thread_consumer, this, i);
+        if (m_params.pinCores && pinThread(m_threads.back(), lCore++ % lCores))
+            m_pinnedThreads++;
+    }
+    for (unsigned i = 0; i < m_params.numProducers; i++) {
+        m_threads.emplace_back(&ISO_DataEntryQueue::thread_producer, this, i);
+        if (m_params.pinCores && pinThread(m_threads.back(), lCore++ % lCores))
+            m_pinnedThreads++;
+    }
+    return true;
+}
+
+void ISO_DataEntryQueue::stop()
+{
+    if (m_threads.empty())
+        return;
+
+    /// <summary>
+    /// Producers are the last m_params.numProducers threads
+    /// </summary>
+    m_stopProducers.requestStop();
+    for (size_t i = m_params.numConsumers; i < m_threads.size(); i++)
+        m_threads[i].join();
+
+    m_stopConsumers.requestStop();
+    for (size_t i = 0; i < m_params.numConsumers; i++)
+        m_threads[i].join();
+
+    m_threads.clear();
+    m_stopTime = isoDataEntryClock_t::now();
+}
+
+void ISO_DataEntryQueue::thread_producer(unsigned _index)
+{
+    StageCounters &lCounters = m_producerCounters[_index];
+
+    /// <summary>
+    /// Contiguous probe range of this producer
+    /// </summary>
+    size_t lNumBoxes = m_boxes.size();
+    size_t lFirst = (lNumBoxes * _index) / m_params.numProducers;
+    size_t lCount = (lNumBoxes * (_index + 1)) / m_params.numProducers - lFirst;
+
+    std::vector<temp_t> lTemps(lCount);
+    std::vector<MonitoringTemp> lBatch(lCount);
+    isoDataEntryClock_t::time_point lNext = isoDataEntryClock_t::now();
+    int64_t lLastTs = 0;
+
+    while (!m_stopProducers.stopRequested()) {
+        isoDataEntryClock_t::time_point lBegin = isoDataEntryClock_t::now();
+
+        size_t lRead = (lCount > 0) ? m_source->read((uint32_t)lFirst, lCount, lTemps.data()) : 0;
+        if (m_filter)
+            m_filter->update(lTemps.data(), lTemps.data(), lFirst, lRead);
+        /// <summary>
+        /// Strictly increasing per producer, whatever the clock
+        /// resolution: the consumers order the samples of a box on it
+        /// </summary>
+        int64_t lTs = std::max(monitoringNow(), lLastTs + 1);
+        lLastTs = lTs;
+        for (size_t i = 0; i < lRead; i++)
+            lBatch[i] = makeMonitoringTemp(lTs, m_boxHandles[lFirst + i], lTemps[i], CELSIUS,
+                                           (uint32_t)(lFirst + i));
+        /// <summary>
+        /// The ring queue refuses what does not fit: that shortfall
+        /// is where the consumers saturate
+        /// </summary>
+        size_t lQueued = m_queue->push_range(lBatch.begin(), lBatch.begin() + lRead);
+
+        int lDepth = m_queue->size();
+        if (lDepth > lCounters.maxQueueDepth.load(std::memory_order_relaxed))
+            lCounters.maxQueueDepth.store(lDepth, std::memory_order_relaxed);
+
+        isoDataEntryClock_t::time_point lEnd = isoDataEntryClock_t::now();
+        addCounter(lCounters.items, lQueued);
+        addCounter(lCounters.dropped, lRead - lQueued);
+        addCounter(lCounters.batches, 1);
+        addCounter(lCounters.busyNs, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            lEnd - lBegin).count());
+
+        /// <summary>
+        /// Fixed rate. A producer running late restarts from now
+        /// instead of bursting to catch up.
+        /// </summary>
+        if (m_params.period.count() == 0)
+            continue;
+        lNext += m_params.period;
+        if (lNext < lEnd)
+            lNext = lEnd;
+        std::this_thread::sleep_until(lNext);
+    }
+}
+
+void ISO_DataEntryQueue::thread_consumer(unsigned _index)
+{
+    StageCounters &lCounters = m_consumerCounters[_index];
+    IsoMetricsShard *lMetrics = (m_metrics != nullptr) ? m_metrics->registerThread() : nullptr;
+    std::vector<MonitoringTemp> lBatch;
+    lBatch.reserve(m_params.consumerBatch);
+
+    timeProcess_t lTimeout = m_params.period.count() > 0 ? m_params.period
+                                                         : timeProcess_t(ISO_SCAN_RATE);
+    for (;;) {
+        /// <summary>
+        /// Wait for the first sample, take the rest of the batch
+        /// without waiting. Exit only once the producers are stopped
+        /// and the queue is empty.
+        /// </summary>
+        MonitoringTemp lSample;
+        if (!m_queue->pop_for(lSample, lTimeout)) {
+            if (m_stopConsumers.stopRequested())
+                break;
+            continue;
+        }
+
+        isoDataEntryClock_t::time_point lBegin = isoDataEntryClock_t::now();
+        lBatch.clear();
+        lBatch.push_back(lSample);
+        m_queue->drain_into(lBatch, m_params.consumerBatch - 1);
+
+        /// <summary>
+        /// Dwell from the steady nanosecond stamp taken at push
+        /// </summary>
+        if (lMetrics != nullptr) {
+            int64_t lNow = monitoringNow();
+            lMetrics->count(METRIC_QUEUE_SAMPLES, lBatch.size());
+            for (const MonitoringTemp &lTemp : lBatch) {
+                if (lTemp.ts > 0)
+                    lMetrics->record(METRIC_QUEUE_DWELL_NS,
+                                     lNow > lTemp.ts ? (uint64_t)(lNow - lTemp.ts) : 0);
+            }
+        }
+
+        /// <summary>
+        /// A probe never read (ISO_PROBE_UNREAD) is ISO_DEF_UNDEF_TEMP:
+        /// it must not reach the controller of its box.
+        /// Two consumers can take two samples of a box and apply them
+        /// in any order: a sample older than the last one applied is
+        /// dropped instead of moving the box back in time.
+        /// </summary>
+        uint64_t lCompensations = 0;
+        uint64_t lStale = 0;
+        for (const MonitoringTemp &lTemp : lBatch) {
+            if (lTemp.box >= m_boxes.size() || lTemp.value == ISO_DEF_UNDEF_TEMP)
+                continue;
+            std::lock_guard<std::mutex> lLock(m_boxLocks[lTemp.box % ISO_DATA_ENTRY_LOCK_STRIPES].mutex);
+            if (lTemp.ts > 0) {
+                if (lTemp.ts <= m_lastQueued[lTemp.box]) {
+                    lStale++;
+                    continue;
+                }
+                m_lastQueued[lTemp.box] = lTemp.ts;
+            }
+            temp_t lTarget = (lMetrics != nullptr)
+                ? applyCompensationMeasured(m_boxes[lTemp.box], lTemp.value, lTemp.box, *m_metrics, *lMetrics)
+                : m_boxes[lTemp.box].applyCompensation(lTemp.value);
+            if (lTarget != ISO_DEF_UNDEF_TEMP)
+                lCompensations++;
+        }
+
+        addCounter(lCounters.items, lBatch.size());
+        addCounter(lCounters.batches, 1);
+        addCounter(lCounters.compensations, lCompensations);
+        addCounter(lCounters.stale, lStale);
+        addCounter(lCounters.busyNs, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            isoDataEntryClock_t::now() - lBegin).count());
+    }
+}
+
+DataEntryStats ISO_DataEntryQueue::getStats() const
+{
+    DataEntryStats lStats = {};
+    uint64_t lBusyNs = 0;
+    for (unsigned i = 0; i < m_params.numProducers; i++) {
+        lStats.producer.items += m_producerCounters[i].items.load(std::memory_order_relaxed);
+        lStats.producer.batches += m_producerCounters[i].batches.load(std::memory_order_relaxed);
+        lStats.droppedSamples += m_producerCounters[i].dropped.load(std::memory_order_relaxed);
+        lBusyNs += m_producerCounters[i].busyNs.load(std::memory_order_relaxed);
+        lStats.maxQueueDepth = std::max(lStats.maxQueueDepth,
+                                        m_producerCounters[i].maxQueueDepth.load(std::memory_order_relaxed));
+    }
+    lStats.producer.busySeconds = lBusyNs * 1e-9;
+
+    lBusyNs = 0;
+    for (unsigned i = 0; i < m_params.numConsumers; i++) {
+        lStats.consumer.items += m_consumerCounters[i].items.load(std::memory_order_relaxed);
+        lStats.consumer.batches += m_consumerCounters[i].batches.load(std::memory_order_relaxed);
+        lStats.compensations += m_consumerCounters[i].compensations.load(std::memory_order_relaxed);
+        lStats.staleSamples += m_consumerCounters[i].stale.load(std::memory_order_relaxed);
+        lBusyNs += m_consumerCounters[i].busyNs.load(std::memory_order_relaxed);
+    }
+    lStats.consumer.busySeconds = lBusyNs * 1e-9;
+
+    isoDataEntryClock_t::time_point lEnd = isRunning() ? isoDataEntryClock_t::now() : m_stopTime;
+    if (lEnd > m_startTime)
+        lStats.wallSeconds = std::chrono::duration<double>(lEnd - m_startTime).count();
+    lStats.pinnedThreads = m_pinnedThreads;
+    return lStats;
+}
@@ -0,0 +1,226 @@
+/*****************************************************************//**
+ * \file   isolatedBox_dataentryqueue.h
+ * \brief: Producer / consumer pipeline over the MonitoringDataQueue.
+ * Producers read the probes, consumers run the box compensation.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_DATA_ENTRY_QUEUE_H_
+#define _ISO_DATA_ENTRY_QUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "isolatedBoxCmake.h"
+#include "isolatedBox_probe.h"
+#include "isolatedBox_filter.h"
+#include "isolatedBox_metrics.h"
+#include "MonitoringTemp.h"
+
+/**
+ * @brief Pipeline configuration
+ */
+struct DataEntryParams
+{
+    size_t numBoxes;
+    unsigned numProducers;      // Probe ranges are split between producers
+    unsigned numConsumers;
+    timeProcess_t period;       // Producer scan period, 0 to run flat out
+    size_t consumerBatch;       // Samples taken from the queue at once
+    bool pinCores;              // Pin every thread to its own core (Linux only)
+};
+
+/**
+ * @brief Default configuration: one producer and one consumer
+ * at ISO_SCAN_RATE
+ */
+DataEntryParams dataEntryDefaults(size_t _numBoxes);
+
+/**
+ * @brief Throughput of one stage of the pipeline
+ */
+struct DataEntryStageStats
+{
+    uint64_t items;             // Samples queued (producers) or processed (consumers)
+    uint64_t batches;           // Probe reads or queue drains
+    double busySeconds;         // Time spent working, summed over the threads
+};
+
+/**
+ * @brief Pipeline counters. A stage whose busySeconds gets close to
+ * wallSeconds * threads is the one that saturates; a growing
+ * maxQueueDepth means consumers do not keep up.
+ */
+struct DataEntryStats
+{
+    DataEntryStageStats producer;
+    DataEntryStageStats consumer;
+    uint64_t compensations;     // Samples that gave a valid target point
+    uint64_t staleSamples;      // Samples dropped: a newer one of their box was applied first
+    uint64_t droppedSamples;    // Samples read but refused by a full queue
+    int maxQueueDepth;
+    double wallSeconds;
+    unsigned pinnedThreads;
+};
+
+/**
+ * @brief Cooperative stop request, one per pipeline stage
+ */
+class ISO_StopToken
+{
+public:
+    ISO_StopToken() : m_stop(false) {}
+
+    void requestStop() { m_stop.store(true, std::memory_order_release); }
+
+    void clear() { m_stop.store(false, std::memory_order_relaxed); }
+
+    bool stopRequested() const { return m_stop.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<bool> m_stop;
+};
+
+class ISO_DataEntryQueue
+{
+public:
+    /**
+     * @brief The pipeline owns the boxes, the queue and the probe
+     * source are shared and must outlive it
+     */
+    ISO_DataEntryQueue(MonitoringDataQueue *_queue, IsoProbeSource *_source,
+                       const DataEntryParams &_params);
+
+    /**
+     * @brief Destructor: stops the threads
+     */
+    ~ISO_DataEntryQueue();
+
+    ISO_DataEntryQueue(const ISO_DataEntryQueue&) = delete;
+    ISO_DataEntryQueue& operator=(const ISO_DataEntryQueue&) = delete;
+
+    size_t getNumBoxes() const { return m_boxes.size(); }
+
+    /**
+     * @brief Configure a box. To be done before start()
+     */
+    bool initBox(size_t _id, temp_t _min, temp_t _max);
+
+    /**
+     * @brief Registry handle carried by the samples of a box, for the
+     * sinks to name them. ISO_ID_INVALID by default. To be done
+     * before start()
+     */
+    bool setBoxHandle(size_t _id, isoId_t _handle);
+
+    /**
+     * @brief Access a box. Not synchronized with the consumers:
+     * read it after stop()
+     */
+    isoBoxApi::isoBox &getBox(size_t _id) { return m_boxes[_id]; }
+
+    /**
+     * @brief Record queue dwell time and compensations in _metrics.
+     * Each consumer registers its own shard. Call before start().
+     */
+    void setMetrics(IsoMetrics *_metrics) { m_metrics = _metrics; }
+
+    /**
+    * @brief Filter the samples of every probe in the producers, one
+    * batch per read, before they are queued. ISO_FILTER_NONE
+    * removes the filter. Call before start().
+    */
+    void setFilter(const IsoFilterParams &_params);
+
+    /**
+     * @brief Start the producer and consumer threads
+     * @return false if already running
+     */
+    bool start();
+
+    /**
+     * @brief Stop the producers, let the consumers drain the queue,
+     * then stop them. Blocks until every thread has exited.
+     */
+    void stop();
+
+    bool isRunning() const { return !m_threads.empty(); }
+
+    /**
+     * @brief Body of producer thread _index
+     */
+    void thread_producer(unsigned _index);
+
+    /**
+     * @brief Body of consumer thread _index
+     */
+    void thread_consumer(unsigned _index);
+
+    DataEntryStats getStats() const;
+
+private:
+    /**
+     * @brief Per thread counters, on their own cache line
+     */
+    struct StageCounters
+    {
+        std::atomic<uint64_t> items;
+        std::atomic<uint64_t> batches;
+        std::atomic<uint64_t> busyNs;
+        std::atomic<uint64_t> compensations;
+        std::atomic<uint64_t> stale;
+        std::atomic<uint64_t> dropped;
+        std::atomic<int> maxQueueDepth;
+        char padding[64];
+    };
+
+    /**
+     * @brief Consumers share the boxes: one lock per stripe of boxes
+     * instead of one per box or a global one
+     */
+    struct BoxLock
+    {
+        std::mutex mutex;
+        char padding[64];
+    };
+
+    static constexpr size_t ISO_DATA_ENTRY_LOCK_STRIPES = 64;
+
+    static void addCounter(std::atomic<uint64_t> &_counter, uint64_t _value)
+    {
+        _counter.store(_counter.load(std::memory_order_relaxed) + _value,
+                       std::memory_order_relaxed);
+    }
+
+    bool pinThread(std::thread &_thread, unsigned _core);
+
+    MonitoringDataQueue *m_queue;
+    IsoProbeSource *m_source;
+    DataEntryParams m_params;
+
+    std::vector<isoBoxApi::isoBox> m_boxes;
+    std::vector<isoId_t> m_boxHandles;
+    std::vector<int64_t> m_lastQueued;      // ts of the last sample applied, under the box lock
+    std::unique_ptr<BoxLock[]> m_boxLocks;
+
+    std::unique_ptr<StageCounters[]> m_producerCounters;
+    std::unique_ptr<StageCounters[]> m_consumerCounters;
+
+    IsoMetrics *m_metrics;
+    std::unique_ptr<IsoFilterBank> m_filter;
+
+    ISO_StopToken m_stopProducers;
+    ISO_StopToken m_stopConsumers;
+
+    std::vector<std::thread> m_threads;
+    unsigned m_pinnedThreads;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_stopTime;
+};
+
+#endif /* _ISO_DATA_ENTRY_QUEUE_H_ */
@@ -0,0 +1,360 @@
+/*****************************************************************//**
+ * \file   isolatedBox_exporter.cpp
+ * \brief: OpenMetrics text exporter of the box metrics, served over
+ * a loopback TCP or a Unix domain socket
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_exporter.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef MSG_NOSIGNAL
+constexpr auto ISO_EXPORTER_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr auto ISO_EXPORTER_SEND_FLAGS = 0;
+#endif
+
+
+static const char *s_counterNames[ISO_METRICS_NUM_COUNTERS] = {
+    "iso_compensations",
+    "iso_out_of_range",
+    "iso_target_switches",
+    "iso_actuator_writes",
+    "iso_queue_samples",
+    "iso_switches_avoided",
+    "iso_restarts_avoided",
+};
+
+static const char *s_counterHelp[ISO_METRICS_NUM_COUNTERS] = {
+    "Compensation steps run",
+    "Compensation steps with the temperature out of range",
+    "Target set point changes",
+    "PWM channels written",
+    "Samples taken from the monitoring queue",
+    "Target switches refused by the hysteresis or the dwell time",
+    "Out of range samples held by the deadband",
+};
+
+static const char *s_latencyNames[ISO_METRICS_NUM_LATENCIES] = {
+    "iso_compensation_seconds",
+    "iso_actuator_write_seconds",
+    "iso_queue_dwell_seconds",
+};
+
+static const char *s_latencyHelp[ISO_METRICS_NUM_LATENCIES] = {
+    "Duration of a compensation step",
+    "Duration of a PWM batch flush",
+    "Time a sample waited in the monitoring queue",
+};
+
+/// <summary>
+/// snprintf to the end of _out, no temporary string
+/// </summary>
+static void appendFormat(std::string &_out, const char *_format, ...)
+{
+    char lLine[192];
+    va_list lArgs;
+    va_start(lArgs, _format);
+    int lLength = vsnprintf(lLine, sizeof(lLine), _format, lArgs);
+    va_end(lArgs);
+    if (lLength > 0)
+        _out.append(lLine, (size_t)lLength < sizeof(lLine) ? (size_t)lLength : sizeof(lLine) - 1);
+}
+
+static void appendBoxCounter(std::string &_out, const char *_name, const char *_help,
+                             const std::vector<uint64_t> &_values)
+{
+    appendFormat(_out, "# TYPE %s counter\n# HELP %s %s\n", _name, _name, _help);
+    for (size_t i = 0; i < _values.size(); i++)
+        appendFormat(_out, "%s_total{box=\"%zu\"} %llu\n", _name, i, (unsigned long long)_values[i]);
+}
+
+void formatOpenMetrics(const IsoMetricsSnapshot &_snapshot, std::string &_out)
+{
+    _out.clear();
+
+    for (unsigned c = 0; c < ISO_METRICS_NUM_COUNTERS; c++) {
+        appendFormat(_out, "# TYPE %s counter\n# HELP %s %s\n", s_counterNames[c], s_counterNames[c],
+                     s_counterHelp[c]);
+        appendFormat(_out, "%s_total %llu\n", s_counterNames[c],
+                     (unsigned long long)_snapshot.counters[c]);
+    }
+
+    /// <summary>
+    /// Buckets are cumulative. The bound of a bucket is the lowest
+    /// value of the next one; the last bucket only feeds +Inf.
+    /// </summary>
+    for (unsigned l = 0; l < ISO_METRICS_NUM_LATENCIES; l++) {
+        const IsoHistogramSnapshot &lHist = _snapshot.latencies[l];
+        const char *lName = s_latencyNames[l];
+        appendFormat(_out, "# TYPE %s histogram\n# UNIT %s seconds\n# HELP %s %s\n", lName, lName,
+                     lName, s_latencyHelp[l]);
+
+        uint64_t lCumulative = 0;
+        for (unsigned b = 0; b + 1 < ISO_METRICS_HIST_BUCKETS; b++) {
+            if (lHist.buckets[b] == 0)
+                continue;
+            lCumulative += lHist.buckets[b];
+            appendFormat(_out, "%s_bucket{le=\"%.9g\"} %llu\n", lName,
+                         (double)isoMetricsBucketValue(b + 1) * 1e-9, (unsigned long long)lCumulative);
+        }
+        lCumulative += lHist.buckets[ISO_METRICS_HIST_BUCKETS - 1];
+        appendFormat(_out, "%s_bucket{le=\"+Inf\"} %llu\n", lName, (unsigned long long)lCumulative);
+        appendFormat(_out, "%s_count %llu\n", lName, (unsigned long long)lCumulative);
+        appendFormat(_out, "%s_sum %.9f\n", lName, (double)lHist.sum * 1e-9);
+    }
+
+    appendBoxCounter(_out, "iso_box_out_of_range", "Compensation steps out of range, per box",
+                     _snapshot.boxOutOfRange);
+    appendBoxCounter(_out, "iso_box_target_switches", "Target set point changes, per box",
+                     _snapshot.boxTargetSwitches);
+
+    _out.append("# EOF\n");
+}
+
+IsoMetricsExporter::IsoMetricsExporter(const IsoMetrics *_metrics)
+    : m_metrics(_metrics),
+      m_socket(-1),
+      m_port(0),
+      m_stop(false),
+      m_scrapes(0)
+{
+    m_body.reserve(ISO_EXPORTER_RESERVE);
+}
+
+IsoMetricsExporter::~IsoMetricsExporter()
+{
+    stop();
+}
+
+#ifdef _WIN32
+
+/// <summary>
+/// No socket server on Windows: the text format is still available
+/// through formatOpenMetrics
+/// </summary>
+bool IsoMetricsExporter::startTcp(uint16_t _port)
+{
+    (void)_port;
+    return false;
+}
+
+bool IsoMetricsExporter::startUnix(const std::string &_path)
+{
+    (void)_path;
+    return false;
+}
+
+void IsoMetricsExporter::stop()
+{
+}
+
+bool IsoMetricsExporter::run(int _socket)
+{
+    (void)_socket;
+    return false;
+}
+
+void IsoMetricsExporter::thread_server()
+{
+}
+
+void IsoMetricsExporter::serve(int _client)
+{
+    (void)_client;
+}
+
+#else
+
+bool IsoMetricsExporter::startTcp(uint16_t _port)
+{
+    if (isRunning())
+        return false;
+
+    int lSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (lSocket < 0)
+        return false;
+
+    int lReuse = 1;
+    setsockopt(lSocket, SOL_SOCKET, SO_REUSEADDR, &lReuse, sizeof(lReuse));
+
+    sockaddr_in lAddress;
+    memset(&lAddress, 0, sizeof(lAddress));
+    lAddress.sin_family = AF_INET;
+    lAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    lAddress.sin_port = htons(_port);
+    socklen_t lLength = sizeof(lAddress);
+    if (bind(lSocket, (sockaddr *)&lAddress, sizeof(lAddress)) != 0 ||
+        getsockname(lSocket, (sockaddr *)&lAddress, &lLength) != 0) {
+        ::close(lSocket);
+        return false;
+    }
+
+    m_port = ntohs(lAddress.sin_port);
+    return run(lSocket);
+}
+
+bool IsoMetricsExporter::startUnix(const std::string &_path)
+{
+    if (isRunning())
+        return false;
+
+    sockaddr_un lAddress;
+    memset(&lAddress, 0, sizeof(lAddress));
+    if (_path.empty() || _path.size() >= sizeof(lAddress.sun_path))
+        return false;
+    lAddress.sun_family = AF_UNIX;
+    memcpy(lAddress.sun_path, _path.c_str(), _path.size());
+
+    int lSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lSocket < 0)
+        return false;
+
+    unlink(_path.c_str());
+    if (bind(lSocket, (sockaddr *)&lAddress, sizeof(lAddress)) != 0) {
+        ::close(lSocket);
+        return false;
+    }
+
+    m_unixPath = _path;
+    m_port = 0;
+    return run(lSocket);
+}
+
+bool IsoMetricsExporter::run(int _socket)
+{
+    if (listen(_socket, 8) != 0) {
+        ::close(_socket);
+        if (!m_unixPath.empty())
+            unlink(m_unixPath.c_str());
+        m_unixPath.clear();
+        m_port = 0;
+        return false;
+    }
+
+    m_socket = _socket;
+    m_stop.store(false);
+    m_thread = std::thread(&IsoMetricsExporter::thread_server, this);
+    return true;
+}
+
+void IsoMetricsExporter::stop()
+{
+    if (!isRunning())
+        return;
+
+    m_stop.store(true);
+    m_thread.join();
+
+    ::close(m_socket);
+    m_socket = -1;
+    if (!m_unixPath.empty())
+        unlink(m_unixPath.c_str());
+    m_unixPath.clear();
+    m_port = 0;
+}
+
+void IsoMetricsExporter::thread_server()
+{
+    /// <summary>
+    /// Scrapes only get the CPU the control threads leave idle
+    /// </summary>
+#ifdef SCHED_IDLE
+    sched_param lParam;
+    memset(&lParam, 0, sizeof(lParam));
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &lParam);
+#endif
+
+    while (!m_stop.load()) {
+        pollfd lPoll;
+        lPoll.fd = m_socket;
+        lPoll.events = POLLIN;
+        lPoll.revents = 0;
+        if (poll(&lPoll, 1, ISO_EXPORTER_POLL_MS) <= 0)
+            continue;
+
+        int lClient = accept(m_socket, nullptr, nullptr);
+        if (lClient < 0)
+            continue;
+        serve(lClient);
+        ::close(lClient);
+    }
+}
+
+void IsoMetricsExporter::serve(int _client)
+{
+    /// <summary>
+    /// A stuck client must not hold the server: bounded waits
+    /// </summary>
+    timeval lTimeout;
+    lTimeout.tv_sec = 1;
+    lTimeout.tv_usec = 0;
+    setsockopt(_client, SOL_SOCKET, SO_RCVTIMEO, &lTimeout, sizeof(lTimeout));
+    setsockopt(_client, SOL_SOCKET, SO_SNDTIMEO, &lTimeout, sizeof(lTimeout));
+
+    /// <summary>
+    /// Read the request head, only the method matters
+    /// </summary>
+    char lRequest[1024];
+    size_t lReceived = 0;
+    while (lReceived < sizeof(lRequest) - 1) {
+        ssize_t lRead = recv(_client, lRequest + lReceived, sizeof(lRequest) - 1 - lReceived, 0);
+        if (lRead <= 0)
+            break;
+        lReceived += (size_t)lRead;
+        lRequest[lReceived] = '\0';
+        if (strstr(lRequest, "\r\n\r\n") != nullptr || strstr(lRequest, "\n\n") != nullptr)
+            break;
+    }
+    lRequest[lReceived] = '\0';
+
+    char lHead[256];
+    int lHeadLength;
+    if (strncmp(lRequest, "GET ", 4) == 0) {
+        m_metrics->snapshot(m_snapshot);
+        formatOpenMetrics(m_snapshot, m_body);
+        lHeadLength = snprintf(lHead, sizeof(lHead),
+                               "HTTP/1.0 200 OK\r\n"
+                               "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                               "Content-Length: %zu\r\n"
+                               "Connection: close\r\n\r\n", m_body.size());
+    }
+    else {
+        m_body.clear();
+        lHeadLength = snprintf(lHead, sizeof(lHead),
+                               "HTTP/1.0 405 Method Not Allowed\r\n"
+                               "Content-Length: 0\r\n"
+                               "Connection: close\r\n\r\n");
+    }
+
+    const char *lParts[2] = { lHead, m_body.data() };
+    size_t lSizes[2] = { (size_t)lHeadLength, m_body.size() };
+    for (int p = 0; p < 2; p++) {
+        size_t lSent = 0;
+        while (lSent < lSizes[p]) {
+            ssize_t lWritten = send(_client, lParts[p] + lSent, lSizes[p] - lSent, ISO_EXPORTER_SEND_FLAGS);
+            if (lWritten <= 0)
+                return;
+            lSent += (size_t)lWritten;
+        }
+    }
+    m_scrapes.fetch_add(1, std::memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*****************************************************************//**
+ * \file   isolatedBox_exporter.h
+ * \brief: OpenMetrics text exporter of the box metrics, served over
+ * a loopback TCP or a Unix domain socket
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_EXPORTER_H_
+#define _ISO_EXPORTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "isolatedBox_metrics.h"
+
+/// <summary>
+/// Accept loop wake up period: bounds the time stop() waits
+/// </summary>
+constexpr auto ISO_EXPORTER_POLL_MS = 100;
+constexpr auto ISO_EXPORTER_RESERVE = 64 * 1024;
+
+/**
+ * @brief Write _snapshot in the OpenMetrics text format. _out is
+ * cleared, not shrunk: reusing it keeps its capacity between scrapes.
+ * Latencies are exported in seconds, only the non empty buckets.
+ */
+void formatOpenMetrics(const IsoMetricsSnapshot &_snapshot, std::string &_out);
+
+/**
+ * @brief Scrape endpoint. One thread at the lowest scheduling
+ * priority serves the requests one at a time: each answer is a new
+ * snapshot of the metrics. The control threads are never waited on.
+ */
+class IsoMetricsExporter
+{
+public:
+    explicit IsoMetricsExporter(const IsoMetrics *_metrics);
+
+    /**
+     * @brief Destructor: stops the server
+     */
+    ~IsoMetricsExporter();
+
+    IsoMetricsExporter(const IsoMetricsExporter&) = delete;
+    IsoMetricsExporter& operator=(const IsoMetricsExporter&) = delete;
+
+    /**
+     * @brief Listen on 127.0.0.1:_port, 0 for any free port
+     * @return false if already running or the socket cannot be bound
+     */
+    bool startTcp(uint16_t _port);
+
+    /**
+     * @brief Listen on the Unix domain socket _path. An existing
+     * file at _path is replaced.
+     */
+    bool startUnix(const std::string &_path);
+
+    /**
+     * @brief Stop the server thread and close the socket
+     */
+    void stop();
+
+    bool isRunning() const { return m_thread.joinable(); }
+
+    /**
+     * @brief Bound TCP port, 0 when not listening on TCP
+     */
+    uint16_t getPort() const { return m_port; }
+
+    /**
+     * @brief Requests answered since construction
+     */
+    uint64_t getScrapes() const { return m_scrapes.load(std::memory_order_relaxed); }
+
+private:
+    bool run(int _socket);
+
+    void thread_server();
+
+    void serve(int _client);
+
+    const IsoMetrics *m_metrics;
+    int m_socket;
+    uint16_t m_port;
+    std::string m_unixPath;
+    std::atomic<bool> m_stop;
+    std::atomic<uint64_t> m_scrapes;
+    std::thread m_thread;
+
+    /// <summary>
+    /// Owned by the server thread, kept between scrapes
+    /// </summary>
+    IsoMetricsSnapshot m_snapshot;
+    std::string m_body;
+};
+
+#endif /* _ISO_EXPORTER_H_ */
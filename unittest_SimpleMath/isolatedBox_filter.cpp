@@ -0,0 +1,217 @@
+/*****************************************************************//**
+ * \file   isolatedBox_filter.cpp
+ * \brief: Streaming filters of the probe samples (sliding median,
+ * exponential moving average, 1-D Kalman)
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+IsoFilterParams isoFilterDefaults(IsoFilterType_E _type)
+{
+    /// <summary>
+    /// Tuned for a probe with about 0.5 degree of noise sampled
+    /// every ISO_SCAN_RATE
+    /// </summary>
+    IsoFilterParams lParams;
+    lParams.type = _type;
+    lParams.window = 5;
+    lParams.alpha = 0.2f;
+    lParams.q = 0.01f;
+    lParams.r = 0.25f;
+    return lParams;
+}
+
+static IsoFilterParams clampParams(const IsoFilterParams &_params)
+{
+    IsoFilterParams lParams = _params;
+    if (lParams.window < 1)
+        lParams.window = 1;
+    if (lParams.window > ISO_FILTER_MEDIAN_MAX)
+        lParams.window = ISO_FILTER_MEDIAN_MAX;
+    if (!(lParams.alpha > 0.0f && lParams.alpha <= 1.0f))
+        lParams.alpha = 1.0f;
+    if (!(lParams.q >= 0.0f))
+        lParams.q = 0.0f;
+    if (!(lParams.r > 0.0f))
+        lParams.r = 1e-6f;
+    return lParams;
+}
+
+static inline bool isMeasure(temp_t _sample)
+{
+    return std::isfinite(_sample) && _sample != ISO_FILTER_UNDEF;
+}
+
+/// <summary>
+/// One step of each filter, shared by the single stream and the bank.
+/// The first sample of a stream passes as it is and seeds the state.
+/// A sample that is not a measure leaves the state as it is and is
+/// returned unchanged (selects: the bank loops stay branch free).
+/// </summary>
+static inline temp_t emaStep(temp_t &_value, uint8_t _primed, temp_t _alpha, temp_t _sample, bool _valid)
+{
+    temp_t lValue = _primed ? _value + _alpha * (_sample - _value) : _sample;
+    _value = _valid ? lValue : _value;
+    return _valid ? lValue : _sample;
+}
+
+static inline temp_t kalmanStep(temp_t &_value, temp_t &_variance, uint8_t _primed, temp_t _q, temp_t _r,
+                                temp_t _sample, bool _valid)
+{
+    temp_t lPredicted = _primed ? _variance + _q : _r;
+    temp_t lGain = _primed ? lPredicted / (lPredicted + _r) : 1.0f;
+    temp_t lValue = _primed ? _value + lGain * (_sample - _value) : _sample;
+    _value = _valid ? lValue : _value;
+    _variance = _valid ? (_primed ? (1.0f - lGain) * lPredicted : _r) : _variance;
+    return _valid ? lValue : _sample;
+}
+
+static temp_t medianStep(temp_t *_window, uint8_t &_next, uint8_t &_count, uint32_t _size, temp_t _sample)
+{
+    _window[_next] = _sample;
+    _next = (uint8_t)((_next + 1u) % _size);
+    if (_count < _size)
+        _count++;
+
+    /// <summary>
+    /// At most ISO_FILTER_MEDIAN_MAX values: insertion sort of a copy
+    /// </summary>
+    temp_t lSorted[ISO_FILTER_MEDIAN_MAX];
+    for (unsigned i = 0; i < _count; i++) {
+        temp_t lValue = _window[i];
+        unsigned j = i;
+        for (; j > 0 && lSorted[j - 1] > lValue; j--)
+            lSorted[j] = lSorted[j - 1];
+        lSorted[j] = lValue;
+    }
+    return lSorted[(_count - 1u) / 2u];
+}
+
+
+IsoSampleFilter::IsoSampleFilter()
+    : m_params(isoFilterDefaults(ISO_FILTER_NONE)),
+      m_value(0),
+      m_variance(0),
+      m_next(0),
+      m_count(0),
+      m_primed(false)
+{
+}
+
+void IsoSampleFilter::setParams(const IsoFilterParams &_params)
+{
+    m_params = clampParams(_params);
+    reset();
+}
+
+void IsoSampleFilter::reset()
+{
+    m_value = 0;
+    m_variance = 0;
+    m_next = 0;
+    m_count = 0;
+    m_primed = false;
+}
+
+temp_t IsoSampleFilter::update(temp_t _sample)
+{
+    if (!isMeasure(_sample))
+        return _sample;
+
+    temp_t lRetVal = _sample;
+    switch (m_params.type) {
+    case ISO_FILTER_MEDIAN:
+        lRetVal = medianStep(m_window, m_next, m_count, m_params.window, _sample);
+        break;
+    case ISO_FILTER_EMA:
+        lRetVal = emaStep(m_value, m_primed, m_params.alpha, _sample, true);
+        break;
+    case ISO_FILTER_KALMAN:
+        lRetVal = kalmanStep(m_value, m_variance, m_primed, m_params.q, m_params.r, _sample, true);
+        break;
+    case ISO_FILTER_NONE:
+    default:
+        break;
+    }
+    m_primed = true;
+    return lRetVal;
+}
+
+
+IsoFilterBank::IsoFilterBank(size_t _numBoxes, const IsoFilterParams &_params)
+    : m_params(clampParams(_params)),
+      m_value(_numBoxes),
+      m_variance(_numBoxes),
+      m_primed(_numBoxes),
+      m_window((m_params.type == ISO_FILTER_MEDIAN) ? _numBoxes * m_params.window : 0),
+      m_next((m_params.type == ISO_FILTER_MEDIAN) ? _numBoxes : 0),
+      m_count((m_params.type == ISO_FILTER_MEDIAN) ? _numBoxes : 0)
+{
+    reset();
+}
+
+void IsoFilterBank::reset()
+{
+    std::fill(m_value.begin(), m_value.end(), 0.0f);
+    std::fill(m_variance.begin(), m_variance.end(), 0.0f);
+    std::fill(m_primed.begin(), m_primed.end(), 0);
+    std::fill(m_next.begin(), m_next.end(), 0);
+    std::fill(m_count.begin(), m_count.end(), 0);
+}
+
+void IsoFilterBank::update(const temp_t *_in, temp_t *_out, size_t _first, size_t _count)
+{
+    if (_first >= size())
+        return;
+    if (_count > size() - _first)
+        _count = size() - _first;
+
+    /// <summary>
+    /// One loop per type, the type test out of it: EMA and Kalman
+    /// loops are branch free (selects) and vectorize
+    /// </summary>
+    temp_t *lValue = m_value.data() + _first;
+    temp_t *lVariance = m_variance.data() + _first;
+    uint8_t *lPrimed = m_primed.data() + _first;
+    switch (m_params.type) {
+    case ISO_FILTER_MEDIAN: {
+        const uint32_t lSize = m_params.window;
+        for (size_t i = 0; i < _count; i++) {
+            size_t lBox = _first + i;
+            _out[i] = isMeasure(_in[i]) ? medianStep(&m_window[lBox * lSize], m_next[lBox], m_count[lBox], lSize, _in[i])
+                                        : _in[i];
+        }
+        break;
+    }
+    case ISO_FILTER_EMA: {
+        const temp_t lAlpha = m_params.alpha;
+        for (size_t i = 0; i < _count; i++) {
+            bool lValid = isMeasure(_in[i]);
+            _out[i] = emaStep(lValue[i], lPrimed[i], lAlpha, _in[i], lValid);
+            lPrimed[i] |= (uint8_t)lValid;
+        }
+        break;
+    }
+    case ISO_FILTER_KALMAN: {
+        const temp_t lQ = m_params.q;
+        const temp_t lR = m_params.r;
+        for (size_t i = 0; i < _count; i++) {
+            bool lValid = isMeasure(_in[i]);
+            _out[i] = kalmanStep(lValue[i], lVariance[i], lPrimed[i], lQ, lR, _in[i], lValid);
+            lPrimed[i] |= (uint8_t)lValid;
+        }
+        break;
+    }
+    case ISO_FILTER_NONE:
+    default:
+        if (_out != _in)
+            std::copy(_in, _in + _count, _out);
+        break;
+    }
+}
@@ -0,0 +1,126 @@
+/*****************************************************************//**
+ * \file   isolatedBox_filter.h
+ * \brief: Streaming filters of the probe samples (sliding median,
+ * exponential moving average, 1-D Kalman), run before the
+ * compensation so a single outlier does not switch the target.
+ * Fixed size state, no allocation per sample.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_FILTER_H_
+#define _ISO_FILTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "isolatedBox_common.h"
+
+constexpr auto ISO_FILTER_MEDIAN_MAX = 9u;     // Longest median window
+
+/// <summary>
+/// No measure (see ISO_DEF_UNDEF_TEMP). Passed through as non finite
+/// samples, without touching the filter state.
+/// </summary>
+constexpr auto ISO_FILTER_UNDEF = (temp_t)ISO_DEF_UNDEF_TEMP;
+
+enum IsoFilterType_E
+{
+    ISO_FILTER_NONE,
+    ISO_FILTER_MEDIAN,          // Median of the last window samples
+    ISO_FILTER_EMA,             // y += alpha * (x - y)
+    ISO_FILTER_KALMAN           // Constant temperature with process noise q, measure noise r
+};
+
+/**
+ * @brief Filter configuration. Only the fields of the type are used.
+ */
+struct IsoFilterParams
+{
+    IsoFilterType_E type;
+    uint32_t window;            // Median: 1 to ISO_FILTER_MEDIAN_MAX samples
+    temp_t alpha;               // EMA: (0, 1], 1 is no filtering
+    temp_t q;                   // Kalman: variance added per sample (degrees^2)
+    temp_t r;                   // Kalman: variance of the probe (degrees^2)
+};
+
+/**
+ * @brief Default configuration of a filter type
+ */
+IsoFilterParams isoFilterDefaults(IsoFilterType_E _type);
+
+/**
+ * @brief Filter of one stream of samples
+ */
+class IsoSampleFilter
+{
+public:
+    IsoSampleFilter();
+
+    /**
+     * @brief Out of range values are clamped. Resets the state.
+     */
+    void setParams(const IsoFilterParams &_params);
+
+    const IsoFilterParams &getParams() const { return m_params; }
+
+    bool isEnabled() const { return m_params.type != ISO_FILTER_NONE; }
+
+    /**
+     * @brief Forget the samples seen: the next one passes as it is
+     */
+    void reset();
+
+    /**
+     * @brief Filter one sample
+     * @return the filtered value, or _sample as it is if it is
+     * ISO_FILTER_UNDEF or not finite
+     */
+    temp_t update(temp_t _sample);
+
+private:
+    IsoFilterParams m_params;
+    temp_t m_value;             // EMA / Kalman estimate
+    temp_t m_variance;          // Kalman
+    temp_t m_window[ISO_FILTER_MEDIAN_MAX];
+    uint8_t m_next;
+    uint8_t m_count;
+    bool m_primed;
+};
+
+/**
+ * @brief One filter per box, same configuration, state stored by
+ * field over all the boxes: a batch of samples is filtered in one
+ * pass. Disjoint ranges may be updated concurrently.
+ */
+class IsoFilterBank
+{
+public:
+    IsoFilterBank(size_t _numBoxes, const IsoFilterParams &_params);
+
+    size_t size() const { return m_value.size(); }
+
+    const IsoFilterParams &getParams() const { return m_params; }
+
+    void reset();
+
+    /**
+     * @brief Filter the samples of the boxes [_first, _first + _count)
+     * @param _in - one sample per box
+     * @param _out - filtered values, may be _in. ISO_FILTER_UNDEF and
+     * non finite samples are copied as they are.
+     */
+    void update(const temp_t *_in, temp_t *_out, size_t _first, size_t _count);
+
+private:
+    IsoFilterParams m_params;
+    std::vector<temp_t> m_value;
+    std::vector<temp_t> m_variance;
+    std::vector<uint8_t> m_primed;
+    std::vector<temp_t> m_window;       // window samples per box
+    std::vector<uint8_t> m_next;
+    std::vector<uint8_t> m_count;
+};
+
+#endif /* _ISO_FILTER_H_ */
@@ -0,0 +1,321 @@
+/*****************************************************************//**
+ * \file   isolatedBox_history.cpp
+ * \brief: Compressed columnar history of the box temperatures.
+ * A chunk holds the samples of one box: time stamps coded as
+ * delta of delta, values XOR coded against the previous one
+ * (Gorilla style). Lossless.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_history.h"
+
+#include <cstring>
+
+/// <summary>
+/// No XOR window yet: the next changed value writes its own
+/// </summary>
+static const unsigned s_noWindow = 0xFF;
+
+static unsigned leadingZeros(uint32_t _value)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_clz(_value);
+#else
+    unsigned lCount = 0;
+    while (!(_value & 0x80000000u)) {
+        _value <<= 1;
+        lCount++;
+    }
+    return lCount;
+#endif
+}
+
+static unsigned trailingZeros(uint32_t _value)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctz(_value);
+#else
+    unsigned lCount = 0;
+    while (!(_value & 1u)) {
+        _value >>= 1;
+        lCount++;
+    }
+    return lCount;
+#endif
+}
+
+static int64_t signExtend(uint32_t _value, unsigned _bits)
+{
+    uint32_t lSign = 1u << (_bits - 1);
+    return (int64_t)(int32_t)((_value ^ lSign) - lSign);
+}
+
+static uint32_t floatBits(temp_t _value)
+{
+    uint32_t lBits;
+    std::memcpy(&lBits, &_value, sizeof(lBits));
+    return lBits;
+}
+
+
+HistoryEncoder::HistoryEncoder(uint32_t _id, size_t _maxSamples)
+    : m_id(_id), m_maxSamples(_maxSamples > 0 ? _maxSamples : 1)
+{
+    reset();
+}
+
+void HistoryEncoder::reset()
+{
+    m_count = 0;
+    m_ts.clear();
+    m_values.clear();
+    m_firstTs = 0;
+    m_prevTs = 0;
+    m_prevDelta = 0;
+    m_prevValue = 0;
+    m_leading = s_noWindow;
+    m_trailing = 0;
+}
+
+bool HistoryEncoder::append(int64_t _ts, temp_t _value)
+{
+    if (m_count >= m_maxSamples)
+        return false;
+
+    uint32_t lValue = floatBits(_value);
+    if (m_count == 0) {
+        m_firstTs = _ts;
+        m_prevTs = _ts;
+        m_prevDelta = 0;
+        m_prevValue = lValue;
+        m_values.write(lValue, 32);
+        m_count = 1;
+        return true;
+    }
+
+    /// <summary>
+    /// Time stamp: delta of delta, variable length buckets
+    /// </summary>
+    int64_t lDelta = _ts - m_prevTs;
+    int64_t lDod = lDelta - m_prevDelta;
+    if (lDod == 0) {
+        m_ts.write(0, 1);
+    }
+    else if (lDod >= -64 && lDod <= 63) {
+        m_ts.write(0x2, 2);
+        m_ts.write((uint32_t)lDod, 7);
+    }
+    else if (lDod >= -256 && lDod <= 255) {
+        m_ts.write(0x6, 3);
+        m_ts.write((uint32_t)lDod, 9);
+    }
+    else if (lDod >= -2048 && lDod <= 2047) {
+        m_ts.write(0xE, 4);
+        m_ts.write((uint32_t)lDod, 12);
+    }
+    else {
+        m_ts.write(0xF, 4);
+        m_ts.write((uint32_t)((uint64_t)lDod >> 32), 32);
+        m_ts.write((uint32_t)lDod, 32);
+    }
+    m_prevDelta = lDelta;
+    m_prevTs = _ts;
+
+    /// <summary>
+    /// Value: XOR with the previous one, meaningful bits only
+    /// </summary>
+    uint32_t lXor = lValue ^ m_prevValue;
+    if (lXor == 0) {
+        m_values.write(0, 1);
+    }
+    else {
+        unsigned lLeading = leadingZeros(lXor);
+        unsigned lTrailing = trailingZeros(lXor);
+        if (m_leading != s_noWindow && lLeading >= m_leading && lTrailing >= m_trailing) {
+            /// <summary>
+            /// Fits in the previous window
+            /// </summary>
+            m_values.write(0x2, 2);
+            m_values.write(lXor >> m_trailing, 32 - m_leading - m_trailing);
+        }
+        else {
+            unsigned lLength = 32 - lLeading - lTrailing;
+            m_values.write(0x3, 2);
+            m_values.write(lLeading, 5);
+            m_values.write(lLength - 1, 5);
+            m_values.write(lXor >> lTrailing, lLength);
+            m_leading = lLeading;
+            m_trailing = lTrailing;
+        }
+    }
+    m_prevValue = lValue;
+    m_count++;
+    return true;
+}
+
+size_t HistoryEncoder::getEncodedBytes() const
+{
+    return sizeof(HistoryChunkHeader) + m_ts.bytes().size() + m_values.bytes().size() + 2;
+}
+
+size_t HistoryEncoder::finish(std::vector<uint8_t> &_out)
+{
+    if (m_count == 0)
+        return 0;
+
+    m_ts.align();
+    m_values.align();
+
+    HistoryChunkHeader lHeader;
+    lHeader.magic = ISO_HISTORY_MAGIC;
+    lHeader.id = m_id;
+    lHeader.count = (uint32_t)m_count;
+    lHeader.tsBytes = (uint32_t)m_ts.bytes().size();
+    lHeader.firstTs = m_firstTs;
+    lHeader.valueBytes = (uint32_t)m_values.bytes().size();
+    lHeader.reserved = 0;
+
+    size_t lStart = _out.size();
+    _out.resize(lStart + HistoryDecoder::chunkBytes(lHeader));
+    uint8_t *lDst = &_out[lStart];
+    std::memcpy(lDst, &lHeader, sizeof(lHeader));
+    lDst += sizeof(lHeader);
+    if (lHeader.tsBytes > 0)
+        std::memcpy(lDst, m_ts.bytes().data(), lHeader.tsBytes);
+    lDst += lHeader.tsBytes;
+    std::memcpy(lDst, m_values.bytes().data(), lHeader.valueBytes);
+
+    reset();
+    return _out.size() - lStart;
+}
+
+bool HistoryDecoder::parse(const uint8_t *_chunk, size_t _length, HistoryChunkHeader &_header)
+{
+    if (_length < sizeof(HistoryChunkHeader))
+        return false;
+    std::memcpy(&_header, _chunk, sizeof(_header));
+    if (_header.magic != ISO_HISTORY_MAGIC || _header.count == 0)
+        return false;
+
+    /// <summary>
+    /// Every sample after the first costs at least one bit in each
+    /// column: a larger count is corrupt
+    /// </summary>
+    uint64_t lMore = (uint64_t)_header.count - 1;
+    if (lMore > (uint64_t)_header.tsBytes * 8 || lMore > (uint64_t)_header.valueBytes * 8)
+        return false;
+    return chunkBytes(_header) <= _length;
+}
+
+size_t HistoryDecoder::decode(const uint8_t *_chunk, size_t _length, int64_t *_ts, temp_t *_values)
+{
+    HistoryChunkHeader lHeader;
+    if (!parse(_chunk, _length, lHeader))
+        return 0;
+
+    const uint8_t *lTsColumn = _chunk + sizeof(HistoryChunkHeader);
+    const uint8_t *lValueColumn = lTsColumn + lHeader.tsBytes;
+
+    /// <summary>
+    /// Columns are independent: time stamps first, then values
+    /// </summary>
+    HistoryBitReader lTsReader(lTsColumn, lHeader.tsBytes);
+    int64_t lTs = lHeader.firstTs;
+    int64_t lDelta = 0;
+    _ts[0] = lTs;
+    for (uint32_t i = 1; i < lHeader.count; i++) {
+        int64_t lDod;
+        if (lTsReader.read(1) == 0)
+            lDod = 0;
+        else if (lTsReader.read(1) == 0)
+            lDod = signExtend(lTsReader.read(7), 7);
+        else if (lTsReader.read(1) == 0)
+            lDod = signExtend(lTsReader.read(9), 9);
+        else if (lTsReader.read(1) == 0)
+            lDod = signExtend(lTsReader.read(12), 12);
+        else {
+            uint64_t lHigh = lTsReader.read(32);
+            lDod = (int64_t)((lHigh << 32) | lTsReader.read(32));
+        }
+        lDelta += lDod;
+        lTs += lDelta;
+        _ts[i] = lTs;
+    }
+    if (lTsReader.overrun())
+        return 0;
+
+    HistoryBitReader lValueReader(lValueColumn, lHeader.valueBytes);
+    uint32_t lValue = lValueReader.read(32);
+    unsigned lLeading = s_noWindow;
+    unsigned lTrailing = 0;
+    std::memcpy(&_values[0], &lValue, sizeof(lValue));
+    for (uint32_t i = 1; i < lHeader.count; i++) {
+        if (lValueReader.read(1) != 0) {
+            if (lValueReader.read(1) != 0) {
+                /// <summary>
+                /// Corrupt chunk: the window must fit in 32 bits
+                /// </summary>
+                lLeading = lValueReader.read(5);
+                unsigned lLength = lValueReader.read(5) + 1;
+                if (lLeading + lLength > 32)
+                    return 0;
+                lTrailing = 32 - lLeading - lLength;
+            }
+            else if (lLeading == s_noWindow) {
+                return 0;
+            }
+            lValue ^= lValueReader.read(32 - lLeading - lTrailing) << lTrailing;
+        }
+        std::memcpy(&_values[i], &lValue, sizeof(lValue));
+    }
+    if (lValueReader.overrun())
+        return 0;
+    return lHeader.count;
+}
+
+HistoryRecorder::HistoryRecorder(size_t _numSeries, size_t _samplesPerChunk)
+    : m_samples(0), m_encodedBytes(0)
+{
+    m_encoders.reserve(_numSeries);
+    for (size_t i = 0; i < _numSeries; i++)
+        m_encoders.push_back(HistoryEncoder((uint32_t)i, _samplesPerChunk));
+}
+
+void HistoryRecorder::seal(HistoryEncoder &_encoder)
+{
+    HistoryChunk lChunk;
+    lChunk.id = _encoder.getId();
+    m_encodedBytes += _encoder.finish(lChunk.bytes);
+    if (!lChunk.bytes.empty())
+        m_chunks.push_back(std::move(lChunk));
+}
+
+void HistoryRecorder::push(const MonitoringTemp &_sample)
+{
+    if (_sample.box >= m_encoders.size())
+        return;
+
+    HistoryEncoder &lEncoder = m_encoders[_sample.box];
+    int64_t lTs = monitoringMs(_sample);
+    if (!lEncoder.append(lTs, _sample.value)) {
+        seal(lEncoder);
+        lEncoder.append(lTs, _sample.value);
+    }
+    m_samples++;
+}
+
+void HistoryRecorder::sealAll()
+{
+    for (HistoryEncoder &lEncoder : m_encoders)
+        seal(lEncoder);
+}
+
+size_t HistoryRecorder::takeChunks(std::vector<HistoryChunk> &_out)
+{
+    size_t lCount = m_chunks.size();
+    for (HistoryChunk &lChunk : m_chunks)
+        _out.push_back(std::move(lChunk));
+    m_chunks.clear();
+    return lCount;
+}
@@ -0,0 +1,275 @@
+/*****************************************************************//**
+ * \file   isolatedBox_history.h
+ * \brief: Compressed columnar history of the box temperatures.
+ * A chunk holds the samples of one box: time stamps coded as
+ * delta of delta, values XOR coded against the previous one
+ * (Gorilla style). Lossless.
+ *
+ * Chunk layout: HistoryChunkHeader, time stamp column, value column.
+ * Integers are stored in host byte order.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_HISTORY_H_
+#define _ISO_HISTORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "isolatedBox_common.h"
+#include "MonitoringTemp.h"
+
+constexpr auto ISO_HISTORY_MAGIC = 0x484F5349u;    // "ISOH"
+constexpr auto ISO_HISTORY_CHUNK_SAMPLES = 4096u;
+
+struct HistoryChunkHeader
+{
+    uint32_t magic;
+    uint32_t id;            // Box / probe index
+    uint32_t count;         // Samples in the chunk
+    uint32_t tsBytes;       // Size of the time stamp column
+    int64_t firstTs;
+    uint32_t valueBytes;    // Size of the value column
+    uint32_t reserved;
+};
+
+static_assert(sizeof(HistoryChunkHeader) == 32, "HistoryChunkHeader must stay 32 bytes");
+
+/**
+ * @brief MSB first bit stream writer
+ */
+class HistoryBitWriter
+{
+public:
+    HistoryBitWriter() : m_acc(0), m_bits(0) {}
+
+    /**
+     * @brief Append the _count (at most 32) low bits of _value
+     */
+    void write(uint32_t _value, unsigned _count)
+    {
+        m_acc = (m_acc << _count) | (_value & (uint32_t)((1ull << _count) - 1));
+        m_bits += _count;
+        while (m_bits >= 8) {
+            m_bits -= 8;
+            m_bytes.push_back((uint8_t)(m_acc >> m_bits));
+        }
+    }
+
+    /**
+     * @brief Pad the last byte with zeros
+     */
+    void align()
+    {
+        if (m_bits > 0)
+            write(0, 8 - m_bits);
+    }
+
+    void clear()
+    {
+        m_bytes.clear();
+        m_acc = 0;
+        m_bits = 0;
+    }
+
+    const std::vector<uint8_t> &bytes() const { return m_bytes; }
+
+    void reserve(size_t _bytes) { m_bytes.reserve(_bytes); }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    uint64_t m_acc;
+    unsigned m_bits;
+};
+
+/**
+ * @brief MSB first bit stream reader. Reads zeros past the end,
+ * and then reports an overrun.
+ */
+class HistoryBitReader
+{
+public:
+    HistoryBitReader(const uint8_t *_data, size_t _length)
+        : m_data(_data), m_length(_length), m_pos(0), m_acc(0), m_bits(0), m_overrun(false)
+    {
+    }
+
+    /**
+     * @brief Next _count (at most 32) bits
+     */
+    uint32_t read(unsigned _count)
+    {
+        while (m_bits < _count) {
+            if (m_pos < m_length) {
+                m_acc = (m_acc << 8) | m_data[m_pos++];
+            }
+            else {
+                m_acc <<= 8;
+                m_overrun = true;
+            }
+            m_bits += 8;
+        }
+        m_bits -= _count;
+        return (uint32_t)((m_acc >> m_bits) & ((1ull << _count) - 1));
+    }
+
+    /**
+     * @brief True once a read went past the end of the data
+     */
+    bool overrun() const { return m_overrun; }
+
+private:
+    const uint8_t *m_data;
+    size_t m_length;
+    size_t m_pos;
+    uint64_t m_acc;
+    unsigned m_bits;
+    bool m_overrun;
+};
+
+/**
+ * @brief Streaming encoder of one series. Samples are appended one
+ * by one, finish() seals the chunk. Reusable after finish().
+ */
+class HistoryEncoder
+{
+public:
+    explicit HistoryEncoder(uint32_t _id = 0, size_t _maxSamples = ISO_HISTORY_CHUNK_SAMPLES);
+
+    /**
+     * @brief Append a sample. Regular time stamps cost one bit,
+     * an unchanged value one bit.
+     * @return false if the chunk is full: finish() and append again
+     */
+    bool append(int64_t _ts, temp_t _value);
+
+    /**
+     * @brief Append the chunk to _out and reset the encoder
+     * @return size of the chunk in bytes, 0 if there was no sample
+     */
+    size_t finish(std::vector<uint8_t> &_out);
+
+    uint32_t getId() const { return m_id; }
+
+    size_t getCount() const { return m_count; }
+
+    bool isFull() const { return m_count >= m_maxSamples; }
+
+    /**
+     * @brief Current size of the chunk if sealed now
+     */
+    size_t getEncodedBytes() const;
+
+private:
+    void reset();
+
+    uint32_t m_id;
+    size_t m_maxSamples;
+    size_t m_count;
+
+    HistoryBitWriter m_ts;
+    HistoryBitWriter m_values;
+
+    int64_t m_firstTs;
+    int64_t m_prevTs;
+    int64_t m_prevDelta;
+    uint32_t m_prevValue;
+    unsigned m_leading;
+    unsigned m_trailing;
+};
+
+/**
+ * @brief Block decoder of one chunk
+ */
+class HistoryDecoder
+{
+public:
+    /**
+     * @brief Check a chunk and read its header
+     * @param _length - bytes available from _chunk
+     * @return false if _chunk is not a complete valid chunk, or its
+     * count does not fit in its columns
+     */
+    static bool parse(const uint8_t *_chunk, size_t _length, HistoryChunkHeader &_header);
+
+    /**
+     * @brief Total size of the chunk described by _header
+     */
+    static size_t chunkBytes(const HistoryChunkHeader &_header)
+    {
+        return sizeof(HistoryChunkHeader) + _header.tsBytes + _header.valueBytes;
+    }
+
+    /**
+     * @brief Decode the whole chunk in two arrays
+     * @param _ts, _values - at least header.count entries
+     * @return number of samples decoded, 0 if the chunk is invalid
+     */
+    static size_t decode(const uint8_t *_chunk, size_t _length, int64_t *_ts, temp_t *_values);
+};
+
+/**
+ * @brief One sealed chunk
+ */
+struct HistoryChunk
+{
+    uint32_t id;
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ * @brief History sink for the monitoring queue consumer: one
+ * encoder per box, full chunks are kept until taken.
+ * Not thread safe: one recorder per consumer.
+ */
+class HistoryRecorder
+{
+public:
+    HistoryRecorder(size_t _numSeries, size_t _samplesPerChunk = ISO_HISTORY_CHUNK_SAMPLES);
+
+    /**
+     * @brief Record a sample in the series of its box index, time
+     * stamp in milliseconds. Samples of no box or of a box out of
+     * range are ignored.
+     */
+    void push(const MonitoringTemp &_sample);
+
+    void push(const MonitoringTemp *_samples, size_t _count)
+    {
+        for (size_t i = 0; i < _count; i++)
+            push(_samples[i]);
+    }
+
+    /**
+     * @brief Seal every open chunk, e.g. before shutdown
+     */
+    void sealAll();
+
+    /**
+     * @brief Move the sealed chunks at the end of _out
+     * @return number of chunks moved
+     */
+    size_t takeChunks(std::vector<HistoryChunk> &_out);
+
+    /**
+     * @brief Bytes of the samples as raw time stamp + value
+     */
+    uint64_t getRawBytes() const { return m_samples * (sizeof(int64_t) + sizeof(temp_t)); }
+
+    /**
+     * @brief Bytes of the sealed chunks
+     */
+    uint64_t getEncodedBytes() const { return m_encodedBytes; }
+
+private:
+    void seal(HistoryEncoder &_encoder);
+
+    std::vector<HistoryEncoder> m_encoders;
+    std::vector<HistoryChunk> m_chunks;
+    uint64_t m_samples;
+    uint64_t m_encodedBytes;
+};
+
+#endif /* _ISO_HISTORY_H_ */
@@ -0,0 +1,52 @@
+/*****************************************************************//**
+ * \file   isolatedBox_idregistry.cpp
+ * \brief: Registry of the probe and box names
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_idregistry.h"
+
+
+IsoIdRegistry &IsoIdRegistry::instance()
+{
+    static IsoIdRegistry s_registry;
+    return s_registry;
+}
+
+isoId_t IsoIdRegistry::intern(const std::string &_name)
+{
+    std::lock_guard<std::mutex> lLock(m_mutex);
+
+    std::unordered_map<std::string, isoId_t>::const_iterator lIt = m_ids.find(_name);
+    if (lIt != m_ids.end())
+        return lIt->second;
+
+    isoId_t lId = (isoId_t)m_names.size();
+    m_names.push_back(_name);
+    m_ids[_name] = lId;
+    return lId;
+}
+
+isoId_t IsoIdRegistry::find(const std::string &_name) const
+{
+    std::lock_guard<std::mutex> lLock(m_mutex);
+
+    std::unordered_map<std::string, isoId_t>::const_iterator lIt = m_ids.find(_name);
+    return (lIt != m_ids.end()) ? lIt->second : ISO_ID_INVALID;
+}
+
+const std::string &IsoIdRegistry::getName(isoId_t _id) const
+{
+    static const std::string s_unknown;
+    std::lock_guard<std::mutex> lLock(m_mutex);
+
+    return (_id < m_names.size()) ? m_names[_id] : s_unknown;
+}
+
+size_t IsoIdRegistry::size() const
+{
+    std::lock_guard<std::mutex> lLock(m_mutex);
+
+    return m_names.size();
+}
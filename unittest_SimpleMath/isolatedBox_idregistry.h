@@ -0,0 +1,67 @@
+/*****************************************************************//**
+ * \file   isolatedBox_idregistry.h
+ * \brief: Registry of the probe and box names. Names are interned
+ * once at configuration time into dense isoId_t handles; samples,
+ * queues and controllers carry only handles and the names are
+ * resolved again at the logging / UI boundary.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_ID_REGISTRY_H_
+#define _ISO_ID_REGISTRY_H_
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "isolatedBox_common.h"
+
+class IsoIdRegistry
+{
+public:
+    IsoIdRegistry() {}
+
+    IsoIdRegistry(const IsoIdRegistry&) = delete;
+    IsoIdRegistry& operator=(const IsoIdRegistry&) = delete;
+
+    /**
+     * @brief The registry shared by the whole application
+     */
+    static IsoIdRegistry &instance();
+
+    /**
+     * @brief Handle of a name, registered if new. Handles are
+     * given in registration order from 0.
+     */
+    isoId_t intern(const std::string &_name);
+
+    /**
+     * @brief Handle of a registered name
+     * @return ISO_ID_INVALID if the name is unknown
+     */
+    isoId_t find(const std::string &_name) const;
+
+    /**
+     * @brief Name of a handle. The reference stays valid for the
+     * life of the registry.
+     * @return empty string if the handle is unknown
+     */
+    const std::string &getName(isoId_t _id) const;
+
+    /**
+     * @brief Number of registered names
+     */
+    size_t size() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, isoId_t> m_ids;
+    /// <summary>
+    /// deque: growing it does not move the names already returned
+    /// </summary>
+    std::deque<std::string> m_names;
+};
+
+#endif /* _ISO_ID_REGISTRY_H_ */
@@ -0,0 +1,242 @@
+/*****************************************************************//**
+ * \file   isolatedBox_mappedfile.cpp
+ * \brief: Memory mapped file helper (POSIX and Win32) used by the
+ * persistent stores of the box
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_mappedfile.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef _WIN32
+
+IsoMappedFile::IsoMappedFile()
+    : m_data(nullptr), m_size(0), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+{
+}
+
+bool IsoMappedFile::create(const std::string &_path, size_t _size)
+{
+    close();
+    m_file = CreateFileA(_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                         CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+    return map(_size, true);
+}
+
+bool IsoMappedFile::open(const std::string &_path, bool _writable)
+{
+    close();
+    m_file = CreateFileA(_path.c_str(), _writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER lSize;
+    if (!GetFileSizeEx(m_file, &lSize) || lSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+    return map((size_t)lSize.QuadPart, _writable);
+}
+
+bool IsoMappedFile::map(size_t _size, bool _writable)
+{
+    /// <summary>
+    /// The mapping of a writable file extends it to _size
+    /// </summary>
+    LARGE_INTEGER lSize;
+    lSize.QuadPart = (LONGLONG)_size;
+    m_mapping = CreateFileMappingA(m_file, nullptr, _writable ? PAGE_READWRITE : PAGE_READONLY,
+                                   (DWORD)(lSize.QuadPart >> 32), (DWORD)lSize.LowPart, nullptr);
+    if (m_mapping == nullptr) {
+        close();
+        return false;
+    }
+    m_data = (uint8_t *)MapViewOfFile(m_mapping, _writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, _size);
+    if (m_data == nullptr) {
+        close();
+        return false;
+    }
+    m_size = _size;
+    return true;
+}
+
+bool IsoMappedFile::flush()
+{
+    if (m_data == nullptr)
+        return false;
+    return FlushViewOfFile(m_data, 0) != 0;
+}
+
+void IsoMappedFile::close()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+    m_size = 0;
+}
+
+std::vector<std::string> IsoMappedFile::listFiles(const std::string &_dir, const std::string &_prefix,
+                                                  const std::string &_suffix)
+{
+    std::vector<std::string> lFiles;
+    WIN32_FIND_DATAA lFind;
+    HANDLE lHandle = FindFirstFileA((_dir + "\\" + _prefix + "*" + _suffix).c_str(), &lFind);
+    if (lHandle == INVALID_HANDLE_VALUE)
+        return lFiles;
+    do {
+        if (!(lFind.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            lFiles.push_back(lFind.cFileName);
+    } while (FindNextFileA(lHandle, &lFind));
+    FindClose(lHandle);
+    std::sort(lFiles.begin(), lFiles.end());
+    return lFiles;
+}
+
+bool IsoMappedFile::remove(const std::string &_path)
+{
+    return DeleteFileA(_path.c_str()) != 0;
+}
+
+bool IsoMappedFile::createDirectory(const std::string &_dir)
+{
+    return CreateDirectoryA(_dir.c_str(), nullptr) != 0 || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+bool IsoMappedFile::removeDirectory(const std::string &_dir)
+{
+    return RemoveDirectoryA(_dir.c_str()) != 0;
+}
+
+#else
+
+IsoMappedFile::IsoMappedFile()
+    : m_data(nullptr), m_size(0), m_fd(-1)
+{
+}
+
+bool IsoMappedFile::create(const std::string &_path, size_t _size)
+{
+    close();
+    m_fd = ::open(_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0)
+        return false;
+    if (ftruncate(m_fd, (off_t)_size) != 0) {
+        close();
+        return false;
+    }
+    return map(_size, true);
+}
+
+bool IsoMappedFile::open(const std::string &_path, bool _writable)
+{
+    close();
+    m_fd = ::open(_path.c_str(), _writable ? O_RDWR : O_RDONLY);
+    if (m_fd < 0)
+        return false;
+
+    struct stat lStat;
+    if (fstat(m_fd, &lStat) != 0 || lStat.st_size == 0) {
+        close();
+        return false;
+    }
+    return map((size_t)lStat.st_size, _writable);
+}
+
+bool IsoMappedFile::map(size_t _size, bool _writable)
+{
+    void *lData = mmap(nullptr, _size, _writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                       MAP_SHARED, m_fd, 0);
+    if (lData == MAP_FAILED) {
+        close();
+        return false;
+    }
+    m_data = (uint8_t *)lData;
+    m_size = _size;
+    return true;
+}
+
+bool IsoMappedFile::flush()
+{
+    if (m_data == nullptr)
+        return false;
+    return msync(m_data, m_size, MS_ASYNC) == 0;
+}
+
+void IsoMappedFile::close()
+{
+    if (m_data != nullptr)
+        munmap(m_data, m_size);
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_data = nullptr;
+    m_size = 0;
+    m_fd = -1;
+}
+
+std::vector<std::string> IsoMappedFile::listFiles(const std::string &_dir, const std::string &_prefix,
+                                                  const std::string &_suffix)
+{
+    std::vector<std::string> lFiles;
+    DIR *lDir = opendir(_dir.c_str());
+    if (lDir == nullptr)
+        return lFiles;
+    while (struct dirent *lEntry = readdir(lDir)) {
+        std::string lName(lEntry->d_name);
+        if (lName.size() >= _prefix.size() + _suffix.size() &&
+            lName.compare(0, _prefix.size(), _prefix) == 0 &&
+            lName.compare(lName.size() - _suffix.size(), _suffix.size(), _suffix) == 0)
+            lFiles.push_back(lName);
+    }
+    closedir(lDir);
+    std::sort(lFiles.begin(), lFiles.end());
+    return lFiles;
+}
+
+bool IsoMappedFile::remove(const std::string &_path)
+{
+    return ::unlink(_path.c_str()) == 0;
+}
+
+bool IsoMappedFile::createDirectory(const std::string &_dir)
+{
+    return mkdir(_dir.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool IsoMappedFile::removeDirectory(const std::string &_dir)
+{
+    return ::rmdir(_dir.c_str()) == 0;
+}
+
+#endif
+
+IsoMappedFile::~IsoMappedFile()
+{
+    close();
+}
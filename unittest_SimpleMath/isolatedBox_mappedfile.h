@@ -0,0 +1,99 @@
+/*****************************************************************//**
+ * \file   isolatedBox_mappedfile.h
+ * \brief: Memory mapped file helper (POSIX and Win32) used by the
+ * persistent stores of the box
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_MAPPED_FILE_H_
+#define _ISO_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A whole file mapped in memory. Writable mappings are shared:
+ * stores to data() reach the file without any write call.
+ */
+class IsoMappedFile
+{
+public:
+    IsoMappedFile();
+
+    ~IsoMappedFile();
+
+    IsoMappedFile(const IsoMappedFile&) = delete;
+    IsoMappedFile& operator=(const IsoMappedFile&) = delete;
+
+    /**
+     * @brief Create (or truncate) a file of _size bytes, zero filled,
+     * and map it read / write
+     * @return false on error, the object stays closed
+     */
+    bool create(const std::string &_path, size_t _size);
+
+    /**
+     * @brief Map an existing file
+     * @param _writable - map read / write instead of read only
+     * @return false on error or empty file
+     */
+    bool open(const std::string &_path, bool _writable = false);
+
+    /**
+     * @brief Schedule the write back of the dirty pages. Does not wait.
+     */
+    bool flush();
+
+    /**
+     * @brief Unmap and close. Called by the destructor.
+     */
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+
+    uint8_t *data() { return m_data; }
+
+    const uint8_t *data() const { return m_data; }
+
+    size_t size() const { return m_size; }
+
+    /**
+     * @brief Names of the regular files of _dir starting with _prefix
+     * and ending with _suffix, sorted
+     */
+    static std::vector<std::string> listFiles(const std::string &_dir, const std::string &_prefix,
+                                              const std::string &_suffix);
+
+    /**
+     * @brief Delete a file
+     */
+    static bool remove(const std::string &_path);
+
+    /**
+     * @brief Create a directory (parent must exist)
+     * @return true if created or already there
+     */
+    static bool createDirectory(const std::string &_dir);
+
+    /**
+     * @brief Delete an empty directory
+     */
+    static bool removeDirectory(const std::string &_dir);
+
+private:
+    bool map(size_t _size, bool _writable);
+
+    uint8_t *m_data;
+    size_t m_size;
+#ifdef _WIN32
+    void *m_file;
+    void *m_mapping;
+#else
+    int m_fd;
+#endif
+};
+
+#endif /* _ISO_MAPPED_FILE_H_ */
@@ -0,0 +1,148 @@
+/*****************************************************************//**
+ * \file   isolatedBox_metrics.cpp
+ * \brief: Instrumentation of the control path: counters and latency
+ * histograms kept per thread, per box range counters, merged on
+ * demand by a snapshot that never blocks the recording threads.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_metrics.h"
+
+#include <algorithm>
+#include <chrono>
+
+
+uint64_t IsoHistogramSnapshot::percentile(double _quantile) const
+{
+    if (count == 0)
+        return 0;
+
+    /// <summary>
+    /// The highest sample is known exactly
+    /// </summary>
+    uint64_t lRank = (uint64_t)(_quantile * (double)count);
+    if (lRank >= count - 1)
+        return max;
+
+    uint64_t lSeen = 0;
+    for (unsigned b = 0; b < ISO_METRICS_HIST_BUCKETS; b++) {
+        lSeen += buckets[b];
+        if (lSeen > lRank)
+            return std::min(isoMetricsBucketValue(b), max);
+    }
+    return max;
+}
+
+IsoMetricsShard::IsoMetricsShard()
+{
+    for (auto &lCounter : m_counters)
+        lCounter.store(0, std::memory_order_relaxed);
+    for (auto &lHist : m_latencies) {
+        for (auto &lBucket : lHist.buckets)
+            lBucket.store(0, std::memory_order_relaxed);
+        lHist.count.store(0, std::memory_order_relaxed);
+        lHist.sum.store(0, std::memory_order_relaxed);
+        lHist.max.store(0, std::memory_order_relaxed);
+    }
+}
+
+void IsoMetricsShard::mergeInto(IsoMetricsSnapshot &_snapshot) const
+{
+    for (unsigned c = 0; c < ISO_METRICS_NUM_COUNTERS; c++)
+        _snapshot.counters[c] += m_counters[c].load(std::memory_order_relaxed);
+
+    /// <summary>
+    /// The owner may record meanwhile: count and buckets can differ
+    /// by the samples in flight, never more
+    /// </summary>
+    for (unsigned l = 0; l < ISO_METRICS_NUM_LATENCIES; l++) {
+        const Histogram &lHist = m_latencies[l];
+        IsoHistogramSnapshot &lOut = _snapshot.latencies[l];
+        for (unsigned b = 0; b < ISO_METRICS_HIST_BUCKETS; b++)
+            lOut.buckets[b] += lHist.buckets[b].load(std::memory_order_relaxed);
+        lOut.count += lHist.count.load(std::memory_order_relaxed);
+        lOut.sum += lHist.sum.load(std::memory_order_relaxed);
+        lOut.max = std::max(lOut.max, lHist.max.load(std::memory_order_relaxed));
+    }
+}
+
+IsoMetrics::IsoMetrics(size_t _numBoxes)
+    : m_numBoxes(_numBoxes),
+      m_boxOutOfRange(new std::atomic<uint64_t>[_numBoxes]),
+      m_boxTargetSwitches(new std::atomic<uint64_t>[_numBoxes])
+{
+    for (size_t i = 0; i < _numBoxes; i++) {
+        m_boxOutOfRange[i].store(0, std::memory_order_relaxed);
+        m_boxTargetSwitches[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+IsoMetricsShard *IsoMetrics::registerThread()
+{
+    std::lock_guard<std::mutex> lLock(m_mutex);
+
+    m_shards.push_back(std::unique_ptr<IsoMetricsShard>(new IsoMetricsShard));
+    return m_shards.back().get();
+}
+
+void IsoMetrics::snapshot(IsoMetricsSnapshot &_snapshot) const
+{
+    for (auto &lCounter : _snapshot.counters)
+        lCounter = 0;
+    for (auto &lHist : _snapshot.latencies) {
+        std::fill(lHist.buckets, lHist.buckets + ISO_METRICS_HIST_BUCKETS, 0);
+        lHist.count = 0;
+        lHist.sum = 0;
+        lHist.max = 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lLock(m_mutex);
+        for (auto &lShard : m_shards)
+            lShard->mergeInto(_snapshot);
+    }
+
+    _snapshot.boxOutOfRange.resize(m_numBoxes);
+    _snapshot.boxTargetSwitches.resize(m_numBoxes);
+    for (size_t i = 0; i < m_numBoxes; i++) {
+        _snapshot.boxOutOfRange[i] = m_boxOutOfRange[i].load(std::memory_order_relaxed);
+        _snapshot.boxTargetSwitches[i] = m_boxTargetSwitches[i].load(std::memory_order_relaxed);
+    }
+}
+
+temp_t applyCompensationMeasured(isoBoxApi::isoBox &_box, temp_t _temp, size_t _id,
+                                 IsoMetrics &_metrics, IsoMetricsShard &_shard)
+{
+    return applyCompensationMeasured(_box, _temp, _id, _metrics, _shard,
+                                     isoBoxApi::isoBox::isoClock_t::now());
+}
+
+temp_t applyCompensationMeasured(isoBoxApi::isoBox &_box, temp_t _temp, size_t _id,
+                                 IsoMetrics &_metrics, IsoMetricsShard &_shard,
+                                 isoBoxApi::isoBox::isoClock_t::time_point _now)
+{
+    temp_t lPrevious = _box.getTargetPoint();
+    uint64_t lSwitchesAvoided = _box.getSwitchesAvoided();
+    uint64_t lRestartsAvoided = _box.getRestartsAvoided();
+    std::chrono::steady_clock::time_point lBegin = std::chrono::steady_clock::now();
+    temp_t lTarget = _box.applyCompensation(_temp, _now);
+    std::chrono::steady_clock::duration lElapsed = std::chrono::steady_clock::now() - lBegin;
+
+    _shard.count(METRIC_COMPENSATIONS);
+    _shard.record(METRIC_COMPENSATION_NS,
+                  (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(lElapsed).count());
+    if (lTarget != ISO_DEF_UNDEF_TEMP) {
+        _shard.count(METRIC_OUT_OF_RANGE);
+        _metrics.boxOutOfRange(_id);
+    }
+    if (_box.getTargetPoint() != lPrevious) {
+        _shard.count(METRIC_TARGET_SWITCHES);
+        _metrics.boxTargetSwitch(_id);
+    }
+    if (_box.getSwitchesAvoided() != lSwitchesAvoided)
+        _shard.count(METRIC_SWITCHES_AVOIDED, _box.getSwitchesAvoided() - lSwitchesAvoided);
+    if (_box.getRestartsAvoided() != lRestartsAvoided)
+        _shard.count(METRIC_RESTARTS_AVOIDED, _box.getRestartsAvoided() - lRestartsAvoided);
+    return lTarget;
+}
@@ -0,0 +1,239 @@
+/*****************************************************************//**
+ * \file   isolatedBox_metrics.h
+ * \brief: Instrumentation of the control path: counters and latency
+ * histograms kept per thread, per box range counters, merged on
+ * demand by a snapshot that never blocks the recording threads.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_METRICS_H_
+#define _ISO_METRICS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "isolatedBoxCmake.h"
+
+/// <summary>
+/// Histogram layout: values below ISO_METRICS_SUB_BUCKETS are exact,
+/// above every power of two is split in ISO_METRICS_SUB_BUCKETS
+/// linear buckets (relative error below 1/16). Values are clamped to
+/// 2^ISO_METRICS_MAX_EXPONENT - 1 (about 18 minutes in nanoseconds).
+/// </summary>
+constexpr auto ISO_METRICS_SUB_BUCKET_BITS = 4u;
+constexpr auto ISO_METRICS_SUB_BUCKETS = 1u << ISO_METRICS_SUB_BUCKET_BITS;
+constexpr auto ISO_METRICS_MAX_EXPONENT = 40u;
+constexpr auto ISO_METRICS_HIST_BUCKETS =
+    ISO_METRICS_SUB_BUCKETS * (ISO_METRICS_MAX_EXPONENT - ISO_METRICS_SUB_BUCKET_BITS + 1);
+
+enum IsoCounter_E
+{
+    METRIC_COMPENSATIONS,       // applyCompensation calls
+    METRIC_OUT_OF_RANGE,        // Calls with the temperature out of range
+    METRIC_TARGET_SWITCHES,     // Target set point changes
+    METRIC_ACTUATOR_WRITES,     // PWM channels written
+    METRIC_QUEUE_SAMPLES,       // Samples taken from the monitoring queue
+    METRIC_SWITCHES_AVOIDED,    // Target switches refused by the box hysteresis / dwell
+    METRIC_RESTARTS_AVOIDED,    // Out of range samples held by the box deadband
+    ISO_METRICS_NUM_COUNTERS
+};
+
+enum IsoLatency_E
+{
+    METRIC_COMPENSATION_NS,     // Duration of applyCompensation
+    METRIC_ACTUATOR_WRITE_NS,   // Duration of a PWM batch flush
+    METRIC_QUEUE_DWELL_NS,      // Time a sample waited in the queue
+    ISO_METRICS_NUM_LATENCIES
+};
+
+/**
+ * @brief Bucket of a value in the histogram
+ */
+inline unsigned isoMetricsBucket(uint64_t _value)
+{
+    if (_value < ISO_METRICS_SUB_BUCKETS)
+        return (unsigned)_value;
+    if (_value >= (1ull << ISO_METRICS_MAX_EXPONENT))
+        return ISO_METRICS_HIST_BUCKETS - 1;
+
+#if defined(__GNUC__)
+    unsigned lExponent = 63u - (unsigned)__builtin_clzll(_value);
+#else
+    unsigned lExponent = 63;
+    while (!(_value >> lExponent))
+        lExponent--;
+#endif
+    unsigned lShift = lExponent - ISO_METRICS_SUB_BUCKET_BITS;
+    unsigned lSub = (unsigned)(_value >> lShift) & (ISO_METRICS_SUB_BUCKETS - 1);
+    return ISO_METRICS_SUB_BUCKETS * (lShift + 1) + lSub;
+}
+
+/**
+ * @brief Lowest value of a bucket
+ */
+inline uint64_t isoMetricsBucketValue(unsigned _bucket)
+{
+    if (_bucket < ISO_METRICS_SUB_BUCKETS)
+        return _bucket;
+    unsigned lShift = _bucket / ISO_METRICS_SUB_BUCKETS - 1;
+    uint64_t lSub = _bucket % ISO_METRICS_SUB_BUCKETS;
+    return (ISO_METRICS_SUB_BUCKETS + lSub) << lShift;
+}
+
+/**
+ * @brief Merged histogram of a snapshot
+ */
+struct IsoHistogramSnapshot
+{
+    uint64_t buckets[ISO_METRICS_HIST_BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+
+    double mean() const { return count ? (double)sum / count : 0.0; }
+
+    /**
+     * @brief Value below which _quantile (0..1) of the samples fall,
+     * at the bucket resolution
+     */
+    uint64_t percentile(double _quantile) const;
+};
+
+/**
+ * @brief Merged view of all the threads at one point in time
+ */
+struct IsoMetricsSnapshot
+{
+    uint64_t counters[ISO_METRICS_NUM_COUNTERS];
+    IsoHistogramSnapshot latencies[ISO_METRICS_NUM_LATENCIES];
+    std::vector<uint64_t> boxOutOfRange;
+    std::vector<uint64_t> boxTargetSwitches;
+};
+
+/**
+ * @brief Counters and histograms of one thread, on their own cache
+ * lines. Single writer: updates are plain relaxed load / store, no
+ * atomic read-modify-write on the hot path.
+ */
+class IsoMetricsShard
+{
+public:
+    IsoMetricsShard();
+
+    void count(IsoCounter_E _counter, uint64_t _value = 1)
+    {
+        add(m_counters[_counter], _value);
+    }
+
+    void record(IsoLatency_E _latency, uint64_t _ns)
+    {
+        Histogram &lHist = m_latencies[_latency];
+        add(lHist.buckets[isoMetricsBucket(_ns)], 1);
+        add(lHist.count, 1);
+        add(lHist.sum, _ns);
+        if (_ns > lHist.max.load(std::memory_order_relaxed))
+            lHist.max.store(_ns, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Add this shard to a snapshot. Safe while the owner
+     * thread records.
+     */
+    void mergeInto(IsoMetricsSnapshot &_snapshot) const;
+
+private:
+    static void add(std::atomic<uint64_t> &_counter, uint64_t _value)
+    {
+        _counter.store(_counter.load(std::memory_order_relaxed) + _value,
+                       std::memory_order_relaxed);
+    }
+
+    struct Histogram
+    {
+        std::atomic<uint64_t> buckets[ISO_METRICS_HIST_BUCKETS];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> max;
+    };
+
+    char m_padBefore[64];
+    std::atomic<uint64_t> m_counters[ISO_METRICS_NUM_COUNTERS];
+    Histogram m_latencies[ISO_METRICS_NUM_LATENCIES];
+    char m_padAfter[64];
+};
+
+/**
+ * @brief Metrics of a box pool. Every recording thread registers
+ * once and keeps its shard; per box counters are shared atomics.
+ */
+class IsoMetrics
+{
+public:
+    explicit IsoMetrics(size_t _numBoxes);
+
+    IsoMetrics(const IsoMetrics&) = delete;
+    IsoMetrics& operator=(const IsoMetrics&) = delete;
+
+    /**
+     * @brief Shard of a new recording thread. Valid for the life
+     * of this object. Takes a lock: call at thread start, not per sample.
+     */
+    IsoMetricsShard *registerThread();
+
+    size_t getNumBoxes() const { return m_numBoxes; }
+
+    /**
+     * @brief Box _box was found out of its range
+     */
+    void boxOutOfRange(size_t _box)
+    {
+        if (_box < m_numBoxes)
+            m_boxOutOfRange[_box].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Box _box switched its target set point
+     */
+    void boxTargetSwitch(size_t _box)
+    {
+        if (_box < m_numBoxes)
+            m_boxTargetSwitches[_box].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Merge every shard. Only blocks a concurrent registerThread.
+     */
+    void snapshot(IsoMetricsSnapshot &_snapshot) const;
+
+private:
+    size_t m_numBoxes;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_boxOutOfRange;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_boxTargetSwitches;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<IsoMetricsShard>> m_shards;
+};
+
+/**
+ * @brief isoBox::applyCompensation with its duration, the out of
+ * range and target switch events recorded
+ * @param _id - index of the box in _metrics
+ * @param _now - time of the sample (see isoBox::applyCompensation)
+ * @return the result of applyCompensation
+ */
+temp_t applyCompensationMeasured(isoBoxApi::isoBox &_box, temp_t _temp, size_t _id,
+                                 IsoMetrics &_metrics, IsoMetricsShard &_shard,
+                                 isoBoxApi::isoBox::isoClock_t::time_point _now);
+
+/**
+ * @brief Same, the sample taken now
+ */
+temp_t applyCompensationMeasured(isoBoxApi::isoBox &_box, temp_t _temp, size_t _id,
+                                 IsoMetrics &_metrics, IsoMetricsShard &_shard);
+
+#endif /* _ISO_METRICS_H_ */
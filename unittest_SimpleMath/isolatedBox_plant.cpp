@@ -0,0 +1,125 @@
+/*****************************************************************//**
+ * \file   isolatedBox_plant.cpp
+ * \brief: Simulated thermal plant to close the loop without hardware:
+ * the actuator duty cycle heats the box, the box temperature
+ * feeds isoBox::applyCompensation
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+
+#include "isolatedBox_plant.h"
+
+#include <cmath>
+#include <ctime>
+
+using namespace isoBoxApi;
+
+
+ThermalPlant::ThermalPlant(const ThermalPlantParams &_params)
+    : m_params(_params)
+{
+    m_temp = _params.initial;
+    m_lastDt = 0.0;
+    m_decay = 1.0;
+    /// <summary>
+    /// xorshift32 must not start from 0
+    /// </summary>
+    m_noiseState = _params.seed ? _params.seed : 0x9E3779B9u;
+}
+
+temp_t ThermalPlant::step(uint8_t _dutyCycle, temp_t _dt)
+{
+    /// <summary>
+    /// T(t+dt) = Teq + (T(t) - Teq) * exp(-dt/tau)
+    /// with Teq the equilibrium for the applied duty cycle.
+    /// exp() only when the step changes.
+    /// </summary>
+    if (_dt != m_lastDt) {
+        m_lastDt = _dt;
+        m_decay = std::exp(-_dt / m_params.timeConstant);
+    }
+    temp_t lEquilibrium = m_params.ambient +
+        m_params.heaterGain * m_params.timeConstant * (_dutyCycle / 100.0f);
+    m_temp = lEquilibrium + (m_temp - lEquilibrium) * m_decay;
+    return m_temp;
+}
+
+temp_t ThermalPlant::step(const IsoActuatorState &_actuator, temp_t _dt)
+{
+    uint8_t lDuty = (_actuator.getPwmState() == ENABLED) ? _actuator.getDutyCycle() : 0;
+    return step(lDuty, _dt);
+}
+
+temp_t ThermalPlant::measure()
+{
+    m_noiseState ^= m_noiseState << 13;
+    m_noiseState ^= m_noiseState >> 17;
+    m_noiseState ^= m_noiseState << 5;
+    /// <summary>
+    /// Uniform in [-noise, +noise]
+    /// </summary>
+    temp_t lUnit = (m_noiseState >> 8) * (1.0f / 16777216.0f);
+    return m_temp + m_params.noise * (2.0f * lUnit - 1.0f);
+}
+
+PlantSimulation::PlantSimulation(size_t _numBoxes, const ThermalPlantParams &_params,
+                                 temp_t _min, temp_t _max, temp_t _band)
+    : m_boxes(_numBoxes), m_low(_min - _band), m_high(_max + _band)
+{
+    m_plants.reserve(_numBoxes);
+    for (size_t i = 0; i < _numBoxes; i++) {
+        ThermalPlantParams lParams = _params;
+        lParams.seed = _params.seed + (uint32_t)i;
+        m_plants.push_back(ThermalPlant(lParams));
+        m_boxes[i].init(_min, _max);
+    }
+}
+
+PlantSimulationResult PlantSimulation::run(std::chrono::milliseconds _duration,
+                                           timeProcess_t _period)
+{
+    PlantSimulationResult lResult = {};
+    const size_t lNumBoxes = m_boxes.size();
+    const uint64_t lNumSteps = (uint64_t)(_duration / _period);
+    const temp_t lDt = _period.count() / 1000.0f;
+
+    /// <summary>
+    /// Step index after which each box never left the band again
+    /// </summary>
+    std::vector<uint64_t> lSettledAt(lNumBoxes, 0);
+
+    std::clock_t lCpuStart = std::clock();
+    auto lWallStart = std::chrono::steady_clock::now();
+
+    for (uint64_t s = 0; s < lNumSteps; s++) {
+        for (size_t i = 0; i < lNumBoxes; i++) {
+            ThermalPlant &lPlant = m_plants[i];
+            m_boxes[i].applyCompensation(lPlant.measure());
+            temp_t lTemp = lPlant.step(m_boxes[i].getActuator(), lDt);
+            if (lTemp < m_low || lTemp > m_high)
+                lSettledAt[i] = s + 1;
+        }
+    }
+
+    lResult.wallSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - lWallStart).count();
+    lResult.cpuSeconds = (double)(std::clock() - lCpuStart) / CLOCKS_PER_SEC;
+    lResult.steps = lNumSteps * lNumBoxes;
+    lResult.simulatedSeconds = lNumSteps * (double)lDt;
+
+    double lSum = 0.0;
+    for (size_t i = 0; i < lNumBoxes; i++) {
+        if (lNumSteps == 0 || lSettledAt[i] >= lNumSteps)
+            continue;
+        double lSettling = lSettledAt[i] * (double)lDt;
+        lSum += lSettling;
+        if (lSettling > lResult.maxSettlingSeconds)
+            lResult.maxSettlingSeconds = lSettling;
+        lResult.settledBoxes++;
+    }
+    if (lResult.settledBoxes > 0)
+        lResult.meanSettlingSeconds = lSum / lResult.settledBoxes;
+
+    return lResult;
+}
@@ -0,0 +1,119 @@
+/*****************************************************************//**
+ * \file   isolatedBox_plant.h
+ * \brief: Simulated thermal plant to close the loop without hardware:
+ * the actuator duty cycle heats the box, the box temperature
+ * feeds isoBox::applyCompensation
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_PLANT_H_
+#define _ISO_PLANT_H_
+
+#include <vector>
+
+#include "isolatedBoxCmake.h"
+
+namespace isoBoxApi {
+
+/**
+ * @brief First order heat model of one box, temperatures in celsius
+ * dT/dt = (ambient - T) / timeConstant + heaterGain * duty / 100
+ */
+struct ThermalPlantParams
+{
+    temp_t ambient;         // Ambient temperature
+    temp_t initial;         // Box temperature at start
+    temp_t timeConstant;    // Seconds, heat loss towards ambient
+    temp_t heaterGain;      // Degrees per second at 100% duty cycle
+    temp_t noise;           // Amplitude of the uniform probe noise
+    uint32_t seed;          // Noise generator seed, runs are reproducible
+};
+
+class ThermalPlant
+{
+public:
+    explicit ThermalPlant(const ThermalPlantParams &_params);
+
+    /**
+     * @brief Advance the model by _dt seconds with a given duty cycle.
+     * Exact solution of the first order model, stable for any step.
+     * @return the new true temperature
+     */
+    temp_t step(uint8_t _dutyCycle, temp_t _dt);
+
+    /**
+     * @brief Advance the model using the output of an actuator
+     * (no heat if the PWM is disabled)
+     */
+    temp_t step(const IsoActuatorState &_actuator, temp_t _dt);
+
+    /**
+     * @brief True temperature of the box
+     */
+    temp_t getTemperature() const { return m_temp; }
+
+    /**
+     * @brief Temperature as read by the probe: true value plus noise
+     */
+    temp_t measure();
+
+private:
+    ThermalPlantParams m_params;
+    temp_t m_temp;
+    temp_t m_lastDt;
+    temp_t m_decay;
+    uint32_t m_noiseState;
+};
+
+/**
+ * @brief Outcome of a closed loop run
+ */
+struct PlantSimulationResult
+{
+    uint64_t steps;             // Box steps (boxes x scan periods)
+    double simulatedSeconds;
+    double wallSeconds;
+    double cpuSeconds;
+    size_t settledBoxes;        // Boxes inside the band at the end of the run
+    double meanSettlingSeconds; // Over settled boxes
+    double maxSettlingSeconds;
+};
+
+/**
+ * @brief Closed loop of many boxes, each with its own plant,
+ * stepped every scan period as fast as the CPU allows
+ */
+class PlantSimulation
+{
+public:
+    /**
+     * @param _numBoxes - boxes to simulate
+     * @param _params - plant model, the seed is offset by the box index
+     * @param _min, _max - set points of every box
+     * @param _band - tolerance around [_min, _max] to call a box settled
+     */
+    PlantSimulation(size_t _numBoxes, const ThermalPlantParams &_params,
+                    temp_t _min, temp_t _max, temp_t _band = 0.5f);
+
+    /**
+     * @brief Run the loop for a simulated duration
+     * @param _duration - simulated time
+     * @param _period - control step, ISO_SCAN_RATE by default
+     */
+    PlantSimulationResult run(std::chrono::milliseconds _duration,
+                              timeProcess_t _period = timeProcess_t(ISO_SCAN_RATE));
+
+    isoBox &getBox(size_t _id) { return m_boxes[_id]; }
+
+    ThermalPlant &getPlant(size_t _id) { return m_plants[_id]; }
+
+private:
+    std::vector<isoBox> m_boxes;
+    std::vector<ThermalPlant> m_plants;
+    temp_t m_low;
+    temp_t m_high;
+};
+
+};
+#endif // _ISO_PLANT_H_
@@ -0,0 +1,141 @@
+/*****************************************************************//**
+ * \file   isolatedBox_printdebug.cpp
+ * \brief: Asynchronous debug logger. The calling thread only copies
+ * the format string pointer and the binary arguments in a lock-free
+ * ring; a background thread formats and writes the lines.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_printdebug.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+/// <summary>
+/// Sleep of the background thread on an empty ring: bounds the
+/// delay of a line, not the cost of logging it
+/// </summary>
+constexpr auto ISO_LOG_IDLE_MS = 1;
+
+static const char *s_levelNames[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+
+static void writeStderr(const char *_line, size_t _length)
+{
+    fwrite(_line, 1, _length, stderr);
+}
+
+
+ISO_printDebug &ISO_printDebug::instance()
+{
+    static ISO_printDebug s_logger;
+    return s_logger;
+}
+
+ISO_printDebug::ISO_printDebug()
+    : m_level(ISO_LOG_DEBUG),
+      m_pushed(0),
+      m_written(0),
+      m_stop(false),
+      m_sink(writeStderr)
+{
+    m_thread = std::thread(&ISO_printDebug::thread_writer, this);
+}
+
+ISO_printDebug::~ISO_printDebug()
+{
+    m_stop.store(true);
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+uint32_t ISO_printDebug::threadId()
+{
+    static std::atomic<uint32_t> s_next(1);
+    static thread_local uint32_t s_id = s_next.fetch_add(1, std::memory_order_relaxed);
+    return s_id;
+}
+
+void ISO_printDebug::setSink(const IsoLogSink_t &_sink)
+{
+    std::lock_guard<std::mutex> lLock(m_sinkMutex);
+
+    if (_sink)
+        m_sink = _sink;
+    else
+        m_sink = writeStderr;
+}
+
+bool ISO_printDebug::flush(std::chrono::milliseconds _timeout)
+{
+    uint64_t lTarget = m_pushed.load(std::memory_order_relaxed);
+    std::chrono::steady_clock::time_point lDeadline = std::chrono::steady_clock::now() + _timeout;
+    while (m_written.load(std::memory_order_acquire) < lTarget) {
+        if (std::chrono::steady_clock::now() >= lDeadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void ISO_printDebug::formatRecord(const IsoLogRecord &_record, std::string &_out)
+{
+    char lField[64];
+    int lLength = snprintf(lField, sizeof(lField), "%" PRId64 " %s [%u] ", _record.ts,
+                           s_levelNames[_record.level & 3], _record.thread);
+    _out.assign(lField, (size_t)lLength);
+
+    /// <summary>
+    /// Each {} takes the next argument; the ones without an
+    /// argument are left as they are
+    /// </summary>
+    unsigned lArg = 0;
+    for (const char *lChar = _record.format; *lChar != '\0'; lChar++) {
+        if (lChar[0] != '{' || lChar[1] != '}' || lArg >= _record.numArgs) {
+            _out.push_back(*lChar);
+            continue;
+        }
+
+        const IsoLogArg &lValue = _record.args[lArg++];
+        switch (lValue.type) {
+        case ISO_LOG_ARG_INT:
+            lLength = snprintf(lField, sizeof(lField), "%" PRId64, lValue.i);
+            break;
+        case ISO_LOG_ARG_UINT:
+            lLength = snprintf(lField, sizeof(lField), "%" PRIu64, lValue.u);
+            break;
+        case ISO_LOG_ARG_DOUBLE:
+            lLength = snprintf(lField, sizeof(lField), "%g", lValue.d);
+            break;
+        case ISO_LOG_ARG_STRING:
+        default:
+            lLength = snprintf(lField, sizeof(lField), "%s", lValue.s);
+            break;
+        }
+        if (lLength > 0)
+            _out.append(lField, (size_t)lLength < sizeof(lField) ? (size_t)lLength : sizeof(lField) - 1);
+        lChar++;
+    }
+    _out.push_back('\n');
+}
+
+void ISO_printDebug::thread_writer()
+{
+    std::string lLine;
+    IsoLogRecord lRecord;
+    for (;;) {
+        if (!m_ring.try_pop(lRecord)) {
+            if (m_stop.load())
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(ISO_LOG_IDLE_MS));
+            continue;
+        }
+
+        formatRecord(lRecord, lLine);
+        {
+            std::lock_guard<std::mutex> lLock(m_sinkMutex);
+            m_sink(lLine.data(), lLine.size());
+        }
+        m_written.fetch_add(1, std::memory_order_release);
+    }
+}
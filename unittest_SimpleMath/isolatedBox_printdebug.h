@@ -0,0 +1,217 @@
+/*****************************************************************//**
+ * \file   isolatedBox_printdebug.h
+ * \brief: Asynchronous debug logger. The calling thread only copies
+ * the format string pointer and the binary arguments in a lock-free
+ * ring; a background thread formats and writes the lines.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_PRINT_DEBUG_H_
+#define _ISO_PRINT_DEBUG_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "RingQueue.h"
+
+constexpr auto ISO_LOG_MAX_ARGS = 6u;
+constexpr auto ISO_LOG_STRING_BYTES = 24u;     // Longer string arguments are truncated
+constexpr auto ISO_LOG_RING_RECORDS = 1024u;   // Power of two
+
+enum IsoLogLevel_E
+{
+    ISO_LOG_DEBUG,
+    ISO_LOG_INFO,
+    ISO_LOG_WARNING,
+    ISO_LOG_ERROR
+};
+
+enum IsoLogArg_E
+{
+    ISO_LOG_ARG_INT,
+    ISO_LOG_ARG_UINT,
+    ISO_LOG_ARG_DOUBLE,
+    ISO_LOG_ARG_STRING
+};
+
+/**
+ * @brief One argument, kept in binary form until formatted
+ */
+struct IsoLogArg
+{
+    uint8_t type;
+    union
+    {
+        int64_t i;
+        uint64_t u;
+        double d;
+        char s[ISO_LOG_STRING_BYTES];
+    };
+};
+
+/**
+ * @brief Entry of the ring. The format pointer is the format id:
+ * it must be a string literal, or at least outlive the logger.
+ */
+struct IsoLogRecord
+{
+    const char *format;
+    int64_t ts;                 // Milliseconds since epoch
+    uint32_t thread;            // Small id given at the first log of a thread
+    uint8_t level;
+    uint8_t numArgs;
+    IsoLogArg args[ISO_LOG_MAX_ARGS];
+};
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value>::type isoLogEncode(IsoLogArg &_arg, T _value)
+{
+    if (std::is_signed<T>::value) {
+        _arg.type = ISO_LOG_ARG_INT;
+        _arg.i = (int64_t)_value;
+    }
+    else {
+        _arg.type = ISO_LOG_ARG_UINT;
+        _arg.u = (uint64_t)_value;
+    }
+}
+
+template<class T>
+typename std::enable_if<std::is_floating_point<T>::value>::type isoLogEncode(IsoLogArg &_arg, T _value)
+{
+    _arg.type = ISO_LOG_ARG_DOUBLE;
+    _arg.d = (double)_value;
+}
+
+inline void isoLogEncode(IsoLogArg &_arg, const char *_value)
+{
+    _arg.type = ISO_LOG_ARG_STRING;
+    size_t lLength = (_value != nullptr) ? strnlen(_value, ISO_LOG_STRING_BYTES - 1) : 0;
+    if (lLength > 0)
+        memcpy(_arg.s, _value, lLength);
+    _arg.s[lLength] = '\0';
+}
+
+inline void isoLogEncode(IsoLogArg &_arg, const std::string &_value)
+{
+    isoLogEncode(_arg, _value.c_str());
+}
+
+inline void isoLogEncodeArgs(IsoLogArg *)
+{
+}
+
+template<class T, class... Args>
+void isoLogEncodeArgs(IsoLogArg *_args, const T &_first, const Args&... _rest)
+{
+    isoLogEncode(*_args, _first);
+    isoLogEncodeArgs(_args + 1, _rest...);
+}
+
+/**
+ * @brief Destination of the formatted lines, called by the
+ * background thread only
+ */
+typedef std::function<void(const char *_line, size_t _length)> IsoLogSink_t;
+
+/**
+ * @brief Process wide logger. Logging never blocks nor allocates:
+ * when the ring is full the record is dropped and counted.
+ * Messages use {} placeholders: "box {} at {} C".
+ */
+class ISO_printDebug
+{
+public:
+    static ISO_printDebug &instance();
+
+    ISO_printDebug(const ISO_printDebug&) = delete;
+    ISO_printDebug& operator=(const ISO_printDebug&) = delete;
+
+    /**
+     * @brief Drains the ring, then stops the background thread
+     */
+    ~ISO_printDebug();
+
+    /**
+     * @brief Debug level message
+     */
+    template<class... Args>
+    static void printDebug(const char *_format, const Args&... _args)
+    {
+        instance().log(ISO_LOG_DEBUG, _format, _args...);
+    }
+
+    template<class... Args>
+    void log(IsoLogLevel_E _level, const char *_format, const Args&... _args)
+    {
+        static_assert(sizeof...(Args) <= ISO_LOG_MAX_ARGS, "too many log arguments");
+
+        if (_level < m_level.load(std::memory_order_relaxed))
+            return;
+
+        IsoLogRecord lRecord;
+        lRecord.format = _format;
+        lRecord.ts = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        lRecord.thread = threadId();
+        lRecord.level = (uint8_t)_level;
+        lRecord.numArgs = (uint8_t)sizeof...(Args);
+        isoLogEncodeArgs(lRecord.args, _args...);
+        if (m_ring.push(lRecord))
+            m_pushed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Messages below _level are discarded by the caller
+     */
+    void setLevel(IsoLogLevel_E _level) { m_level.store(_level, std::memory_order_relaxed); }
+
+    /**
+     * @brief Replace the destination, stderr by default. An empty
+     * sink restores the default.
+     */
+    void setSink(const IsoLogSink_t &_sink);
+
+    /**
+     * @brief Wait until every queued record has been written
+     * @return false if it did not happen within _timeout
+     */
+    bool flush(std::chrono::milliseconds _timeout = std::chrono::milliseconds(1000));
+
+    /**
+     * @brief Records dropped because the ring was full
+     */
+    uint64_t getDropped() const { return m_ring.dropped(); }
+
+    /**
+     * @brief Text of a record, as written by the background thread
+     */
+    static void formatRecord(const IsoLogRecord &_record, std::string &_out);
+
+private:
+    ISO_printDebug();
+
+    static uint32_t threadId();
+
+    void thread_writer();
+
+    MpscRingQueue<IsoLogRecord, ISO_LOG_RING_RECORDS, RING_DROP_NEWEST> m_ring;
+    std::atomic<int> m_level;
+    std::atomic<uint64_t> m_pushed;
+    std::atomic<uint64_t> m_written;
+    std::atomic<bool> m_stop;
+
+    std::mutex m_sinkMutex;
+    IsoLogSink_t m_sink;
+    std::thread m_thread;
+};
+
+#endif /* _ISO_PRINT_DEBUG_H_ */
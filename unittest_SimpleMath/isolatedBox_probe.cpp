@@ -0,0 +1,43 @@
+/*****************************************************************//**
+ * \file   isolatedBox_probe.cpp
+ * \brief: Temperature probe sources read by the data entry producers
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_probe.h"
+
+
+SimulatedProbeSource::SimulatedProbeSource(size_t _numProbes, temp_t _low, temp_t _high,
+                                           temp_t _step)
+    : m_low(_low), m_high(_high), m_temps(_numProbes), m_steps(_numProbes, _step)
+{
+    /// <summary>
+    /// Phases spread over the interval, half of the probes going down
+    /// </summary>
+    for (size_t i = 0; i < _numProbes; i++) {
+        m_temps[i] = _low + (_high - _low) * (temp_t)(i % 16) / 16.0f;
+        if (i & 1)
+            m_steps[i] = -_step;
+    }
+}
+
+size_t SimulatedProbeSource::read(uint32_t _first, size_t _count, temp_t *_temps)
+{
+    if (_first >= m_temps.size())
+        return 0;
+    if (_count > m_temps.size() - _first)
+        _count = m_temps.size() - _first;
+
+    for (size_t i = 0; i < _count; i++) {
+        size_t lProbe = _first + i;
+        temp_t lTemp = m_temps[lProbe] + m_steps[lProbe];
+        if (lTemp > m_high || lTemp < m_low) {
+            m_steps[lProbe] = -m_steps[lProbe];
+            lTemp = m_temps[lProbe] + m_steps[lProbe];
+        }
+        m_temps[lProbe] = lTemp;
+        _temps[i] = lTemp;
+    }
+    return _count;
+}
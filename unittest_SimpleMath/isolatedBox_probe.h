@@ -0,0 +1,60 @@
+/*****************************************************************//**
+ * \file   isolatedBox_probe.h
+ * \brief: Temperature probe sources read by the data entry producers
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_PROBE_H_
+#define _ISO_PROBE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "isolatedBox_common.h"
+
+/**
+ * @brief Probe driver interface. Probes are read by contiguous ranges
+ * so a driver can fetch a whole bank in one transfer.
+ * read may be called concurrently with disjoint ranges.
+ */
+class IsoProbeSource
+{
+public:
+    virtual ~IsoProbeSource() {}
+
+    /**
+     * @brief Number of probes handled by the source
+     */
+    virtual size_t getNumProbes() const = 0;
+
+    /**
+     * @brief Read the probes [_first, _first + _count) in Celsius
+     * @param _temps - destination, at least _count values
+     * @return number of probes read, from _first
+     */
+    virtual size_t read(uint32_t _first, size_t _count, temp_t *_temps) = 0;
+};
+
+/**
+ * @brief Stand-in source for tests and demo: every probe sweeps
+ * a triangle wave between _low and _high, with its own phase
+ */
+class SimulatedProbeSource : public IsoProbeSource
+{
+public:
+    SimulatedProbeSource(size_t _numProbes, temp_t _low, temp_t _high, temp_t _step = 0.5f);
+
+    size_t getNumProbes() const override { return m_temps.size(); }
+
+    size_t read(uint32_t _first, size_t _count, temp_t *_temps) override;
+
+private:
+    temp_t m_low;
+    temp_t m_high;
+    std::vector<temp_t> m_temps;
+    std::vector<temp_t> m_steps;
+};
+
+#endif /* _ISO_PROBE_H_ */
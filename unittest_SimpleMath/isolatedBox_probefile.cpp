@@ -0,0 +1,420 @@
+/*****************************************************************//**
+ * \file   isolatedBox_probefile.cpp
+ * \brief: Probe source reading one text file per probe, as the
+ * sysfs / hwmon temperature inputs
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_probefile.h"
+#include "isolatedBox_mappedfile.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(ISO_PROBE_IO_URING) && defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define ISO_PROBE_HAS_IO_URING
+#endif
+
+/// <summary>
+/// Width of the values written by IsoProbeDirectory, newline included
+/// </summary>
+constexpr auto ISO_PROBE_DIRECTORY_WIDTH = 12;
+
+
+#ifdef ISO_PROBE_HAS_IO_URING
+
+/// <summary>
+/// Minimal io_uring, one per reading thread: the rings are not tied
+/// to the files, so every source read by a thread shares it.
+/// Only what the batch of reads needs: no liburing dependency.
+/// </summary>
+class IsoProbeRing
+{
+public:
+    IsoProbeRing()
+        : m_fd(-1), m_sq(MAP_FAILED), m_cq(MAP_FAILED), m_sqes(MAP_FAILED),
+          m_sqSize(0), m_cqSize(0), m_sqesSize(0)
+    {
+        io_uring_params lParams;
+        memset(&lParams, 0, sizeof(lParams));
+        m_fd = (int)syscall(__NR_io_uring_setup, ISO_PROBE_FILE_BATCH, &lParams);
+        if (m_fd < 0)
+            return;
+
+        m_sqSize = lParams.sq_off.array + lParams.sq_entries * sizeof(unsigned);
+        m_cqSize = lParams.cq_off.cqes + lParams.cq_entries * sizeof(io_uring_cqe);
+        bool lSingle = (lParams.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (lSingle) {
+            m_sqSize = (m_cqSize > m_sqSize) ? m_cqSize : m_sqSize;
+            m_cqSize = 0;
+        }
+        m_sq = mmap(nullptr, m_sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                    IORING_OFF_SQ_RING);
+        m_cq = lSingle ? m_sq : mmap(nullptr, m_cqSize, PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+        m_sqesSize = lParams.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                      IORING_OFF_SQES);
+        if (m_sq == MAP_FAILED || m_cq == MAP_FAILED || m_sqes == MAP_FAILED) {
+            release();
+            return;
+        }
+
+        char *lSq = (char *)m_sq;
+        char *lCq = (char *)m_cq;
+        m_sqTail = (unsigned *)(lSq + lParams.sq_off.tail);
+        m_sqMask = *(unsigned *)(lSq + lParams.sq_off.ring_mask);
+        m_sqArray = (unsigned *)(lSq + lParams.sq_off.array);
+        m_cqHead = (unsigned *)(lCq + lParams.cq_off.head);
+        m_cqTail = (unsigned *)(lCq + lParams.cq_off.tail);
+        m_cqMask = *(unsigned *)(lCq + lParams.cq_off.ring_mask);
+        m_cqes = (io_uring_cqe *)(lCq + lParams.cq_off.cqes);
+
+        /// <summary>
+        /// io_uring exists since Linux 5.1, IORING_OP_READ since 5.6:
+        /// without it every read would fail, keep the pread path
+        /// </summary>
+        if (!supportsRead())
+            release();
+    }
+
+    ~IsoProbeRing() { release(); }
+
+    bool isValid() const { return m_fd >= 0; }
+
+    /**
+     * @brief Read the first bytes of _count files, _count at most
+     * ISO_PROBE_FILE_BATCH, and wait for all of them: one system call
+     * in the common case
+     * @param _results - bytes read or -errno, per file
+     * @return false if the batch could not be submitted
+     */
+    bool readBatch(const int *_fds, char (*_buffers)[ISO_PROBE_FILE_BYTES], long *_results,
+                   unsigned _count)
+    {
+        io_uring_sqe *lSqes = (io_uring_sqe *)m_sqes;
+        unsigned lTail = *m_sqTail;
+        for (unsigned i = 0; i < _count; i++) {
+            unsigned lIndex = lTail & m_sqMask;
+            io_uring_sqe &lSqe = lSqes[lIndex];
+            memset(&lSqe, 0, sizeof(lSqe));
+            lSqe.opcode = IORING_OP_READ;
+            lSqe.fd = _fds[i];
+            lSqe.addr = (uint64_t)(uintptr_t)_buffers[i];
+            lSqe.len = ISO_PROBE_FILE_BYTES - 1;
+            lSqe.off = 0;
+            lSqe.user_data = i;
+            m_sqArray[lIndex] = lIndex;
+            lTail++;
+        }
+        __atomic_store_n(m_sqTail, lTail, __ATOMIC_RELEASE);
+
+        unsigned lSubmit = _count;
+        unsigned lDone = 0;
+        while (lDone < _count) {
+            long lRet = syscall(__NR_io_uring_enter, m_fd, lSubmit, _count - lDone,
+                                IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (lRet < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                /// <summary>
+                /// Broken ring: the reads already submitted write in
+                /// the caller buffers, wait for them before closing it.
+                /// The caller reads the batch again
+                /// </summary>
+                drain(_results, lDone, _count - lSubmit);
+                release();
+                return false;
+            }
+            if (lRet > 0)
+                lSubmit -= ((unsigned)lRet < lSubmit) ? (unsigned)lRet : lSubmit;
+            lDone = reap(_results, lDone);
+        }
+        return true;
+    }
+
+private:
+    bool supportsRead()
+    {
+        alignas(io_uring_probe) char lBuffer[sizeof(io_uring_probe) +
+                                             (IORING_OP_READ + 1) * sizeof(io_uring_probe_op)];
+        memset(lBuffer, 0, sizeof(lBuffer));
+        io_uring_probe *lProbe = (io_uring_probe *)lBuffer;
+        if (syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, lProbe,
+                    IORING_OP_READ + 1) < 0)
+            return false;
+        return lProbe->last_op >= IORING_OP_READ &&
+               (lProbe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+
+    void drain(long *_results, unsigned _done, unsigned _submitted)
+    {
+        while (_done < _submitted) {
+            syscall(__NR_io_uring_enter, m_fd, 0, _submitted - _done, IORING_ENTER_GETEVENTS,
+                    nullptr, 0);
+            _done = reap(_results, _done);
+        }
+    }
+
+    unsigned reap(long *_results, unsigned _done)
+    {
+        unsigned lHead = *m_cqHead;
+        unsigned lTail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        while (lHead != lTail) {
+            const io_uring_cqe &lCqe = m_cqes[lHead & m_cqMask];
+            _results[lCqe.user_data] = lCqe.res;
+            lHead++;
+            _done++;
+        }
+        __atomic_store_n(m_cqHead, lHead, __ATOMIC_RELEASE);
+        return _done;
+    }
+
+    void release()
+    {
+        if (m_sqes != MAP_FAILED)
+            munmap(m_sqes, m_sqesSize);
+        if (m_cq != MAP_FAILED && m_cq != m_sq)
+            munmap(m_cq, m_cqSize);
+        if (m_sq != MAP_FAILED)
+            munmap(m_sq, m_sqSize);
+        m_sq = m_cq = m_sqes = MAP_FAILED;
+        if (m_fd >= 0)
+            ::close(m_fd);
+        m_fd = -1;
+    }
+
+    int m_fd;
+    void *m_sq;
+    void *m_cq;
+    void *m_sqes;
+    size_t m_sqSize;
+    size_t m_cqSize;
+    size_t m_sqesSize;
+    unsigned *m_sqTail;
+    unsigned m_sqMask;
+    unsigned *m_sqArray;
+    unsigned *m_cqHead;
+    unsigned *m_cqTail;
+    unsigned m_cqMask;
+    io_uring_cqe *m_cqes;
+};
+
+static IsoProbeRing *threadRing()
+{
+    static thread_local IsoProbeRing s_ring;
+    return s_ring.isValid() ? &s_ring : nullptr;
+}
+
+#endif // ISO_PROBE_HAS_IO_URING
+
+
+FileProbeSource::FileProbeSource(temp_t _unit)
+    : m_unit(_unit), m_errors(0)
+{
+}
+
+FileProbeSource::~FileProbeSource()
+{
+    close();
+}
+
+bool FileProbeSource::openDirectory(const std::string &_dir, const std::string &_prefix,
+                                    const std::string &_suffix)
+{
+    std::vector<std::string> lPaths = IsoMappedFile::listFiles(_dir, _prefix, _suffix);
+    for (std::string &lPath : lPaths)
+        lPath = _dir + "/" + lPath;
+    return open(lPaths) && !lPaths.empty();
+}
+
+bool FileProbeSource::usesIoUring()
+{
+#ifdef ISO_PROBE_HAS_IO_URING
+    return threadRing() != nullptr;
+#else
+    return false;
+#endif
+}
+
+bool FileProbeSource::parse(size_t _probe, const char *_text, long _length)
+{
+    char lText[ISO_PROBE_FILE_BYTES];
+    if (_length <= 0)
+        return false;
+    if (_length > (long)ISO_PROBE_FILE_BYTES - 1)
+        _length = ISO_PROBE_FILE_BYTES - 1;
+    memcpy(lText, _text, (size_t)_length);
+    lText[_length] = '\0';
+
+    char *lEnd = nullptr;
+    long lValue = strtol(lText, &lEnd, 10);
+    if (lEnd == lText)
+        return false;
+    m_last[_probe] = (temp_t)lValue * m_unit;
+    return true;
+}
+
+#ifdef _WIN32
+
+bool FileProbeSource::open(const std::vector<std::string> &)
+{
+    /// <summary>
+    /// Probe files are a sysfs / hwmon feature: POSIX only
+    /// </summary>
+    close();
+    return false;
+}
+
+void FileProbeSource::close()
+{
+    m_fds.clear();
+    m_last.clear();
+}
+
+size_t FileProbeSource::read(uint32_t, size_t, temp_t *)
+{
+    return 0;
+}
+
+#else
+
+bool FileProbeSource::open(const std::vector<std::string> &_paths)
+{
+    close();
+
+    bool lRetVal = true;
+    m_fds.resize(_paths.size());
+    m_last.assign(_paths.size(), ISO_PROBE_UNREAD);
+    for (size_t i = 0; i < _paths.size(); i++) {
+        m_fds[i] = ::open(_paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_fds[i] < 0)
+            lRetVal = false;
+    }
+    m_errors.store(0, std::memory_order_relaxed);
+    return lRetVal;
+}
+
+void FileProbeSource::close()
+{
+    for (int lFd : m_fds)
+        if (lFd >= 0)
+            ::close(lFd);
+    m_fds.clear();
+    m_last.clear();
+}
+
+size_t FileProbeSource::read(uint32_t _first, size_t _count, temp_t *_temps)
+{
+    if (_first >= m_fds.size())
+        return 0;
+    if (_count > m_fds.size() - _first)
+        _count = m_fds.size() - _first;
+
+    char lBuffers[ISO_PROBE_FILE_BATCH][ISO_PROBE_FILE_BYTES];
+    long lResults[ISO_PROBE_FILE_BATCH];
+    uint64_t lErrors = 0;
+
+    for (size_t lDone = 0; lDone < _count; lDone += ISO_PROBE_FILE_BATCH) {
+        size_t lBatch = _count - lDone;
+        if (lBatch > ISO_PROBE_FILE_BATCH)
+            lBatch = ISO_PROBE_FILE_BATCH;
+        const int *lFds = m_fds.data() + _first + lDone;
+
+        /// <summary>
+        /// Positional reads at offset 0: a sysfs attribute is
+        /// regenerated at each read from the start, no seek needed
+        /// </summary>
+        bool lBatched = false;
+#ifdef ISO_PROBE_HAS_IO_URING
+        IsoProbeRing *lRing = threadRing();
+        if (lRing != nullptr)
+            lBatched = lRing->readBatch(lFds, lBuffers, lResults, (unsigned)lBatch);
+#endif
+        if (!lBatched)
+            for (size_t i = 0; i < lBatch; i++)
+                lResults[i] = (lFds[i] >= 0) ? (long)pread(lFds[i], lBuffers[i], ISO_PROBE_FILE_BYTES - 1, 0)
+                                             : -EBADF;
+
+        for (size_t i = 0; i < lBatch; i++) {
+            size_t lProbe = _first + lDone + i;
+            if (!parse(lProbe, lBuffers[i], lResults[i]))
+                lErrors++;
+            _temps[lDone + i] = m_last[lProbe];
+        }
+    }
+
+    if (lErrors > 0)
+        m_errors.fetch_add(lErrors, std::memory_order_relaxed);
+    return _count;
+}
+
+#endif
+
+
+IsoProbeDirectory::IsoProbeDirectory()
+{
+}
+
+IsoProbeDirectory::~IsoProbeDirectory()
+{
+    remove();
+}
+
+bool IsoProbeDirectory::create(const std::string &_dir, size_t _numProbes, temp_t _temp)
+{
+    remove();
+    if (!IsoMappedFile::createDirectory(_dir))
+        return false;
+
+    /// <summary>
+    /// Room for the widest size_t: 20 digits
+    /// </summary>
+    char lName[sizeof("/probe_input") + 20];
+    for (size_t i = 0; i < _numProbes; i++) {
+        snprintf(lName, sizeof(lName), "/probe%06zu_input", i);
+        m_paths.push_back(_dir + lName);
+        if (!set(i, _temp))
+            return false;
+    }
+    return true;
+}
+
+bool IsoProbeDirectory::set(size_t _probe, temp_t _temp)
+{
+    if (_probe >= m_paths.size())
+        return false;
+
+    /// <summary>
+    /// Millidegrees padded with spaces: every value has the same
+    /// length, so the file is overwritten and never truncated
+    /// </summary>
+    char lValue[ISO_PROBE_DIRECTORY_WIDTH + 1];
+    snprintf(lValue, sizeof(lValue), "%-*ld\n", ISO_PROBE_DIRECTORY_WIDTH - 1,
+             std::lround(_temp / ISO_PROBE_HWMON_UNIT));
+
+    FILE *lFile = fopen(m_paths[_probe].c_str(), "r+b");
+    if (lFile == nullptr)
+        lFile = fopen(m_paths[_probe].c_str(), "wb");
+    if (lFile == nullptr)
+        return false;
+    bool lRetVal = fwrite(lValue, 1, ISO_PROBE_DIRECTORY_WIDTH, lFile) == (size_t)ISO_PROBE_DIRECTORY_WIDTH;
+    return (fclose(lFile) == 0) && lRetVal;
+}
+
+void IsoProbeDirectory::remove()
+{
+    for (const std::string &lPath : m_paths)
+        IsoMappedFile::remove(lPath);
+    m_paths.clear();
+}
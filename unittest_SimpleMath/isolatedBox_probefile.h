@@ -0,0 +1,140 @@
+/*****************************************************************//**
+ * \file   isolatedBox_probefile.h
+ * \brief: Probe source reading one text file per probe, as the
+ * sysfs / hwmon temperature inputs (temp1_input: "45125\n" in
+ * millidegrees). Descriptors are opened once; each read of a range
+ * is a batch of positional reads, submitted through io_uring when
+ * built with ISO_PROBE_IO_URING (Linux) and else one pread per probe.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_PROBE_FILE_H_
+#define _ISO_PROBE_FILE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "isolatedBox_probe.h"
+
+constexpr auto ISO_PROBE_FILE_BYTES = 16u;     // Longest probe file content read
+constexpr auto ISO_PROBE_FILE_BATCH = 256u;    // Reads per io_uring submission
+constexpr auto ISO_PROBE_HWMON_UNIT = 0.001f;  // hwmon files are in millidegrees
+
+/// <summary>
+/// Value of a probe never read successfully: the data entry consumers
+/// and the scheduler never give it to a box.
+/// </summary>
+constexpr auto ISO_PROBE_UNREAD = (temp_t)ISO_DEF_UNDEF_TEMP;
+
+/**
+ * @brief Probes backed by files. A probe that cannot be read or
+ * parsed keeps its previous value and counts an error: one faulty
+ * probe never truncates the range.
+ * read may be called concurrently with disjoint ranges.
+ */
+class FileProbeSource : public IsoProbeSource
+{
+public:
+    /**
+     * @param _unit - degrees Celsius per unit of the file content
+     */
+    explicit FileProbeSource(temp_t _unit = ISO_PROBE_HWMON_UNIT);
+
+    ~FileProbeSource();
+
+    FileProbeSource(const FileProbeSource&) = delete;
+    FileProbeSource& operator=(const FileProbeSource&) = delete;
+
+    /**
+     * @brief Open the probe files, probe i being _paths[i]. Replaces
+     * the probes opened before.
+     * @return false if a file could not be opened: the probe is kept,
+     * and counts an error at each read
+     */
+    bool open(const std::vector<std::string> &_paths);
+
+    /**
+     * @brief open() on the files of _dir starting with _prefix and
+     * ending with _suffix, sorted by name
+     * @return false if no file matches or one could not be opened
+     */
+    bool openDirectory(const std::string &_dir, const std::string &_prefix,
+                       const std::string &_suffix = "_input");
+
+    void close();
+
+    size_t getNumProbes() const override { return m_fds.size(); }
+
+    size_t read(uint32_t _first, size_t _count, temp_t *_temps) override;
+
+    /**
+     * @brief Probe reads that failed, since open()
+     */
+    uint64_t getErrors() const { return m_errors.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief True if the reads go through io_uring. False when built
+     * without ISO_PROBE_IO_URING, if the kernel refuses it or cannot
+     * run IORING_OP_READ (before Linux 5.6).
+     */
+    static bool usesIoUring();
+
+private:
+    /**
+     * @brief Parse the content of a probe file into m_last[_probe]
+     * @return false if it is not a number
+     */
+    bool parse(size_t _probe, const char *_text, long _length);
+
+    temp_t m_unit;
+    std::vector<int> m_fds;
+    std::vector<temp_t> m_last;
+    std::atomic<uint64_t> m_errors;
+};
+
+/**
+ * @brief Stand-in of a hwmon directory for tests and demo: one file
+ * per probe, rewritten in place so the descriptors opened by
+ * FileProbeSource stay valid. Values are written at fixed width:
+ * a concurrent read never sees a truncated file.
+ */
+class IsoProbeDirectory
+{
+public:
+    IsoProbeDirectory();
+
+    /**
+     * @brief Removes the files
+     */
+    ~IsoProbeDirectory();
+
+    IsoProbeDirectory(const IsoProbeDirectory&) = delete;
+    IsoProbeDirectory& operator=(const IsoProbeDirectory&) = delete;
+
+    /**
+     * @brief Create _dir if needed and _numProbes files probeNNNNNN_input,
+     * all at _temp
+     */
+    bool create(const std::string &_dir, size_t _numProbes, temp_t _temp);
+
+    /**
+     * @brief Write a new temperature (Celsius) in a probe file
+     */
+    bool set(size_t _probe, temp_t _temp);
+
+    const std::vector<std::string> &getPaths() const { return m_paths; }
+
+    /**
+     * @brief Delete the files. The directory is left.
+     */
+    void remove();
+
+private:
+    std::vector<std::string> m_paths;
+};
+
+#endif /* _ISO_PROBE_FILE_H_ */
@@ -0,0 +1,192 @@
+/*****************************************************************//**
+ * \file   isolatedBox_profile.cpp
+ * \brief: Binary store of the PID profiles (LOAD_PROFILE mode).
+ * The file is mapped and its fixed size records are applied to the
+ * boxes as they are: no parsing at load time.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_profile.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const char s_profileMagic[8] = { 'I', 'S', 'O', 'P', 'R', 'O', 'F', '1' };
+
+/// <summary>
+/// Longest line accepted by importText
+/// </summary>
+constexpr auto ISO_PROFILE_LINE_MAX = 512;
+constexpr auto ISO_PROFILE_FIELDS = 7;
+
+
+IsoProfileStore::IsoProfileStore()
+    : m_records(nullptr), m_count(0), m_strings(nullptr), m_stringsSize(0)
+{
+}
+
+void IsoProfileStore::close()
+{
+    m_file.close();
+    m_records = nullptr;
+    m_count = 0;
+    m_strings = nullptr;
+    m_stringsSize = 0;
+}
+
+bool IsoProfileStore::open(const std::string &_path)
+{
+    close();
+    if (!m_file.open(_path) || m_file.size() < sizeof(IsoProfileHeader))
+        return false;
+
+    /// <summary>
+    /// Everything the records point to is checked once here,
+    /// the accessors do not check again
+    /// </summary>
+    IsoProfileHeader lHeader;
+    memcpy(&lHeader, m_file.data(), sizeof(lHeader));
+    uint64_t lRecordsEnd = sizeof(IsoProfileHeader) + (uint64_t)lHeader.count * sizeof(IsoProfileRecord);
+    uint64_t lStringsEnd = (uint64_t)lHeader.stringsOffset + lHeader.stringsSize;
+    if (memcmp(lHeader.magic, s_profileMagic, sizeof(s_profileMagic)) != 0 ||
+        lHeader.version != ISO_PROFILE_VERSION || lHeader.recordSize != sizeof(IsoProfileRecord) ||
+        lRecordsEnd > m_file.size() || lHeader.stringsOffset < lRecordsEnd ||
+        lStringsEnd > m_file.size() ||
+        (lHeader.stringsSize > 0 && m_file.data()[lStringsEnd - 1] != '\0')) {
+        close();
+        return false;
+    }
+
+    m_records = (const IsoProfileRecord *)(m_file.data() + sizeof(IsoProfileHeader));
+    m_count = lHeader.count;
+    m_strings = (const char *)m_file.data() + lHeader.stringsOffset;
+    m_stringsSize = lHeader.stringsSize;
+    return true;
+}
+
+PidDataStruct IsoProfileStore::getPidData(size_t _index, IsoIdRegistry &_registry) const
+{
+    const IsoProfileRecord &lRecord = m_records[_index];
+    PidDataStruct lData;
+    lData.name = _registry.intern(getName(_index));
+    lData.description = _registry.intern(getDescription(_index));
+    lData.kP = lRecord.kP;
+    lData.kI = lRecord.kI;
+    lData.kD = lRecord.kD;
+    lData.volume = lRecord.volume;
+    return lData;
+}
+
+bool IsoProfileStore::write(const std::string &_path, const std::vector<IsoProfileEntry> &_entries)
+{
+    std::vector<IsoProfileRecord> lRecords(_entries.size());
+    std::string lStrings;
+    for (size_t i = 0; i < _entries.size(); i++) {
+        const IsoProfileEntry &lEntry = _entries[i];
+        IsoProfileRecord &lRecord = lRecords[i];
+        lRecord.box = lEntry.box;
+        lRecord.nameOffset = (uint32_t)lStrings.size();
+        lStrings.append(lEntry.name.c_str(), lEntry.name.size() + 1);
+        lRecord.descriptionOffset = (uint32_t)lStrings.size();
+        lStrings.append(lEntry.description.c_str(), lEntry.description.size() + 1);
+        lRecord.kP = lEntry.kP;
+        lRecord.kI = lEntry.kI;
+        lRecord.kD = lEntry.kD;
+        lRecord.volume = lEntry.volume;
+        lRecord.reserved = 0;
+    }
+
+    IsoProfileHeader lHeader;
+    memcpy(lHeader.magic, s_profileMagic, sizeof(s_profileMagic));
+    lHeader.version = ISO_PROFILE_VERSION;
+    lHeader.count = (uint32_t)lRecords.size();
+    lHeader.recordSize = sizeof(IsoProfileRecord);
+    lHeader.stringsOffset = (uint32_t)(sizeof(IsoProfileHeader) + lRecords.size() * sizeof(IsoProfileRecord));
+    lHeader.stringsSize = (uint32_t)lStrings.size();
+    lHeader.reserved = 0;
+
+    IsoMappedFile lFile;
+    if (!lFile.create(_path, lHeader.stringsOffset + lStrings.size()))
+        return false;
+    memcpy(lFile.data(), &lHeader, sizeof(lHeader));
+    if (!lRecords.empty())
+        memcpy(lFile.data() + sizeof(lHeader), lRecords.data(), lRecords.size() * sizeof(IsoProfileRecord));
+    if (!lStrings.empty())
+        memcpy(lFile.data() + lHeader.stringsOffset, lStrings.data(), lStrings.size());
+    bool lRetVal = lFile.flush();
+    lFile.close();
+    return lRetVal;
+}
+
+/// <summary>
+/// Field without the surrounding blanks
+/// </summary>
+static std::string trimField(const char *_begin, const char *_end)
+{
+    while (_begin < _end && (*_begin == ' ' || *_begin == '\t'))
+        _begin++;
+    while (_end > _begin && (_end[-1] == ' ' || _end[-1] == '\t' || _end[-1] == '\r' || _end[-1] == '\n'))
+        _end--;
+    return std::string(_begin, _end);
+}
+
+static bool parseFloat(const std::string &_field, float &_value)
+{
+    char *lEnd = nullptr;
+    _value = strtof(_field.c_str(), &lEnd);
+    return !_field.empty() && *lEnd == '\0';
+}
+
+bool IsoProfileStore::importText(const std::string &_path, std::vector<IsoProfileEntry> &_entries,
+                                 size_t *_errorLine)
+{
+    FILE *lFile = fopen(_path.c_str(), "r");
+    if (lFile == nullptr)
+        return false;
+
+    char lLine[ISO_PROFILE_LINE_MAX];
+    size_t lLineNumber = 0;
+    bool lRetVal = true;
+    while (lRetVal && fgets(lLine, sizeof(lLine), lFile) != nullptr) {
+        lLineNumber++;
+        std::string lTrimmed = trimField(lLine, lLine + strlen(lLine));
+        if (lTrimmed.empty() || lTrimmed[0] == '#')
+            continue;
+
+        std::string lFields[ISO_PROFILE_FIELDS];
+        const char *lBegin = lTrimmed.c_str();
+        int lCount = 0;
+        for (;;) {
+            const char *lComma = strchr(lBegin, ',');
+            const char *lEnd = (lComma != nullptr) ? lComma : lBegin + strlen(lBegin);
+            if (lCount < ISO_PROFILE_FIELDS)
+                lFields[lCount] = trimField(lBegin, lEnd);
+            lCount++;
+            if (lComma == nullptr)
+                break;
+            lBegin = lComma + 1;
+        }
+
+        IsoProfileEntry lEntry;
+        char *lEnd = nullptr;
+        unsigned long lBox = strtoul(lFields[0].c_str(), &lEnd, 10);
+        lRetVal = lCount == ISO_PROFILE_FIELDS && isdigit((unsigned char)lFields[0][0]) && *lEnd == '\0' &&
+                  lBox <= UINT32_MAX &&
+                  parseFloat(lFields[3], lEntry.kP) && parseFloat(lFields[4], lEntry.kI) &&
+                  parseFloat(lFields[5], lEntry.kD) && parseFloat(lFields[6], lEntry.volume);
+        if (!lRetVal)
+            break;
+        lEntry.box = (uint32_t)lBox;
+        lEntry.name = lFields[1];
+        lEntry.description = lFields[2];
+        _entries.push_back(lEntry);
+    }
+
+    fclose(lFile);
+    if (!lRetVal && _errorLine != nullptr)
+        *_errorLine = lLineNumber;
+    return lRetVal;
+}
@@ -0,0 +1,161 @@
+/*****************************************************************//**
+ * \file   isolatedBox_profile.h
+ * \brief: Binary store of the PID profiles (LOAD_PROFILE mode).
+ * The file is mapped and its fixed size records are applied to the
+ * boxes as they are: no parsing at load time.
+ *
+ * File layout, little endian:
+ *   IsoProfileHeader   (32 bytes)
+ *   IsoProfileRecord   x count (32 bytes each)
+ *   string table       name and description of each record, NUL
+ *                      terminated, referenced by offset
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_PROFILE_H_
+#define _ISO_PROFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "isolatedBox_common.h"
+#include "isolatedBox_idregistry.h"
+#include "isolatedBox_mappedfile.h"
+
+constexpr auto ISO_PROFILE_VERSION = 1u;
+
+/**
+ * @brief Start of the file
+ */
+struct IsoProfileHeader
+{
+    char magic[8];              // "ISOPROF1"
+    uint32_t version;
+    uint32_t count;             // Number of records
+    uint32_t recordSize;        // sizeof(IsoProfileRecord)
+    uint32_t stringsOffset;     // From the start of the file
+    uint32_t stringsSize;
+    uint32_t reserved;
+};
+
+/**
+ * @brief Tuning of one box. Names are offsets in the string table.
+ */
+struct IsoProfileRecord
+{
+    uint32_t box;               // Index of the box
+    uint32_t nameOffset;
+    uint32_t descriptionOffset;
+    float kP;
+    float kI;
+    float kD;
+    float volume;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(IsoProfileHeader) == 32, "IsoProfileHeader layout");
+static_assert(sizeof(IsoProfileRecord) == 32, "IsoProfileRecord layout");
+
+/**
+ * @brief A profile before it is written
+ */
+struct IsoProfileEntry
+{
+    uint32_t box;
+    std::string name;
+    std::string description;
+    float kP;
+    float kI;
+    float kD;
+    float volume;
+};
+
+class IsoProfileStore
+{
+public:
+    IsoProfileStore();
+
+    /**
+     * @brief Map a profile file and check its header and bounds
+     * @return false if the file is missing, truncated or not a profile
+     */
+    bool open(const std::string &_path);
+
+    /**
+     * @brief Unmap the file. Called by open().
+     */
+    void close();
+
+    bool isOpen() const { return m_records != nullptr; }
+
+    size_t getCount() const { return m_count; }
+
+    const IsoProfileRecord &getRecord(size_t _index) const { return m_records[_index]; }
+
+    /**
+     * @brief Name and description point in the mapping: valid until close()
+     */
+    const char *getName(size_t _index) const { return stringAt(m_records[_index].nameOffset); }
+
+    const char *getDescription(size_t _index) const
+    {
+        return stringAt(m_records[_index].descriptionOffset);
+    }
+
+    /**
+     * @brief A record as PidDataStruct, the strings interned in _registry
+     */
+    PidDataStruct getPidData(size_t _index, IsoIdRegistry &_registry) const;
+
+    /**
+     * @brief Set the gains of every box that has a record, in one pass
+     * over the records. _getBox(index) returns the box (isoBox &).
+     * @return number of boxes tuned
+     */
+    template<class GetBox>
+    size_t applyTo(size_t _numBoxes, GetBox _getBox) const
+    {
+        size_t lApplied = 0;
+        for (size_t i = 0; i < m_count; i++) {
+            const IsoProfileRecord &lRecord = m_records[i];
+            if (lRecord.box >= _numBoxes)
+                continue;
+            _getBox(lRecord.box).setGains(lRecord.kP, lRecord.kI, lRecord.kD);
+            lApplied++;
+        }
+        return lApplied;
+    }
+
+    /**
+     * @brief Write a profile file
+     */
+    static bool write(const std::string &_path, const std::vector<IsoProfileEntry> &_entries);
+
+    /**
+     * @brief Read the text form of the profiles, one per line:
+     *   box,name,description,kP,kI,kD,volume
+     * Fields cannot contain commas. Empty lines and lines starting
+     * with # are skipped.
+     * @param _errorLine - set to the first invalid line (1 based)
+     * @return false if the file cannot be read or a line is invalid
+     */
+    static bool importText(const std::string &_path, std::vector<IsoProfileEntry> &_entries,
+                           size_t *_errorLine = nullptr);
+
+private:
+    const char *stringAt(uint32_t _offset) const
+    {
+        return (_offset < m_stringsSize) ? m_strings + _offset : "";
+    }
+
+    IsoMappedFile m_file;
+    const IsoProfileRecord *m_records;
+    size_t m_count;
+    const char *m_strings;
+    uint32_t m_stringsSize;
+};
+
+#endif /* _ISO_PROFILE_H_ */
@@ -0,0 +1,96 @@
+/*****************************************************************//**
+ * \file   isolatedBox_pwm.cpp
+ * \brief: PWM hardware abstraction used by IsoActuator and a write
+ * coalescing layer that flushes changed channels once per scan tick
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_pwm.h"
+
+
+MemoryMappedPwm::MemoryMappedPwm(size_t _numChannels)
+    : m_registers(_numChannels), m_batches(0), m_writes(0)
+{
+    PwmRegister lReset = { 0, 0, 0, DISABLED, 0 };
+    for (auto &lRegister : m_registers)
+        lRegister = lReset;
+}
+
+bool MemoryMappedPwm::writeBatch(const PwmWrite *_writes, size_t _count)
+{
+    /// <summary>
+    /// Validate the whole batch first: a device applies all or nothing
+    /// </summary>
+    for (size_t i = 0; i < _count; i++)
+        if (_writes[i].channel >= m_registers.size())
+            return false;
+
+    for (size_t i = 0; i < _count; i++)
+        m_registers[_writes[i].channel] = _writes[i].value;
+
+    m_batches.fetch_add(1, std::memory_order_relaxed);
+    m_writes.fetch_add(_count, std::memory_order_relaxed);
+    return true;
+}
+
+PwmWriteCoalescer::PwmWriteCoalescer(IsoPwmBackend *_backend, uint32_t _firstChannel,
+                                     size_t _numChannels)
+    : m_backend(_backend),
+      m_firstChannel(_firstChannel),
+      m_actuators(_numChannels, nullptr),
+      m_dirty(_numChannels, 0)
+{
+    /// <summary>
+    /// Worst case sizes reserved once: no allocation on the scan path
+    /// </summary>
+    m_dirtyList.reserve(_numChannels);
+    m_batch.reserve(_numChannels);
+}
+
+bool PwmWriteCoalescer::attach(uint32_t _channel, IsoActuatorState *_actuator)
+{
+    uint32_t lIndex = _channel - m_firstChannel;
+    if (lIndex >= m_actuators.size())
+        return false;
+
+    m_actuators[lIndex] = _actuator;
+    if (_actuator != nullptr) {
+        _actuator->attach(this, _channel);
+        markDirty(_channel);
+    }
+    return true;
+}
+
+size_t PwmWriteCoalescer::flush()
+{
+    ISO_TRACE_SCOPE("PwmWriteCoalescer::flush");
+    m_batch.clear();
+    for (uint32_t lIndex : m_dirtyList) {
+        const IsoActuatorState *lActuator = m_actuators[lIndex];
+        if (lActuator == nullptr)
+            continue;
+
+        PwmWrite lWrite;
+        lWrite.channel = m_firstChannel + lIndex;
+        lWrite.value.frequency = lActuator->getFrequency();
+        lWrite.value.dutyCycle = lActuator->getDutyCycle();
+        lWrite.value.intensity = lActuator->getIntensity();
+        lWrite.value.state = (uint8_t)lActuator->getPwmState();
+        lWrite.value.reserved = 0;
+        m_batch.push_back(lWrite);
+    }
+
+    /// <summary>
+    /// A rejected batch keeps its channels dirty: the next flush
+    /// writes them again with the latest outputs
+    /// </summary>
+    if (!m_batch.empty() && m_backend != nullptr &&
+        !m_backend->writeBatch(m_batch.data(), m_batch.size()))
+        return 0;
+
+    for (uint32_t lIndex : m_dirtyList)
+        m_dirty[lIndex] = 0;
+    m_dirtyList.clear();
+    return m_batch.size();
+}
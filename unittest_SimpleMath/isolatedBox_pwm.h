@@ -0,0 +1,134 @@
+/*****************************************************************//**
+ * \file   isolatedBox_pwm.h
+ * \brief: PWM hardware abstraction used by IsoActuator and a write
+ * coalescing layer that flushes changed channels once per scan tick
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_PWM_H_
+#define _ISO_PWM_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "isolatedBox_actuator.h"
+
+/**
+ * @brief Content of the registers of one PWM channel
+ */
+struct PwmRegister
+{
+    uint32_t frequency;
+    uint8_t dutyCycle;
+    uint8_t intensity;
+    uint8_t state;      // EquipmentState
+    uint8_t reserved;
+};
+
+/**
+ * @brief One channel update of a batch
+ */
+struct PwmWrite
+{
+    uint32_t channel;
+    PwmRegister value;
+};
+
+/**
+ * @brief PWM device driver interface. One call applies a whole batch,
+ * so a real driver can do a single bus transaction or syscall.
+ * writeBatch may be called concurrently with disjoint channels.
+ */
+class IsoPwmBackend
+{
+public:
+    virtual ~IsoPwmBackend() {}
+
+    /**
+     * @brief Apply a batch of channel updates
+     * @return false if the device rejected the batch
+     */
+    virtual bool writeBatch(const PwmWrite *_writes, size_t _count) = 0;
+};
+
+/**
+ * @brief Stand-in backend for tests: the register file is plain memory
+ * and every batch and register write is counted
+ */
+class MemoryMappedPwm : public IsoPwmBackend
+{
+public:
+    explicit MemoryMappedPwm(size_t _numChannels);
+
+    bool writeBatch(const PwmWrite *_writes, size_t _count) override;
+
+    size_t getNumChannels() const { return m_registers.size(); }
+
+    const PwmRegister &getRegister(uint32_t _channel) const { return m_registers[_channel]; }
+
+    uint64_t getBatchCount() const { return m_batches.load(std::memory_order_relaxed); }
+
+    uint64_t getWriteCount() const { return m_writes.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<PwmRegister> m_registers;
+    std::atomic<uint64_t> m_batches;
+    std::atomic<uint64_t> m_writes;
+};
+
+/**
+ * @brief Collects the actuators changed during a scan tick and writes
+ * them to the backend in one batch on flush(). Handles the channels
+ * [_firstChannel, _firstChannel + _numChannels). Not thread safe: use
+ * one coalescer per worker or board.
+ */
+class PwmWriteCoalescer
+{
+public:
+    PwmWriteCoalescer(IsoPwmBackend *_backend, uint32_t _firstChannel, size_t _numChannels);
+
+    /**
+     * @brief Bind an actuator to a channel. The actuator marks the
+     * channel dirty on every change of its output.
+     * @return false if the channel is not handled by this coalescer
+     */
+    bool attach(uint32_t _channel, IsoActuatorState *_actuator);
+
+    /**
+     * @brief Record a changed channel. A channel is written once
+     * per flush whatever the number of changes.
+     */
+    void markDirty(uint32_t _channel)
+    {
+        uint32_t lIndex = _channel - m_firstChannel;
+        if (lIndex < m_dirty.size() && !m_dirty[lIndex]) {
+            m_dirty[lIndex] = 1;
+            m_dirtyList.push_back(lIndex);
+        }
+    }
+
+    /**
+     * @brief Number of channels waiting for the next flush
+     */
+    size_t getPending() const { return m_dirtyList.size(); }
+
+    /**
+     * @brief Write all dirty channels in a single batch
+     * @return number of channels written, 0 if the backend rejected
+     * the batch: the channels stay pending
+     */
+    size_t flush();
+
+private:
+    IsoPwmBackend *m_backend;
+    uint32_t m_firstChannel;
+    std::vector<IsoActuatorState *> m_actuators;
+    std::vector<uint8_t> m_dirty;
+    std::vector<uint32_t> m_dirtyList;
+    std::vector<PwmWrite> m_batch;
+};
+
+#endif /* _ISO_PWM_H_ */
@@ -0,0 +1,374 @@
+/*****************************************************************//**
+ * \file   isolatedBox_scheduler.cpp
+ * \brief: Runtime that owns a pool of boxes and ticks each of them
+ * on its ISO_SCAN_RATE deadline from a small, fixed worker pool
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+
+#include "isolatedBox_scheduler.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+using namespace isoBoxApi;
+
+static unsigned trailingZeros(uint64_t _value)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(_value);
+#else
+    unsigned lCount = 0;
+    while (!(_value & 1u)) {
+        _value >>= 1;
+        lCount++;
+    }
+    return lCount;
+#endif
+}
+
+isoBoxScheduler::isoBoxScheduler(size_t _numBoxes, unsigned _numWorkers, timeProcess_t _period)
+    : m_boxes(_numBoxes),
+      m_lastTemp(new std::atomic<temp_t>[_numBoxes]),
+      m_config(_numBoxes),
+      m_configApplied(new std::atomic<uint64_t>[_numBoxes]),
+      m_band(new std::atomic<uint64_t>[_numBoxes]),
+      m_dirty(new std::atomic<uint64_t>[(_numBoxes + 63) / 64]),
+      m_eventDriven(false),
+      m_metrics(nullptr),
+      m_running(false),
+      m_armed(false),
+      m_period(std::chrono::duration_cast<isoClock_t::duration>(_period))
+{
+    if (_numWorkers == 0)
+        _numWorkers = 1;
+
+    for (size_t i = 0; i < _numBoxes; i++) {
+        m_lastTemp[i].store(ISO_DEF_UNDEF_TEMP, std::memory_order_relaxed);
+        m_configApplied[i].store(0, std::memory_order_relaxed);
+        updateBand(i);
+    }
+    for (size_t i = 0; i < (_numBoxes + 63) / 64; i++)
+        m_dirty[i].store(0, std::memory_order_relaxed);
+
+    /// <summary>
+    /// Contiguous ranges keep the boxes of a worker close in memory
+    /// </summary>
+    size_t lFirst = 0;
+    for (unsigned w = 0; w < _numWorkers; w++) {
+        std::unique_ptr<Shard> lShard(new Shard);
+        size_t lLast = (_numBoxes * (w + 1)) / _numWorkers;
+        lShard->first = lFirst;
+        lShard->count = lLast - lFirst;
+        lShard->heap.reserve(lShard->count);
+        lShard->ticks.store(0);
+        lShard->missed.store(0);
+        lShard->maxLatenessUs.store(0);
+        lShard->metrics = nullptr;
+        m_shards.push_back(std::move(lShard));
+        lFirst = lLast;
+    }
+}
+
+isoBoxScheduler::~isoBoxScheduler()
+{
+    stop();
+}
+
+bool isoBoxScheduler::initBox(size_t _id, temp_t _min, temp_t _max)
+{
+    if (_id >= m_boxes.size())
+        return false;
+    bool lRetVal = m_boxes[_id].init(_min, _max);
+    updateBand(_id);
+    markDirty(_id);
+    return lRetVal;
+}
+
+bool isoBoxScheduler::publishConfig(size_t _id, const IsoBoxConfig &_config)
+{
+    if (!m_config.publish(_id, _config))
+        return false;
+    markDirty(_id);
+    return true;
+}
+
+void isoBoxScheduler::publishConfigAll(const IsoBoxConfig &_config)
+{
+    m_config.publishAll(_config);
+    for (size_t i = 0; i < m_boxes.size(); i++)
+        markDirty(i);
+}
+
+void isoBoxScheduler::updateBand(size_t _id)
+{
+    temp_t lBounds[2] = { -std::numeric_limits<temp_t>::infinity(),
+                          std::numeric_limits<temp_t>::infinity() };
+    isoBox &lBox = m_boxes[_id];
+    if (lBox.getInitDone()) {
+        lBounds[0] = lBox.getSetPoint(PID_MIN_SET_POINT);
+        lBounds[1] = lBox.getSetPoint(PID_MAX_SET_POINT);
+    }
+    uint64_t lBand;
+    memcpy(&lBand, lBounds, sizeof(lBand));
+    m_band[_id].store(lBand, std::memory_order_relaxed);
+}
+
+void isoBoxScheduler::setPwmBackend(IsoPwmBackend *_backend)
+{
+    for (auto &lShard : m_shards) {
+        lShard->pwm.reset(new PwmWriteCoalescer(_backend, (uint32_t)lShard->first, lShard->count));
+        for (size_t i = 0; i < lShard->count; i++) {
+            size_t lBox = lShard->first + i;
+            m_boxes[lBox].attachPwm(lShard->pwm.get(), (uint32_t)lBox);
+        }
+    }
+}
+
+void isoBoxScheduler::setMetrics(IsoMetrics *_metrics)
+{
+    m_metrics = _metrics;
+    for (auto &lShard : m_shards)
+        lShard->metrics = (_metrics != nullptr) ? _metrics->registerThread() : nullptr;
+}
+
+void isoBoxScheduler::setFilter(const IsoFilterParams &_params)
+{
+    if (_params.type == ISO_FILTER_NONE)
+        m_filter.reset();
+    else
+        m_filter.reset(new IsoFilterBank(m_boxes.size(), _params));
+}
+
+void isoBoxScheduler::arm(isoClock_t::time_point _start)
+{
+    /// <summary>
+    /// First deadlines are spread over one period so the
+    /// boxes of a shard do not all wake up at the same time.
+    /// In event driven mode every box starts dirty, so each one is
+    /// seen once with its current state.
+    /// </summary>
+    for (auto &lShard : m_shards) {
+        lShard->heap.clear();
+        lShard->nextTick = _start;
+        if (m_eventDriven) {
+            for (size_t i = 0; i < lShard->count; i++)
+                markDirty(lShard->first + i);
+            continue;
+        }
+        for (size_t i = 0; i < lShard->count; i++) {
+            Deadline lDeadline;
+            lDeadline.when = _start + (m_period * i) / lShard->count;
+            lDeadline.box = (uint32_t)(lShard->first + i);
+            lShard->heap.push_back(lDeadline);
+        }
+        std::make_heap(lShard->heap.begin(), lShard->heap.end(), std::greater<Deadline>());
+    }
+    m_armed = true;
+}
+
+bool isoBoxScheduler::stepBox(Shard &_shard, size_t _id, isoClock_t::time_point _now)
+{
+    /// <summary>
+    /// A new configuration is applied between two steps of the
+    /// box, on this thread: nothing else touches the box
+    /// </summary>
+    IsoBoxConfig lConfig;
+    uint64_t lApplied = m_configApplied[_id].load(std::memory_order_relaxed);
+    if (m_config.fetch(_id, lApplied, lConfig)) {
+        m_boxes[_id].applyConfig(lConfig);
+        updateBand(_id);
+        m_configApplied[_id].store(lApplied, std::memory_order_relaxed);
+    }
+
+    temp_t lTemp = m_lastTemp[_id].load(std::memory_order_relaxed);
+    if (lTemp == ISO_DEF_UNDEF_TEMP)
+        return false;
+    temp_t lTarget;
+    if (_shard.metrics != nullptr)
+        lTarget = applyCompensationMeasured(m_boxes[_id], lTemp, _id, *m_metrics, *_shard.metrics, _now);
+    else
+        lTarget = m_boxes[_id].applyCompensation(lTemp, _now);
+    return lTarget != ISO_DEF_UNDEF_TEMP;
+}
+
+void isoBoxScheduler::flushShard(Shard &_shard)
+{
+    /// <summary>
+    /// One batch per tick for all the actuators changed by this shard
+    /// </summary>
+    if (_shard.pwm) {
+        if (_shard.metrics != nullptr && _shard.pwm->getPending() > 0) {
+            isoClock_t::time_point lBegin = isoClock_t::now();
+            size_t lWritten = _shard.pwm->flush();
+            _shard.metrics->record(METRIC_ACTUATOR_WRITE_NS,
+                (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    isoClock_t::now() - lBegin).count());
+            _shard.metrics->count(METRIC_ACTUATOR_WRITES, lWritten);
+        }
+        else
+            _shard.pwm->flush();
+    }
+}
+
+size_t isoBoxScheduler::runShard(Shard &_shard, isoClock_t::time_point _now)
+{
+    size_t lSteps = 0;
+    uint64_t lMissed = 0;
+    int64_t lMaxLateness = _shard.maxLatenessUs.load(std::memory_order_relaxed);
+    std::greater<Deadline> lCmp;
+
+    while (!_shard.heap.empty() && _shard.heap.front().when <= _now) {
+        std::pop_heap(_shard.heap.begin(), _shard.heap.end(), lCmp);
+        Deadline &lDeadline = _shard.heap.back();
+
+        stepBox(_shard, lDeadline.box, _now);
+        lSteps++;
+
+        int64_t lLateness = std::chrono::duration_cast<std::chrono::microseconds>(
+            _now - lDeadline.when).count();
+        if (lLateness > lMaxLateness)
+            lMaxLateness = lLateness;
+
+        /// <summary>
+        /// Next deadline keeps the phase of the box. If whole periods
+        /// already elapsed they are skipped and reported as missed.
+        /// </summary>
+        lDeadline.when += m_period;
+        if (lDeadline.when <= _now) {
+            uint64_t lSkipped = (uint64_t)((_now - lDeadline.when) / m_period) + 1;
+            lDeadline.when += m_period * lSkipped;
+            lMissed += lSkipped;
+        }
+        std::push_heap(_shard.heap.begin(), _shard.heap.end(), lCmp);
+    }
+
+    flushShard(_shard);
+
+    if (lSteps > 0) {
+        _shard.ticks.store(_shard.ticks.load(std::memory_order_relaxed) + lSteps,
+                           std::memory_order_relaxed);
+        _shard.missed.store(_shard.missed.load(std::memory_order_relaxed) + lMissed,
+                            std::memory_order_relaxed);
+        _shard.maxLatenessUs.store(lMaxLateness, std::memory_order_relaxed);
+    }
+    return lSteps;
+}
+
+size_t isoBoxScheduler::runShardEvents(Shard &_shard, isoClock_t::time_point _now)
+{
+    if (_now < _shard.nextTick)
+        return 0;
+
+    uint64_t lMissed = 0;
+    int64_t lLateness = std::chrono::duration_cast<std::chrono::microseconds>(
+        _now - _shard.nextTick).count();
+    _shard.nextTick += m_period;
+    if (_shard.nextTick <= _now) {
+        lMissed = (uint64_t)((_now - _shard.nextTick) / m_period) + 1;
+        _shard.nextTick += m_period * lMissed;
+    }
+
+    /// <summary>
+    /// Take the dirty bits of the shard one word at a time. The first
+    /// and last words can be shared with the neighbour shards: only
+    /// our bits are cleared. A box still out of range marks itself
+    /// again for the next tick.
+    /// </summary>
+    size_t lSteps = 0;
+    size_t lEnd = _shard.first + _shard.count;
+    for (size_t lWord = _shard.first / 64; lWord * 64 < lEnd; lWord++) {
+        uint64_t lMask = ~0ull;
+        if (lWord * 64 < _shard.first)
+            lMask &= ~0ull << (_shard.first % 64);
+        if ((lWord + 1) * 64 > lEnd)
+            lMask &= ~0ull >> (64 - lEnd % 64);
+
+        if ((m_dirty[lWord].load(std::memory_order_relaxed) & lMask) == 0)
+            continue;
+        uint64_t lBits = m_dirty[lWord].fetch_and(~lMask, std::memory_order_acq_rel) & lMask;
+        while (lBits != 0) {
+            size_t lBox = lWord * 64 + trailingZeros(lBits);
+            lBits &= lBits - 1;
+            if (stepBox(_shard, lBox, _now))
+                markDirty(lBox);
+            lSteps++;
+        }
+    }
+
+    flushShard(_shard);
+
+    _shard.ticks.store(_shard.ticks.load(std::memory_order_relaxed) + lSteps,
+                       std::memory_order_relaxed);
+    _shard.missed.store(_shard.missed.load(std::memory_order_relaxed) + lMissed,
+                        std::memory_order_relaxed);
+    if (lLateness > _shard.maxLatenessUs.load(std::memory_order_relaxed))
+        _shard.maxLatenessUs.store(lLateness, std::memory_order_relaxed);
+    return lSteps;
+}
+
+void isoBoxScheduler::workerLoop(Shard *_shard)
+{
+    while (m_running.load(std::memory_order_relaxed)) {
+        isoClock_t::time_point lNow = isoClock_t::now();
+        if (m_eventDriven)
+            runShardEvents(*_shard, lNow);
+        else
+            runShard(*_shard, lNow);
+
+        /// <summary>
+        /// Sleep until the earliest deadline, at most one period
+        /// so stop() is served quickly
+        /// </summary>
+        isoClock_t::time_point lWake = lNow + m_period;
+        if (!_shard->heap.empty() && _shard->heap.front().when < lWake)
+            lWake = _shard->heap.front().when;
+        if (m_eventDriven && _shard->nextTick < lWake)
+            lWake = _shard->nextTick;
+        std::this_thread::sleep_until(lWake);
+    }
+}
+
+bool isoBoxScheduler::start()
+{
+    if (m_running.exchange(true))
+        return false;
+
+    arm(isoClock_t::now());
+    for (auto &lShard : m_shards)
+        m_workers.emplace_back(&isoBoxScheduler::workerLoop, this, lShard.get());
+    return true;
+}
+
+void isoBoxScheduler::stop()
+{
+    m_running.store(false);
+    for (auto &lWorker : m_workers)
+        lWorker.join();
+    m_workers.clear();
+}
+
+size_t isoBoxScheduler::poll(isoClock_t::time_point _now)
+{
+    if (!m_armed)
+        arm(_now);
+
+    size_t lSteps = 0;
+    for (auto &lShard : m_shards)
+        lSteps += m_eventDriven ? runShardEvents(*lShard, _now) : runShard(*lShard, _now);
+    return lSteps;
+}
+
+isoBoxSchedulerStats isoBoxScheduler::getStats() const
+{
+    isoBoxSchedulerStats lStats = { 0, 0, 0 };
+    for (auto &lShard : m_shards) {
+        lStats.ticks += lShard->ticks.load(std::memory_order_relaxed);
+        lStats.missedDeadlines += lShard->missed.load(std::memory_order_relaxed);
+        lStats.maxLatenessUs = std::max(lStats.maxLatenessUs,
+                                        (int64_t)lShard->maxLatenessUs.load(std::memory_order_relaxed));
+    }
+    return lStats;
+}
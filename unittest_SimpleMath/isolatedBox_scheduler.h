@@ -0,0 +1,252 @@
+/*****************************************************************//**
+ * \file   isolatedBox_scheduler.h
+ * \brief: Runtime that owns a pool of boxes and ticks each of them
+ * on its ISO_SCAN_RATE deadline from a small, fixed worker pool
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_BOX_SCHEDULER_H
+#define _ISO_BOX_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "isolatedBoxCmake.h"
+#include "isolatedBox_pwm.h"
+#include "isolatedBox_metrics.h"
+
+namespace isoBoxApi {
+
+/**
+ * @brief Counters reported by the scheduler, used to size hosts
+ */
+struct isoBoxSchedulerStats
+{
+    uint64_t ticks;             // Box steps executed
+    uint64_t missedDeadlines;   // Scan periods skipped because a box ran too late
+    int64_t  maxLatenessUs;     // Worst delay between a deadline and its step
+};
+
+class isoBoxScheduler {
+public:
+    typedef std::chrono::steady_clock isoClock_t;
+
+    /**
+    * @brief Constructor: creates the boxes and splits them in
+    * contiguous shards, one per worker
+    * @param: size_t _numBoxes - number of boxes owned
+    * @param: unsigned _numWorkers - number of worker threads (at least 1)
+    * @param: timeProcess_t _period - scan period of every box
+    */
+    isoBoxScheduler(size_t _numBoxes, unsigned _numWorkers,
+                    timeProcess_t _period = timeProcess_t(ISO_SCAN_RATE));
+
+    /**
+    * @brief Destructor: stops the workers
+    */
+    ~isoBoxScheduler();
+
+    isoBoxScheduler(const isoBoxScheduler&) = delete;
+    isoBoxScheduler& operator=(const isoBoxScheduler&) = delete;
+
+    size_t getNumBoxes() const { return m_boxes.size(); }
+
+    unsigned getNumWorkers() const { return (unsigned)m_shards.size(); }
+
+    /**
+    * @brief Access a box. Configure boxes before start()
+    */
+    isoBox &getBox(size_t _id) { return m_boxes[_id]; }
+
+    /**
+    * @brief Initialize the set points of a box (see isoBox::init)
+    * @return true if the init is OK
+    */
+    bool initBox(size_t _id, temp_t _min, temp_t _max);
+
+    /**
+    * @brief Store the latest measured temperature of a box, filtered
+    * if a filter is set (see setFilter). Can be called from any
+    * thread, one thread at a time per box when filtering. The box
+    * uses it on its next step. In event driven mode an in range
+    * sample of an idle box stops here: only out of range samples
+    * mark the box dirty.
+    */
+    void postTemp(size_t _id, temp_t _temp)
+    {
+        if (m_filter)
+            m_filter->update(&_temp, &_temp, _id, 1);
+        m_lastTemp[_id].store(_temp, std::memory_order_relaxed);
+        if (m_eventDriven && !inBand(_id, _temp))
+            markDirty(_id);
+    }
+
+    /**
+    * @brief Publish new set points and / or gains for a box. Any
+    * thread, workers running or not: the box applies them before its
+    * next step.
+    * @return false if the box does not exist
+    */
+    bool publishConfig(size_t _id, const IsoBoxConfig &_config);
+
+    /**
+    * @brief publishConfig for every box
+    */
+    void publishConfigAll(const IsoBoxConfig &_config);
+
+    /**
+    * @brief Last configuration version applied by a box, 0 if none.
+    * May be polled while the workers run.
+    */
+    uint64_t getAppliedConfig(size_t _id) const
+    {
+        return m_configApplied[_id].load(std::memory_order_relaxed);
+    }
+
+    /**
+    * @brief Write the actuators through a PWM backend. Each worker
+    * flushes the channels changed by its boxes in one batch at the end
+    * of its tick. Channel number is the box index. Call before start().
+    */
+    void setPwmBackend(IsoPwmBackend *_backend);
+
+    /**
+    * @brief Record compensations, target switches and PWM flushes
+    * in _metrics, one metrics shard per worker. Call before start().
+    */
+    void setMetrics(IsoMetrics *_metrics);
+
+    /**
+    * @brief Filter every sample in postTemp, before the event driven
+    * check: each sample is filtered once, skipped or not. Prefer it
+    * to isoBox::setFilter, which filters once per step.
+    * ISO_FILTER_NONE removes the filter. Call before start().
+    */
+    void setFilter(const IsoFilterParams &_params);
+
+    /**
+    * @brief Event driven mode: instead of stepping every box on its
+    * deadline, each worker steps once per period only the boxes of
+    * its dirty set: boxes with an out of range sample, a new
+    * configuration, or still out of range at their previous step.
+    * Boxes in range cost nothing but the check in postTemp.
+    * Call before start().
+    */
+    void setEventDriven(bool _enable) { m_eventDriven = _enable; }
+
+    bool isEventDriven() const { return m_eventDriven; }
+
+    /**
+    * @brief Start the worker threads
+    * @return false if already running
+    */
+    bool start();
+
+    /**
+    * @brief Stop and join the worker threads
+    */
+    void stop();
+
+    bool isRunning() const { return m_running.load(); }
+
+    /**
+    * @brief Run every step due at _now on the caller thread.
+    * Alternative to start() for single threaded hosts and tests,
+    * never to be mixed with running workers.
+    * @return number of steps executed
+    */
+    size_t poll(isoClock_t::time_point _now);
+
+    /**
+    * @brief Counters summed over all workers
+    */
+    isoBoxSchedulerStats getStats() const;
+
+private:
+    struct Deadline
+    {
+        isoClock_t::time_point when;
+        uint32_t box;
+
+        bool operator>(const Deadline &_other) const { return when > _other.when; }
+    };
+
+    /// <summary>
+    /// Each worker owns one shard: a deadline heap over a contiguous
+    /// range of boxes. Shards never share boxes, so steps need no lock.
+    /// Trailing padding keeps the counters of two shards off the same
+    /// cache line.
+    /// </summary>
+    struct Shard
+    {
+        size_t first;
+        size_t count;
+        std::vector<Deadline> heap;
+        isoClock_t::time_point nextTick;        // Event driven mode only
+        std::atomic<uint64_t> ticks;
+        std::atomic<uint64_t> missed;
+        std::atomic<int64_t> maxLatenessUs;
+        std::unique_ptr<PwmWriteCoalescer> pwm;
+        IsoMetricsShard *metrics;
+        char padding[64];
+    };
+
+    void arm(isoClock_t::time_point _start);
+
+    size_t runShard(Shard &_shard, isoClock_t::time_point _now);
+
+    size_t runShardEvents(Shard &_shard, isoClock_t::time_point _now);
+
+    /**
+    * @brief Step of one box, shared by both modes
+    * @return true if the box is compensating after the step
+    */
+    bool stepBox(Shard &_shard, size_t _id, isoClock_t::time_point _now);
+
+    void flushShard(Shard &_shard);
+
+    void markDirty(size_t _id)
+    {
+        m_dirty[_id / 64].fetch_or(1ull << (_id % 64), std::memory_order_release);
+    }
+
+    /// <summary>
+    /// Interval in which a sample leaves an idle box idle: the set
+    /// points of the box, or everything while it is not initialized.
+    /// Both bounds packed in one word, written by the owner of the box.
+    /// </summary>
+    bool inBand(size_t _id, temp_t _temp) const
+    {
+        uint64_t lBand = m_band[_id].load(std::memory_order_relaxed);
+        temp_t lBounds[2];
+        memcpy(lBounds, &lBand, sizeof(lBounds));
+        return _temp >= lBounds[0] && _temp <= lBounds[1];
+    }
+
+    void updateBand(size_t _id);
+
+    void workerLoop(Shard *_shard);
+
+    std::vector<isoBox> m_boxes;
+    std::unique_ptr<std::atomic<temp_t>[]> m_lastTemp;
+    IsoBoxConfigTable m_config;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_configApplied;  // Written by the shard of the box only
+    std::unique_ptr<std::atomic<uint64_t>[]> m_band;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_dirty;   // One bit per box
+    std::unique_ptr<IsoFilterBank> m_filter;
+    bool m_eventDriven;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::vector<std::thread> m_workers;
+    IsoMetrics *m_metrics;
+    std::atomic<bool> m_running;
+    bool m_armed;
+    isoClock_t::duration m_period;
+};
+
+};
+#endif // !_ISO_BOX_SCHEDULER_H
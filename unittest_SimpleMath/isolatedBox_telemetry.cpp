@@ -0,0 +1,251 @@
+/*****************************************************************//**
+ * \file   isolatedBox_telemetry.cpp
+ * \brief: Append only telemetry log of temperature and actuator
+ * samples. Fixed size records in memory mapped segment files,
+ * rotated when full, oldest segments deleted past the retention.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_telemetry.h"
+
+#include <cstdio>
+#include <fstream>
+
+
+static const char s_telemetryMagic[8] = { 'I', 'S', 'O', 'T', 'L', 'O', 'G', '1' };
+static const char *s_segmentPrefix = "telemetry_";
+static const char *s_segmentSuffix = ".seg";
+static const char *s_idsFile = "telemetry.ids";
+
+static std::string telemetryPath(const std::string &_dir, const std::string &_name)
+{
+    return _dir + "/" + _name;
+}
+
+static std::string segmentName(uint64_t _sequence)
+{
+    char lName[40];
+    snprintf(lName, sizeof(lName), "%s%08llu%s", s_segmentPrefix,
+             (unsigned long long)_sequence, s_segmentSuffix);
+    return lName;
+}
+
+static void loadIds(const std::string &_dir, std::vector<std::string> &_names)
+{
+    std::ifstream lFile(telemetryPath(_dir, s_idsFile).c_str());
+    std::string lLine;
+    while (std::getline(lFile, lLine))
+        _names.push_back(lLine);
+}
+
+
+TelemetryWriter::TelemetryWriter()
+    : m_recordsPerSegment(ISO_TELEMETRY_SEGMENT_RECORDS),
+      m_maxSegments(ISO_TELEMETRY_MAX_SEGMENTS),
+      m_header(nullptr),
+      m_records(nullptr),
+      m_count(0),
+      m_capacity(0),
+      m_sequence(0),
+      m_total(0)
+{
+}
+
+TelemetryWriter::~TelemetryWriter()
+{
+    close();
+}
+
+bool TelemetryWriter::open(const std::string &_dir, size_t _recordsPerSegment, size_t _maxSegments)
+{
+    close();
+    if (!IsoMappedFile::createDirectory(_dir))
+        return false;
+    m_dir = _dir;
+    m_recordsPerSegment = _recordsPerSegment > 0 ? _recordsPerSegment : 1;
+    m_maxSegments = _maxSegments > 0 ? _maxSegments : 1;
+    m_total = 0;
+
+    /// <summary>
+    /// Carry on after the segments already on disk
+    /// </summary>
+    m_segmentNames.clear();
+    m_sequence = 0;
+    std::vector<std::string> lExisting = IsoMappedFile::listFiles(_dir, s_segmentPrefix, s_segmentSuffix);
+    for (const std::string &lName : lExisting) {
+        m_segmentNames.push_back(lName);
+        unsigned long long lSequence = 0;
+        if (sscanf(lName.c_str() + strlen(s_segmentPrefix), "%llu", &lSequence) == 1 &&
+            lSequence + 1 > m_sequence)
+            m_sequence = lSequence + 1;
+    }
+
+    m_ids.clear();
+    m_idNames.clear();
+    m_fromRegistry.clear();
+    loadIds(_dir, m_idNames);
+    for (size_t i = 0; i < m_idNames.size(); i++)
+        m_ids[m_idNames[i]] = (uint32_t)i;
+
+    return rotate();
+}
+
+void TelemetryWriter::close()
+{
+    if (m_segment.isOpen()) {
+        m_segment.flush();
+        m_segment.close();
+    }
+    m_header = nullptr;
+    m_records = nullptr;
+    m_count = 0;
+    m_capacity = 0;
+}
+
+bool TelemetryWriter::rotate()
+{
+    close();
+
+    std::string lName = segmentName(m_sequence);
+    size_t lSize = sizeof(TelemetrySegmentHeader) + m_recordsPerSegment * sizeof(TelemetryRecord);
+    if (!m_segment.create(telemetryPath(m_dir, lName), lSize))
+        return false;
+
+    m_header = (TelemetrySegmentHeader *)m_segment.data();
+    m_records = (TelemetryRecord *)(m_segment.data() + sizeof(TelemetrySegmentHeader));
+    std::memcpy(m_header->magic, s_telemetryMagic, sizeof(s_telemetryMagic));
+    m_header->version = ISO_TELEMETRY_VERSION;
+    m_header->recordSize = sizeof(TelemetryRecord);
+    m_header->capacity = m_recordsPerSegment;
+    m_header->count = 0;
+    m_header->sequence = m_sequence;
+    m_capacity = m_recordsPerSegment;
+    m_sequence++;
+
+    /// <summary>
+    /// Retention: keep at most m_maxSegments segments on disk
+    /// </summary>
+    m_segmentNames.push_back(lName);
+    while (m_segmentNames.size() > m_maxSegments) {
+        IsoMappedFile::remove(telemetryPath(m_dir, m_segmentNames.front()));
+        m_segmentNames.pop_front();
+    }
+    return true;
+}
+
+uint32_t TelemetryWriter::intern(const std::string &_id)
+{
+    std::unordered_map<std::string, uint32_t>::const_iterator lIt = m_ids.find(_id);
+    if (lIt != m_ids.end())
+        return lIt->second;
+
+    /// <summary>
+    /// New probe: the only write outside the mapping, once per id
+    /// </summary>
+    uint32_t lId = (uint32_t)m_idNames.size();
+    m_ids[_id] = lId;
+    m_idNames.push_back(_id);
+    std::ofstream lFile(telemetryPath(m_dir, s_idsFile).c_str(), std::ios::app);
+    lFile << _id << '\n';
+    return lId;
+}
+
+uint32_t TelemetryWriter::internHandle(isoId_t _handle)
+{
+    /// <summary>
+    /// Not a registry handle (ISO_ID_INVALID, stray value): refused,
+    /// not cached so the table stays dense
+    /// </summary>
+    if (_handle >= IsoIdRegistry::instance().size())
+        return ISO_ID_INVALID;
+
+    const std::string &lName = IsoIdRegistry::instance().getName(_handle);
+    uint32_t lId = intern(lName);
+    if (_handle >= m_fromRegistry.size())
+        m_fromRegistry.resize((size_t)_handle + 1, ISO_ID_INVALID);
+    m_fromRegistry[_handle] = lId;
+    return lId;
+}
+
+bool TelemetryReader::open(const std::string &_dir)
+{
+    close();
+
+    std::vector<std::string> lNames = IsoMappedFile::listFiles(_dir, s_segmentPrefix, s_segmentSuffix);
+    for (const std::string &lName : lNames) {
+        std::unique_ptr<IsoMappedFile> lFile(new IsoMappedFile);
+        if (!lFile->open(telemetryPath(_dir, lName)))
+            continue;
+
+        /// <summary>
+        /// Skip anything that is not a segment of this version
+        /// </summary>
+        if (lFile->size() < sizeof(TelemetrySegmentHeader))
+            continue;
+        const TelemetrySegmentHeader *lHeader = (const TelemetrySegmentHeader *)lFile->data();
+        if (std::memcmp(lHeader->magic, s_telemetryMagic, sizeof(s_telemetryMagic)) != 0 ||
+            lHeader->version != ISO_TELEMETRY_VERSION ||
+            lHeader->recordSize != sizeof(TelemetryRecord))
+            continue;
+
+        m_segments.push_back(std::move(lFile));
+    }
+
+    loadIds(_dir, m_idNames);
+    return !m_segments.empty();
+}
+
+void TelemetryReader::close()
+{
+    m_segments.clear();
+    m_idNames.clear();
+}
+
+TelemetrySpan TelemetryReader::getSegment(size_t _index) const
+{
+    TelemetrySpan lSpan = { nullptr, 0 };
+    if (_index >= m_segments.size())
+        return lSpan;
+
+    const IsoMappedFile &lFile = *m_segments[_index];
+    const TelemetrySegmentHeader *lHeader = (const TelemetrySegmentHeader *)lFile.data();
+    uint64_t lCount = lHeader->count;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    /// <summary>
+    /// Never trust the header beyond the mapped size
+    /// </summary>
+    uint64_t lMax = (lFile.size() - sizeof(TelemetrySegmentHeader)) / sizeof(TelemetryRecord);
+    if (lCount > lMax)
+        lCount = lMax;
+
+    lSpan.data = (const TelemetryRecord *)(lFile.data() + sizeof(TelemetrySegmentHeader));
+    lSpan.count = (size_t)lCount;
+    return lSpan;
+}
+
+uint64_t TelemetryReader::getRecordCount() const
+{
+    uint64_t lCount = 0;
+    for (size_t i = 0; i < m_segments.size(); i++)
+        lCount += getSegment(i).count;
+    return lCount;
+}
+
+const std::string &TelemetryReader::getIdName(uint32_t _id) const
+{
+    static const std::string s_unknown;
+    return (_id < m_idNames.size()) ? m_idNames[_id] : s_unknown;
+}
+
+bool TelemetryReader::findId(const std::string &_name, uint32_t &_id) const
+{
+    for (size_t i = 0; i < m_idNames.size(); i++) {
+        if (m_idNames[i] == _name) {
+            _id = (uint32_t)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,277 @@
+/*****************************************************************//**
+ * \file   isolatedBox_telemetry.h
+ * \brief: Append only telemetry log of temperature and actuator
+ * samples. Fixed size records in memory mapped segment files,
+ * rotated when full, oldest segments deleted past the retention.
+ *
+ * Directory layout:
+ *   telemetry_00000000.seg ... - segments, header + records
+ *   telemetry.ids              - interned probe ids, one per line,
+ *                                the line number is the record id.
+ *                                Record ids are local to the log:
+ *                                registry handles are per process.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_TELEMETRY_H_
+#define _ISO_TELEMETRY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "isolatedBox_common.h"
+#include "isolatedBox_actuator.h"
+#include "isolatedBox_idregistry.h"
+#include "isolatedBox_mappedfile.h"
+
+constexpr auto ISO_TELEMETRY_VERSION = 1;
+constexpr auto ISO_TELEMETRY_SEGMENT_RECORDS = 1u << 20;   // 24 MB segments
+constexpr auto ISO_TELEMETRY_MAX_SEGMENTS = 64u;
+
+enum TelemetryKind_E
+{
+    TELEMETRY_TEMP,
+    TELEMETRY_ACTUATOR
+};
+
+/**
+ * @brief One sample of the log, as stored in the segment file
+ */
+struct TelemetryRecord
+{
+    int64_t ts;             // Milliseconds since epoch
+    uint32_t id;            // Interned probe / box id
+    temp_t value;           // Temperature, TELEMETRY_TEMP only
+    uint32_t frequency;     // Actuator output, TELEMETRY_ACTUATOR only
+    uint8_t kind;           // TelemetryKind_E
+    uint8_t dutyCycle;
+    uint8_t intensity;
+    uint8_t state;          // EquipmentState
+};
+
+static_assert(sizeof(TelemetryRecord) == 24, "TelemetryRecord must stay 24 bytes");
+
+/**
+ * @brief First 64 bytes of a segment. count is the number of
+ * committed records, updated after each record is written.
+ */
+struct TelemetrySegmentHeader
+{
+    char magic[8];          // "ISOTLOG1"
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;      // Records the segment can hold
+    uint64_t count;
+    uint64_t sequence;      // Segment number
+    int64_t firstTs;
+    int64_t lastTs;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(TelemetrySegmentHeader) == 64, "TelemetrySegmentHeader must stay 64 bytes");
+
+/**
+ * @brief Sequential writer. Samples are copied to the mapping:
+ * no system call per sample, only when a segment is rotated or a new
+ * probe id is interned. Not thread safe: one writer per log directory.
+ */
+class TelemetryWriter
+{
+public:
+    TelemetryWriter();
+
+    ~TelemetryWriter();
+
+    TelemetryWriter(const TelemetryWriter&) = delete;
+    TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+    /**
+     * @brief Open the log in _dir, created if missing. Writing goes on in
+     * a new segment after the existing ones, known ids are reloaded.
+     * @param _recordsPerSegment - segment size in records
+     * @param _maxSegments - retention: oldest segments are deleted
+     * @return false if the first segment can not be created
+     */
+    bool open(const std::string &_dir, size_t _recordsPerSegment = ISO_TELEMETRY_SEGMENT_RECORDS,
+              size_t _maxSegments = ISO_TELEMETRY_MAX_SEGMENTS);
+
+    /**
+     * @brief Flush and close the current segment
+     */
+    void close();
+
+    bool isOpen() const { return m_segment.isOpen(); }
+
+    /**
+     * @brief Numeric id of a probe name, added to the table if new
+     */
+    uint32_t intern(const std::string &_id);
+
+    /**
+     * @brief Record id of a registry handle. The name is looked up
+     * only the first time a handle is seen.
+     * @return ISO_ID_INVALID for an unregistered handle: it has no
+     * name, any name given to it could be the one of a real probe
+     */
+    uint32_t intern(isoId_t _handle)
+    {
+        if (_handle < m_fromRegistry.size() && m_fromRegistry[_handle] != ISO_ID_INVALID)
+            return m_fromRegistry[_handle];
+        return internHandle(_handle);
+    }
+
+    /**
+     * @brief Append a temperature sample
+     */
+    bool appendTemp(int64_t _ts, uint32_t _id, temp_t _value)
+    {
+        TelemetryRecord lRecord = { _ts, _id, _value, 0, TELEMETRY_TEMP, 0, 0, 0 };
+        return append(lRecord);
+    }
+
+    /**
+     * @brief Append a TempStruct sample (time stamp in seconds,
+     * id a registry handle)
+     * @return false if the handle is not registered
+     */
+    bool append(const TempStruct &_sample)
+    {
+        uint32_t lId = intern(_sample.id);
+        if (lId == ISO_ID_INVALID)
+            return false;
+        return appendTemp((int64_t)_sample.ts * 1000, lId, _sample.temp);
+    }
+
+    /**
+     * @brief Append the output of an actuator
+     */
+    bool appendActuator(int64_t _ts, uint32_t _id, const IsoActuatorState &_actuator)
+    {
+        TelemetryRecord lRecord = { _ts, _id, 0.0f, _actuator.getFrequency(), TELEMETRY_ACTUATOR,
+                                    _actuator.getDutyCycle(), _actuator.getIntensity(),
+                                    (uint8_t)_actuator.getPwmState() };
+        return append(lRecord);
+    }
+
+    /**
+     * @brief Append a record. Rotates the segment when it is full.
+     */
+    bool append(const TelemetryRecord &_record)
+    {
+        if (m_count == m_capacity && !rotate())
+            return false;
+        std::memcpy(&m_records[m_count], &_record, sizeof(TelemetryRecord));
+        if (m_count == 0)
+            m_header->firstTs = _record.ts;
+        m_header->lastTs = _record.ts;
+        /// <summary>
+        /// A reader mapping the live segment only sees complete records
+        /// </summary>
+        std::atomic_thread_fence(std::memory_order_release);
+        m_header->count = ++m_count;
+        m_total++;
+        return true;
+    }
+
+    /**
+     * @brief Schedule the write back of the current segment
+     */
+    bool flush() { return m_segment.flush(); }
+
+    /**
+     * @brief Records appended since open()
+     */
+    uint64_t getRecordCount() const { return m_total; }
+
+    /**
+     * @brief Segments currently kept on disk
+     */
+    size_t getNumSegments() const { return m_segmentNames.size(); }
+
+private:
+    bool rotate();
+
+    uint32_t internHandle(isoId_t _handle);
+
+    std::string m_dir;
+    size_t m_recordsPerSegment;
+    size_t m_maxSegments;
+
+    IsoMappedFile m_segment;
+    TelemetrySegmentHeader *m_header;
+    TelemetryRecord *m_records;
+    uint64_t m_count;
+    uint64_t m_capacity;
+    uint64_t m_sequence;
+    uint64_t m_total;
+    std::deque<std::string> m_segmentNames;
+
+    std::unordered_map<std::string, uint32_t> m_ids;
+    std::vector<std::string> m_idNames;
+    std::vector<uint32_t> m_fromRegistry;
+};
+
+/**
+ * @brief Records of one segment, pointing into the mapping
+ */
+struct TelemetrySpan
+{
+    const TelemetryRecord *data;
+    size_t count;
+
+    const TelemetryRecord *begin() const { return data; }
+    const TelemetryRecord *end() const { return data + count; }
+};
+
+/**
+ * @brief Zero copy reader for offline analysis: segments are mapped
+ * read only and records are used in place
+ */
+class TelemetryReader
+{
+public:
+    /**
+     * @brief Map every valid segment of the directory, oldest first
+     * @return false if no segment could be mapped
+     */
+    bool open(const std::string &_dir);
+
+    void close();
+
+    size_t getNumSegments() const { return m_segments.size(); }
+
+    /**
+     * @brief Records of segment _index (0 is the oldest kept)
+     */
+    TelemetrySpan getSegment(size_t _index) const;
+
+    /**
+     * @brief Records in all the segments
+     */
+    uint64_t getRecordCount() const;
+
+    /**
+     * @brief Probe name of an interned id, empty if unknown
+     */
+    const std::string &getIdName(uint32_t _id) const;
+
+    /**
+     * @brief Interned id of a probe name
+     * @return false if the name is not in the log
+     */
+    bool findId(const std::string &_name, uint32_t &_id) const;
+
+private:
+    std::vector<std::unique_ptr<IsoMappedFile>> m_segments;
+    std::vector<std::string> m_idNames;
+};
+
+#endif /* _ISO_TELEMETRY_H_ */
@@ -0,0 +1,123 @@
+/*****************************************************************//**
+ * \file   isolatedBox_trace.cpp
+ * \brief: Scoped trace spans of the control loop, recorded in per
+ * thread rings and exported in the Chrome / Perfetto JSON format
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_trace.h"
+
+#include <chrono>
+#include <cstdio>
+
+
+IsoTraceRing::IsoTraceRing(uint32_t _tid)
+    : tid(_tid), head(0)
+{
+    for (Event &lEvent : events) {
+        lEvent.seq.store(0, std::memory_order_relaxed);
+        lEvent.name.store(nullptr, std::memory_order_relaxed);
+        lEvent.beginNs.store(0, std::memory_order_relaxed);
+        lEvent.durationNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+IsoTracer &IsoTracer::instance()
+{
+    static IsoTracer s_tracer;
+    return s_tracer;
+}
+
+IsoTracer::IsoTracer()
+    : m_enabled(true),
+      m_epochNs(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count())
+{
+}
+
+uint64_t IsoTracer::now() const
+{
+    return (uint64_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count() - m_epochNs);
+}
+
+IsoTraceRing *IsoTracer::threadRing()
+{
+    /// <summary>
+    /// The lock is only taken by the first span of each thread
+    /// </summary>
+    static thread_local IsoTraceRing *s_ring = nullptr;
+    if (s_ring == nullptr) {
+        std::lock_guard<std::mutex> lLock(m_mutex);
+        m_rings.push_back(std::unique_ptr<IsoTraceRing>(new IsoTraceRing((uint32_t)m_rings.size() + 1)));
+        s_ring = m_rings.back().get();
+    }
+    return s_ring;
+}
+
+void IsoTracer::record(const char *_name, uint64_t _beginNs, uint64_t _endNs)
+{
+    threadRing()->push(_name, _beginNs, _endNs - _beginNs);
+}
+
+uint64_t IsoTracer::getRecorded() const
+{
+    std::lock_guard<std::mutex> lLock(m_mutex);
+
+    uint64_t lRecorded = 0;
+    for (auto &lRing : m_rings)
+        lRecorded += lRing->head.load(std::memory_order_acquire);
+    return lRecorded;
+}
+
+void IsoTracer::exportChromeJson(std::string &_out) const
+{
+    _out.assign("{\"traceEvents\":[");
+    bool lFirst = true;
+    char lLine[256];
+
+    std::lock_guard<std::mutex> lLock(m_mutex);
+    for (auto &lRing : m_rings) {
+        /// <summary>
+        /// The owner keeps recording: a slot is kept only if its
+        /// sequence is the one of span i before and after its fields
+        /// are read, otherwise it was overwritten meanwhile
+        /// </summary>
+        uint64_t lHead = lRing->head.load(std::memory_order_acquire);
+        uint64_t lBegin = (lHead > ISO_TRACE_RING_EVENTS) ? lHead - ISO_TRACE_RING_EVENTS : 0;
+        for (uint64_t i = lBegin; i < lHead; i++) {
+            const IsoTraceRing::Event &lEvent = lRing->events[i & (ISO_TRACE_RING_EVENTS - 1)];
+            if (lEvent.seq.load(std::memory_order_acquire) != i + 1)
+                continue;
+            const char *lName = lEvent.name.load(std::memory_order_relaxed);
+            uint64_t lBeginNs = lEvent.beginNs.load(std::memory_order_relaxed);
+            uint64_t lDurationNs = lEvent.durationNs.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (lEvent.seq.load(std::memory_order_relaxed) != i + 1 || lName == nullptr)
+                continue;
+            int lLength = snprintf(lLine, sizeof(lLine),
+                                   "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                                   "\"ts\":%.3f,\"dur\":%.3f}",
+                                   lFirst ? "" : ",", lName, lRing->tid,
+                                   lBeginNs * 1e-3, lDurationNs * 1e-3);
+            if (lLength > 0 && (size_t)lLength < sizeof(lLine)) {
+                _out.append(lLine, (size_t)lLength);
+                lFirst = false;
+            }
+        }
+    }
+    _out.append("\n],\"displayTimeUnit\":\"ns\"}\n");
+}
+
+bool IsoTracer::writeChromeJson(const std::string &_path) const
+{
+    std::string lJson;
+    exportChromeJson(lJson);
+
+    FILE *lFile = fopen(_path.c_str(), "wb");
+    if (lFile == nullptr)
+        return false;
+    bool lRetVal = fwrite(lJson.data(), 1, lJson.size(), lFile) == lJson.size();
+    return (fclose(lFile) == 0) && lRetVal;
+}
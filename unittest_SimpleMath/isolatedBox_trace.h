@@ -0,0 +1,160 @@
+/*****************************************************************//**
+ * \file   isolatedBox_trace.h
+ * \brief: Scoped trace spans of the control loop, recorded in per
+ * thread rings and exported in the Chrome / Perfetto JSON format.
+ * ISO_TRACE_SCOPE compiles to nothing unless ISO_ENABLE_TRACE is
+ * defined (cmake -DISO_ENABLE_TRACE=ON).
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_TRACE_H_
+#define _ISO_TRACE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Spans kept per thread, the oldest are overwritten. Power of two.
+/// </summary>
+constexpr auto ISO_TRACE_RING_EVENTS = 8192u;
+
+#ifdef ISO_ENABLE_TRACE
+#define ISO_TRACE_CONCAT_(_a, _b) _a##_b
+#define ISO_TRACE_CONCAT(_a, _b) ISO_TRACE_CONCAT_(_a, _b)
+/**
+ * @brief Record a span from here to the end of the scope. _name
+ * must be a string literal: only the pointer is stored.
+ */
+#define ISO_TRACE_SCOPE(_name) IsoTraceScope ISO_TRACE_CONCAT(lIsoTraceScope, __LINE__)(_name)
+#else
+#define ISO_TRACE_SCOPE(_name) do { } while (0)
+#endif
+
+/**
+ * @brief Spans of one thread. Single writer; the fields are relaxed
+ * atomics so an export can run while the thread records. Each slot
+ * carries the sequence of its span (index + 1, 0 while written): a
+ * reader keeps a slot only if the same sequence surrounds its fields.
+ */
+struct IsoTraceRing
+{
+    struct Event
+    {
+        std::atomic<uint64_t> seq;
+        std::atomic<const char *> name;
+        std::atomic<uint64_t> beginNs;
+        std::atomic<uint64_t> durationNs;
+    };
+
+    explicit IsoTraceRing(uint32_t _tid);
+
+    void push(const char *_name, uint64_t _beginNs, uint64_t _durationNs)
+    {
+        uint64_t lHead = head.load(std::memory_order_relaxed);
+        Event &lEvent = events[lHead & (ISO_TRACE_RING_EVENTS - 1)];
+        lEvent.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        lEvent.name.store(_name, std::memory_order_relaxed);
+        lEvent.beginNs.store(_beginNs, std::memory_order_relaxed);
+        lEvent.durationNs.store(_durationNs, std::memory_order_relaxed);
+        lEvent.seq.store(lHead + 1, std::memory_order_release);
+        head.store(lHead + 1, std::memory_order_release);
+    }
+
+    uint32_t tid;
+    std::atomic<uint64_t> head;
+    Event events[ISO_TRACE_RING_EVENTS];
+};
+
+/**
+ * @brief Owner of the rings. A thread gets its ring at its first
+ * span; rings live as long as the tracer so that the spans of the
+ * threads that already exited can still be exported.
+ */
+class IsoTracer
+{
+public:
+    static IsoTracer &instance();
+
+    IsoTracer(const IsoTracer&) = delete;
+    IsoTracer& operator=(const IsoTracer&) = delete;
+
+    /**
+     * @brief Nanoseconds since the tracer was created
+     */
+    uint64_t now() const;
+
+    /**
+     * @brief Pause or resume the recording at run time
+     */
+    void setEnabled(bool _enabled) { m_enabled.store(_enabled, std::memory_order_relaxed); }
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Add a span to the ring of the calling thread
+     */
+    void record(const char *_name, uint64_t _beginNs, uint64_t _endNs);
+
+    /**
+     * @brief Number of spans recorded since creation, overwritten
+     * ones included
+     */
+    uint64_t getRecorded() const;
+
+    /**
+     * @brief Spans still in the rings as a Chrome trace
+     * ({"traceEvents":[...]}, complete "X" events, microseconds)
+     */
+    void exportChromeJson(std::string &_out) const;
+
+    /**
+     * @brief exportChromeJson to a file, to be opened with
+     * chrome://tracing or ui.perfetto.dev
+     */
+    bool writeChromeJson(const std::string &_path) const;
+
+private:
+    IsoTracer();
+
+    IsoTraceRing *threadRing();
+
+    std::atomic<bool> m_enabled;
+    int64_t m_epochNs;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<IsoTraceRing>> m_rings;
+};
+
+/**
+ * @brief Span of the enclosing scope. Use through ISO_TRACE_SCOPE.
+ */
+class IsoTraceScope
+{
+public:
+    explicit IsoTraceScope(const char *_name)
+        : m_name(IsoTracer::instance().isEnabled() ? _name : nullptr),
+          m_beginNs(m_name != nullptr ? IsoTracer::instance().now() : 0)
+    {
+    }
+
+    ~IsoTraceScope()
+    {
+        if (m_name != nullptr)
+            IsoTracer::instance().record(m_name, m_beginNs, IsoTracer::instance().now());
+    }
+
+    IsoTraceScope(const IsoTraceScope&) = delete;
+    IsoTraceScope& operator=(const IsoTraceScope&) = delete;
+
+private:
+    const char *m_name;
+    uint64_t m_beginNs;
+};
+
+#endif /* _ISO_TRACE_H_ */
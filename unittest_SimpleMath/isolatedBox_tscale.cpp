@@ -0,0 +1,68 @@
+/*****************************************************************//**
+ * \file   isolatedBox_tscale.cpp
+ * \brief: Conversions between the temperature scales of TScale_E
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_tscale.h"
+
+/// <summary>
+/// Each scale as an affine function of the celsius one:
+/// value = celsius * scale + offset
+/// </summary>
+static void fromCelsius(TScale_E _scale, double &_mul, double &_add)
+{
+    switch (_scale) {
+    case FARENHEIT:
+        _mul = 1.8;
+        _add = 32.0;
+        break;
+    case KELVIN:
+        _mul = 1.0;
+        _add = 273.15;
+        break;
+    case CELSIUS:
+    default:
+        _mul = 1.0;
+        _add = 0.0;
+        break;
+    }
+}
+
+IsoScaleAffine isoScaleAffine(TScale_E _from, TScale_E _to)
+{
+    /// <summary>
+    /// to(from^-1(x)): composed in double, rounded once
+    /// </summary>
+    double lFromMul, lFromAdd, lToMul, lToAdd;
+    fromCelsius(_from, lFromMul, lFromAdd);
+    fromCelsius(_to, lToMul, lToAdd);
+
+    double lScale = lToMul / lFromMul;
+    IsoScaleAffine lAffine = { (temp_t)lScale, (temp_t)(lToAdd - lFromAdd * lScale) };
+    return lAffine;
+}
+
+void isoConvertTemps(temp_t *_values, size_t _count, TScale_E _from, TScale_E _to)
+{
+    if (_from == _to)
+        return;
+
+    const IsoScaleAffine lAffine = isoScaleAffine(_from, _to);
+    const temp_t lScale = lAffine.scale;
+    const temp_t lOffset = lAffine.offset;
+    for (size_t i = 0; i < _count; i++)
+        _values[i] = _values[i] * lScale + lOffset;
+}
+
+void isoConvertTemps(const temp_t *_in, temp_t *_out, size_t _count, TScale_E _from, TScale_E _to)
+{
+    const IsoScaleAffine lAffine = isoScaleAffine(_from, _to);
+    const temp_t lScale = lAffine.scale;
+    const temp_t lOffset = lAffine.offset;
+    const temp_t *__restrict lIn = _in;
+    temp_t *__restrict lOut = _out;
+    for (size_t i = 0; i < _count; i++)
+        lOut[i] = lIn[i] * lScale + lOffset;
+}
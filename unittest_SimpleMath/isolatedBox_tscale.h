@@ -0,0 +1,66 @@
+/*****************************************************************//**
+ * \file   isolatedBox_tscale.h
+ * \brief: Conversions between the temperature scales of TScale_E.
+ * Every conversion is affine (out = in * scale + offset): the pair is
+ * computed once and applied to whole batches of samples.
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#ifndef _ISO_TSCALE_H_
+#define _ISO_TSCALE_H_
+
+#include <cstddef>
+
+#include "isolatedBox_common.h"
+
+/**
+ * @brief out = in * scale + offset
+ */
+struct IsoScaleAffine
+{
+    temp_t scale;
+    temp_t offset;
+};
+
+/**
+ * @brief Coefficients of the conversion from _from to _to.
+ * An invalid scale converts as CELSIUS.
+ */
+IsoScaleAffine isoScaleAffine(TScale_E _from, TScale_E _to);
+
+/**
+ * @brief Convert one temperature. Configuration time only: samples
+ * go through the batch versions.
+ */
+inline temp_t isoConvertTemp(temp_t _value, TScale_E _from, TScale_E _to)
+{
+    if (_from == _to)
+        return _value;
+    IsoScaleAffine lAffine = isoScaleAffine(_from, _to);
+    return _value * lAffine.scale + lAffine.offset;
+}
+
+/**
+ * @brief Convert a difference of temperatures (an error, a band):
+ * the offset does not apply
+ */
+inline temp_t isoConvertDelta(temp_t _delta, TScale_E _from, TScale_E _to)
+{
+    if (_from == _to)
+        return _delta;
+    return _delta * isoScaleAffine(_from, _to).scale;
+}
+
+/**
+ * @brief Convert _count contiguous samples in place. The loop has no
+ * branch nor dependency between samples: the compiler vectorizes it.
+ */
+void isoConvertTemps(temp_t *_values, size_t _count, TScale_E _from, TScale_E _to);
+
+/**
+ * @brief Same as above from _in to _out, which must not overlap
+ */
+void isoConvertTemps(const temp_t *_in, temp_t *_out, size_t _count, TScale_E _from, TScale_E _to);
+
+#endif /* _ISO_TSCALE_H_ */
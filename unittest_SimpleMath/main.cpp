@@ -1,22 +1,70 @@
 #include "isolatedBox_dataentryqueue.h"
+#include "isolatedBox_exporter.h"
+#include "isolatedBox_probefile.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
 
 using namespace std;
 
-int main()
+int main(int argc, char *argv[])
 {
     cout << "Hello Isolated Box CMake. Main Test Running" << endl;
 
+    /// <summary>
+    /// A directory of probe files (hwmon style temp*_input) can be
+    /// given instead of the simulated probes. The file prefix is the
+    /// second argument: "probe" for an IsoProbeDirectory stand-in.
+    /// </summary>
+    size_t l_numBoxes = 64;
+    SimulatedProbeSource g_simulated(l_numBoxes, 15.0, 60.0);
+    FileProbeSource g_files;
+    IsoProbeSource *g_probes = &g_simulated;
+    if (argc > 1) {
+        const char *l_prefix = (argc > 2) ? argv[2] : "temp";
+        if (!g_files.openDirectory(argv[1], l_prefix)) {
+            cout << "No probe files in " << argv[1] << endl;
+            return 1;
+        }
+        g_probes = &g_files;
+        l_numBoxes = g_files.getNumProbes();
+        cout << "Reading " << l_numBoxes << " probes from " << argv[1] << endl;
+    }
 
     MonitoringDataQueue g_DataQueue;
-    ISO_DataEntryQueue g_dataEntryQueue(&g_DataQueue);
-    ISO_DataEntryQueue::setStopConsumerFlag(true);
-    ISO_DataEntryQueue::setStopProducerFlag(true);
 
-    std::thread l_consumer_t(&ISO_DataEntryQueue::thread_consumer, &g_dataEntryQueue);
-    std::thread l_producer_t(&ISO_DataEntryQueue::thread_producer, &g_dataEntryQueue);
+    DataEntryParams l_params = dataEntryDefaults(l_numBoxes);
+    l_params.numProducers = 2;
+    l_params.numConsumers = 2;
+    ISO_DataEntryQueue g_dataEntryQueue(&g_DataQueue, g_probes, l_params);
+    for (size_t i = 0; i < l_numBoxes; i++)
+        g_dataEntryQueue.initBox(i, 25.0, 50.0);
+
+    IsoMetrics g_metrics(l_numBoxes);
+    g_dataEntryQueue.setMetrics(&g_metrics);
+    IsoMetricsExporter g_exporter(&g_metrics);
+    if (g_exporter.startTcp(9464))
+        cout << "Metrics on http://127.0.0.1:" << g_exporter.getPort() << "/metrics" << endl;
+
+    g_dataEntryQueue.start();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    g_dataEntryQueue.stop();
+
+#ifdef ISO_ENABLE_TRACE
+    if (IsoTracer::instance().writeChromeJson("isobox_trace.json"))
+        cout << "Trace written to isobox_trace.json" << endl;
+#endif
 
-    l_producer_t.join();
-    l_consumer_t.join();
+    DataEntryStats l_stats = g_dataEntryQueue.getStats();
+    cout << "Produced " << l_stats.producer.items << " samples in " << l_stats.producer.batches
+         << " reads, busy " << l_stats.producer.busySeconds << " s" << endl;
+    cout << "Consumed " << l_stats.consumer.items << " samples in " << l_stats.consumer.batches
+         << " batches, busy " << l_stats.consumer.busySeconds << " s" << endl;
+    cout << "Compensations " << l_stats.compensations << ", stale samples "
+         << l_stats.staleSamples << ", dropped samples " << l_stats.droppedSamples
+         << ", max queue depth "
+         << l_stats.maxQueueDepth << ", wall " << l_stats.wallSeconds << " s" << endl;
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,39 @@
+/*****************************************************************//**
+ * \file   profile_import.cpp
+ * \brief: Convert the text form of the PID profiles to the binary
+ * file mapped by IsoProfileStore
+ *
+ * \author F.Morani
+ * \date   October 2026
+***********************************************************************/
+#include "isolatedBox_profile.h"
+
+#include <cstdio>
+
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <profiles.csv> <profiles.bin>\n"
+                        "  one profile per line: box,name,description,kP,kI,kD,volume\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<IsoProfileEntry> l_entries;
+    size_t l_errorLine = 0;
+    if (!IsoProfileStore::importText(argv[1], l_entries, &l_errorLine)) {
+        if (l_errorLine > 0)
+            fprintf(stderr, "%s:%zu: invalid profile\n", argv[1], l_errorLine);
+        else
+            fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    if (!IsoProfileStore::write(argv[2], l_entries)) {
+        fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    printf("%zu profiles written to %s\n", l_entries.size(), argv[2]);
+    return 0;
+}